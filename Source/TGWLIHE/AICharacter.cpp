@@ -1,29 +1,131 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AICharacter.h"
+#include "MazeStats.h"
+#include "MazeGridMovement.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+#include "GameFramework/CharacterMovementComponent.h"
 
 
 // Sets default values
 AAICharacter::AAICharacter()
 {
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Nothing to do every frame: the movement and the mesh tick on their own, the maze budgets them
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Created for every AI character, but only activated for the ones walking on the grid
+	GridMovement = CreateDefaultSubobject<UMazeGridMovementComponent>(TEXT("GridMovement"));
+	GridMovement->bAutoActivate = false;
+	UseGridMovement = false;
+
+	// The pose is not updated behind the walls, nor at full rate when the monster is small on screen; the maze budgets the rest
+	GetMesh()->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered;
+	GetMesh()->bEnableUpdateRateOptimizations = true;
 }
 
 // Called when the game starts or when spawned
 void AAICharacter::BeginPlay()
 {
 	Super::BeginPlay();
+
+	INC_DWORD_STAT(STAT_MazeMonsters);
+
+	// The maze muffles the sounds behind the walls from the passages, the occlusion traces of the attenuation are not needed
+	TInlineComponentArray<UAudioComponent*> Sounds(this);
+	for (UAudioComponent* Sound : Sounds)
+	{
+		const FSoundAttenuationSettings* Attenuation = Sound->GetAttenuationSettingsToApply();
+		if (Attenuation && Attenuation->bEnableOcclusion)
+		{
+			FSoundAttenuationSettings WithoutOcclusion = *Attenuation;
+			WithoutOcclusion.bEnableOcclusion = false;
+			Sound->AdjustAttenuation(WithoutOcclusion);
+		}
+	}
 }
 
-// Called every frame
-void AAICharacter::Tick(float DeltaTime)
+void AAICharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	DEC_DWORD_STAT(STAT_MazeMonsters);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called to bind functionality to input
 void AAICharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
-}
\ No newline at end of file
+}
+
+UPawnMovementComponent* AAICharacter::GetMovementComponent() const
+{
+	if (IsGridMovementEnabled())
+	{
+		return GridMovement;
+	}
+	return GetCharacterMovement();
+}
+
+void AAICharacter::EnableGridMovement()
+{
+	if (IsGridMovementEnabled())
+	{
+		return;
+	}
+
+	// No floor sweep, no step up, no physics: the grid movement moves the capsule without sweeping, so it only needs the overlaps
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->Deactivate();
+	GetCapsuleComponent()->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
+
+	GridMovement->SetUpdatedComponent(GetCapsuleComponent());
+	GridMovement->Activate();
+}
+
+void AAICharacter::SetAnimationUpdateInterval(float Interval)
+{
+	// Without its tick, the mesh neither updates nor evaluates the animation, the last pose stays
+	const bool IsPaused = Interval < 0.0f;
+	GetMesh()->SetComponentTickEnabled(!IsPaused);
+	if (!IsPaused)
+	{
+		GetMesh()->SetComponentTickInterval(Interval);
+	}
+}
+
+void AAICharacter::SetSoundOcclusion(float VolumeMultiplier, float LowPassFrequency)
+{
+	TInlineComponentArray<UAudioComponent*> Sounds(this);
+	for (UAudioComponent* Sound : Sounds)
+	{
+		// Inaudible: the sounds playing are stopped, and the ones started meanwhile are silent, so that no voice is used
+		Sound->SetVolumeMultiplier(VolumeMultiplier);
+		if (VolumeMultiplier <= 0.0f)
+		{
+			if (Sound->IsPlaying())
+			{
+				Sound->Stop();
+				if (Sound->Sound && Sound->Sound->IsLooping())
+				{
+					CulledSounds.AddUnique(Sound);
+				}
+			}
+			continue;
+		}
+
+		if (CulledSounds.Remove(Sound) > 0)
+		{
+			Sound->Play();
+		}
+		Sound->SetLowPassFilterEnabled(LowPassFrequency < MAX_FILTER_FREQUENCY);
+		Sound->SetLowPassFilterFrequency(LowPassFrequency);
+	}
+}
+
+bool AAICharacter::IsGridMovementEnabled() const
+{
+	return GridMovement && GridMovement->IsActive();
+}
@@ -15,6 +15,10 @@ public:
 	UPROPERTY(EditAnywhere, Category = "AI")
 		class UBehaviorTree* BehaviorTree;
 
+	// Whether or not the character walks from cell to cell with the grid movement instead of the character movement, also set by -MazeGridMovement
+	UPROPERTY(EditAnywhere, Category = "AI")
+		bool UseGridMovement;
+
 public:
 	// Sets default values for this character's properties
 	AAICharacter();
@@ -23,10 +27,37 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the character is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+	// The grid movement when it is enabled, otherwise the character movement
+	virtual class UPawnMovementComponent* GetMovementComponent() const override;
+
+	// Replaces the character movement by the grid movement: the character movement stops ticking, and the capsule only overlaps
+	void EnableGridMovement();
+
+	// Whether or not the character walks with the grid movement
+	bool IsGridMovementEnabled() const;
+
+	// Sets how often the animation of the character is updated, every frame at 0, paused entirely if negative
+	void SetAnimationUpdateInterval(float Interval);
+
+	// Sets the volume and the low pass filter of the sounds of the character, computed from the maze. A volume of 0 stops them, the looping ones play again once heard
+	void SetSoundOcclusion(float VolumeMultiplier, float LowPassFrequency);
+
+	// Accessor for the grid movement
+	FORCEINLINE class UMazeGridMovementComponent* GetGridMovement() const { return GridMovement; }
+
+private:
+	// Cheap movement for the AI Monsters, inactive unless enabled
+	UPROPERTY(VisibleAnywhere, Category = "AI")
+		class UMazeGridMovementComponent* GridMovement;
+
+	// Looping sounds stopped because the character is too far to be heard
+	UPROPERTY()
+		TArray<class UAudioComponent*> CulledSounds;
 };
@@ -2,7 +2,7 @@
 
 #include "AIDeathController.h"
 #include "AICharacter.h"
-#include "EngineUtils.h"
+#include "MazeActorRegistry.h"
 #include "AmazeingCharacter.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BlackboardComponent.h"
@@ -13,18 +13,6 @@ AAIDeathController::AAIDeathController()
 	BehaviorTreeComponent = CreateDefaultSubobject<UBehaviorTreeComponent>(TEXT("BehaviorTreeComponent"));
 	BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
 
-	// Necessary to check if there is a world as we are in the constructor, if not bug due to hot reload ! Works fine in game
-	if (GetWorld())
-	{
-		// Grab the Main Character Instance
-		for (TActorIterator<AAmazeingCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			MainCharacter = *ActorItr;
-			//UE_LOG(LogTemp, Warning, TEXT("Got the character"));
-		}
-	}
-
 	// Assign to Team 1, used for the AI Perception to see the player as an Enemy
 	SetGenericTeamId(FGenericTeamId(1));
 }
@@ -33,6 +21,9 @@ void AAIDeathController::Possess(APawn* Pawn)
 {
 	Super::Possess(Pawn);
 
+	// Grab the Main Character instance, once there is a world
+	MainCharacter = FMazeActorRegistry::Get<AAmazeingCharacter>(this);
+
 	// Get the possessed character and check if it's one of the monsters
 	AAICharacter* AIDeath = Cast<AAICharacter>(Pawn);
 
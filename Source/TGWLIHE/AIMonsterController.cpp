@@ -4,12 +4,21 @@
 #include "AICharacter.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BlackboardComponent.h"
-#include "EngineUtils.h"
+#include "MazeActorRegistry.h"
 #include "Maze.h"
 #include "AmazeingCharacter.h"
 #include "Runtime/AIModule/Classes/Perception/AIPerceptionComponent.h"
 #include "Runtime/AIModule/Classes/Perception/AISenseConfig_Sight.h"
 #include "Runtime/Engine/Classes/GameFramework/CharacterMovementComponent.h"
+#include "MazeStats.h"
+#include "MazeGridMovement.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DECLARE_CYCLE_STAT(TEXT("Monster Possess"), STAT_MazeAIMonsterPossess, STATGROUP_MazeAI);
+DECLARE_CYCLE_STAT(TEXT("OnPlayerSensed"), STAT_MazeAIOnPlayerSensed, STATGROUP_MazeAI);
+DECLARE_CYCLE_STAT(TEXT("EyesAreClosed"), STAT_MazeAIEyesAreClosed, STATGROUP_MazeAI);
+DECLARE_CYCLE_STAT(TEXT("EyesAreOpened"), STAT_MazeAIEyesAreOpened, STATGROUP_MazeAI);
 
 AAIMonsterController::AAIMonsterController()
 {
@@ -34,36 +43,28 @@ AAIMonsterController::AAIMonsterController()
 	AIPerceptionComponent->OnPerceptionUpdated.AddDynamic(this, &AAIMonsterController::OnPlayerSensed);
 	SetPerceptionComponent(*AIPerceptionComponent);
 
-	// Necessary to check if there is a world as we are in the constructor, if not bug due to hot reload ! Works fine in game
-	if (GetWorld())
-	{
-		for (TActorIterator<AMaze> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			Maze = *ActorItr;
-			//UE_LOG(LogTemp, Warning, TEXT("Got the maze"));
-		}
-
-		// Grab the Main Character Instance
-		for (TActorIterator<AAmazeingCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			MainCharacter = *ActorItr;
-			//UE_LOG(LogTemp, Warning, TEXT("Got the character"));
-		}
-	}
-
 	// Assign to Team 1, used for the AI Perception to see the player as an Enemy
 	SetGenericTeamId(FGenericTeamId(1));
 
 	// Initially set the Main Character eyes as closed
 	AreEyesOpened = false;
+
+	// The monster listens for noises in its cell, which the maze follows a few times per second
+	NoiseLocation = FVector::ZeroVector;
+	IsInvestigatingNoise = false;
+	ListeningCellIndex = INDEX_NONE;
 }
 
 void AAIMonsterController::Possess(APawn* Pawn)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIMonsterPossess);
+
 	Super::Possess(Pawn);
 
+	// Grab the Maze & Main Character instances, once there is a world
+	Maze = FMazeActorRegistry::Get<AMaze>(this);
+	MainCharacter = FMazeActorRegistry::Get<AAmazeingCharacter>(this);
+
 	// Get the possessed character and check if it's one of the monsters
 	AAICharacter* AIMonster = Cast<AAICharacter>(Pawn);
 
@@ -77,9 +78,7 @@ void AAIMonsterController::Possess(APawn* Pawn)
 			// We then initialize the values
 			// TO DO : voir si selon axe Z change quoi que ce soit ?
 			TArray<FVector> MonsterLocations = Maze->CreateAIPath();
-			HomeLocation = MonsterLocations[0] + FVector(0.0f, 0.0f, MonsterHalfHeight);
-			BlackboardComponent->SetValueAsVector(HomeLocationKey, HomeLocation);
-			BlackboardComponent->SetValueAsVector(TargetLocationKey, MonsterLocations[1] + FVector(0.0f, 0.0f, MonsterHalfHeight));
+			SetPatrol(MonsterLocations[0], MonsterLocations[1]);
 			BlackboardComponent->SetValueAsBool(AttackKey, false);
 
 			AIMonster->SetActorRelativeLocation(MonsterLocations[0] + FVector(0.0f, 0.0f, MonsterHalfHeight));
@@ -87,21 +86,66 @@ void AAIMonsterController::Possess(APawn* Pawn)
 		}
 
 		// Subscribe to the correct AAmazeingCharacter events
-		MainCharacter->OnEyesClosed().AddUFunction(this, FName("EyesAreClosed"));
-		MainCharacter->OnEyesOpened().AddUFunction(this, FName("EyesAreOpened"));
+		EyesClosedSubscription.Subscribe(MainCharacter, MainCharacter->OnEyesClosed(), this, FName("EyesAreClosed"));
+		EyesOpenedSubscription.Subscribe(MainCharacter, MainCharacter->OnEyesOpened(), this, FName("EyesAreOpened"));
 		// Subscribe to the transition finish event, so that the AI can properly respond to the presence of the player after the text is done being shown
-		Maze->OnTransitionFinished().AddUFunction(this, FName("EyesAreOpened"));
+		TransitionFinishedSubscription.Subscribe(Maze, Maze->OnTransitionFinished(), this, FName("EyesAreOpened"));
 
-		// Start the behavior tree
-		BehaviorTreeComponent->StartTree(*AIMonster->BehaviorTree);
+		// Monsters on the grid walk their patrol without the behavior tree: its move tasks need the character movement
+		if (AIMonster->UseGridMovement || FParse::Param(FCommandLine::Get(), TEXT("MazeGridMovement")))
+		{
+			AIMonster->EnableGridMovement();
+			AIMonster->GetGridMovement()->SetGrid(Maze->GetLayout(), Maze->GetLayoutTransform());
+			TargetCaughtSubscription.Subscribe(AIMonster, AIMonster->GetGridMovement()->OnTargetCaught(), this, FName("OnTargetCaught"));
+		}
+		else
+		{
+			// Start the behavior tree
+			BehaviorTreeComponent->StartTree(*AIMonster->BehaviorTree);
+		}
 
 		// Initially, the player cannot be detected (while the text appears)
 		EyesAreClosed();
 	}
 }
 
+void AAIMonsterController::UnPossess()
+{
+	EyesClosedSubscription.Reset();
+	EyesOpenedSubscription.Reset();
+	TransitionFinishedSubscription.Reset();
+	TargetCaughtSubscription.Reset();
+
+	// No more noise to hear
+	if (Maze)
+	{
+		Maze->MoveNoiseListener(this, ListeningCellIndex, INDEX_NONE);
+	}
+	ListeningCellIndex = INDEX_NONE;
+
+	Super::UnPossess();
+}
+
+void AAIMonsterController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	EyesClosedSubscription.Reset();
+	EyesOpenedSubscription.Reset();
+	TransitionFinishedSubscription.Reset();
+	TargetCaughtSubscription.Reset();
+
+	if (Maze)
+	{
+		Maze->MoveNoiseListener(this, ListeningCellIndex, INDEX_NONE);
+	}
+	ListeningCellIndex = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AAIMonsterController::OnPlayerSensed(const TArray<AActor*>& SensedActors)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIOnPlayerSensed);
+
 	// If the eyes are opened
 	if (AreEyesOpened)
 	{
@@ -119,15 +163,8 @@ void AAIMonsterController::OnPlayerSensed(const TArray<AActor*>& SensedActors)
 					BlackboardComponent->SetValueAsBool(AttackKey, true);
 
 					// Change the walking speed
-					AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
-					if (AIMonster)
-					{
-						UCharacterMovementComponent* AIMovement = Cast<UCharacterMovementComponent>(AIMonster->GetCharacterMovement());
-						if (AIMovement)
-						{
-							AIMovement->MaxWalkSpeed = 650.0f;
-						}
-					}
+					SetWalkSpeed(650.0f);
+					UpdateGridMovement();
 				}
 				// Here, we lost sight of him : stop following the player
 				else
@@ -136,15 +173,8 @@ void AAIMonsterController::OnPlayerSensed(const TArray<AActor*>& SensedActors)
 					BlackboardComponent->SetValueAsBool(AttackKey, false);
 
 					// Reset the walking speed
-					AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
-					if (AIMonster)
-					{
-						UCharacterMovementComponent* AIMovement = Cast<UCharacterMovementComponent>(AIMonster->GetCharacterMovement());
-						if (AIMovement)
-						{
-							AIMovement->MaxWalkSpeed = 50.0f;
-						}
-					}
+					SetWalkSpeed(50.0f);
+					UpdateGridMovement();
 				}
 			}
 		}
@@ -153,24 +183,21 @@ void AAIMonsterController::OnPlayerSensed(const TArray<AActor*>& SensedActors)
 
 void AAIMonsterController::EyesAreClosed()
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIEyesAreClosed);
+
 	AreEyesOpened = false;
 
 	// Changing the Blackboard value removes the track behavior of the behavior tree (as we have abort set)
 	BlackboardComponent->SetValueAsBool(AttackKey, false);
 
 	// Reset the walking speed
-	AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
-	if (AIMonster)
-	{
-		UCharacterMovementComponent* AIMovement = Cast<UCharacterMovementComponent>(AIMonster->GetCharacterMovement());
-		if (AIMovement)
-		{
-			AIMovement->MaxWalkSpeed = 50.0f;
-		}
-	}
+	SetWalkSpeed(50.0f);
+	UpdateGridMovement();
 }
 void AAIMonsterController::EyesAreOpened()
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIEyesAreOpened);
+
 	AreEyesOpened = true;
 
 	// Reset the perception so that the OnPlayerSensed function will be called again at this point
@@ -182,27 +209,122 @@ void AAIMonsterController::ResetPerception()
 	// Changing the Blackboard value removes the track behavior of the behavior tree (as we have abort set)
 	BlackboardComponent->SetValueAsBool(AttackKey, false);
 
+	// The noises heard are forgotten too, the patrol goes on to its end
+	IsInvestigatingNoise = false;
+	BlackboardComponent->SetValueAsVector(TargetLocationKey, PatrolTargetLocation + FVector(0.0f, 0.0f, MonsterHalfHeight));
+
+	// Reset the walking speed
+	SetWalkSpeed(50.0f);
+	UpdateGridMovement();
+
+	// Reset the perception so that the OnPlayerSensed function will be called again at this point
+	AIPerceptionComponent->ForgetAll();
+}
+
+void AAIMonsterController::ResetLocation()
+{
 	// Reset the walking speed
 	AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
 	if (AIMonster)
 	{
-		UCharacterMovementComponent* AIMovement = Cast<UCharacterMovementComponent>(AIMonster->GetCharacterMovement());
-		if (AIMovement)
+		AIMonster->SetActorLocation(HomeLocation);
+
+		// The patrol starts again from home
+		if (AIMonster->IsGridMovementEnabled())
 		{
-			AIMovement->MaxWalkSpeed = 50.0f;
+			AIMonster->GetGridMovement()->StopMovementImmediately();
+			UpdateGridMovement();
 		}
 	}
+}
 
-	// Reset the perception so that the OnPlayerSensed function will be called again at this point
-	AIPerceptionComponent->ForgetAll();
+void AAIMonsterController::UpdateListeningCell()
+{
+	// The maze keeps the listeners by cell, only a change of cell has to be told
+	APawn* AIMonster = GetPawn();
+	if (Maze && AIMonster)
+	{
+		int32 CellIndex = Maze->GetCellIndexAt(AIMonster->GetActorLocation());
+		if (CellIndex != ListeningCellIndex)
+		{
+			Maze->MoveNoiseListener(this, ListeningCellIndex, CellIndex);
+			ListeningCellIndex = CellIndex;
+		}
+	}
 }
 
-void AAIMonsterController::ResetLocation()
+void AAIMonsterController::SetPatrol(FVector Home, FVector Target)
+{
+	HomeLocation = Home + FVector(0.0f, 0.0f, MonsterHalfHeight);
+	PatrolTargetLocation = Target;
+	BlackboardComponent->SetValueAsVector(HomeLocationKey, HomeLocation);
+	BlackboardComponent->SetValueAsVector(TargetLocationKey, GetPatrolTargetLocation() + FVector(0.0f, 0.0f, MonsterHalfHeight));
+}
+
+void AAIMonsterController::HearNoise(FVector Location, int32 Distance)
+{
+	// A monster following the player does not turn to a noise
+	if (BlackboardComponent->GetValueAsBool(AttackKey))
+	{
+		return;
+	}
+
+	// The behavior tree patrols to "TargetLocation": the noise takes its place, the grid movement goes there the same way
+	NoiseLocation = FVector(Location.X, Location.Y, HomeLocation.Z - MonsterHalfHeight);
+	IsInvestigatingNoise = true;
+	BlackboardComponent->SetValueAsVector(TargetLocationKey, NoiseLocation + FVector(0.0f, 0.0f, MonsterHalfHeight));
+	UpdateGridMovement();
+}
+
+void AAIMonsterController::SetWalkSpeed(float Speed)
 {
-	// Reset the walking speed
 	AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
 	if (AIMonster)
 	{
-		AIMonster->SetActorLocation(HomeLocation);
+		if (AIMonster->IsGridMovementEnabled())
+		{
+			AIMonster->GetGridMovement()->MaxWalkSpeed = Speed;
+		}
+		else
+		{
+			UCharacterMovementComponent* AIMovement = Cast<UCharacterMovementComponent>(AIMonster->GetCharacterMovement());
+			if (AIMovement)
+			{
+				AIMovement->MaxWalkSpeed = Speed;
+			}
+		}
 	}
+}
+
+void AAIMonsterController::UpdateGridMovement()
+{
+	AAICharacter* AIMonster = Cast<AAICharacter>(GetPawn());
+	if (!AIMonster || !AIMonster->IsGridMovementEnabled())
+	{
+		return;
+	}
+
+	// Same as the behavior tree: the player is followed while "Attack" is set, otherwise the monster patrols
+	UMazeGridMovementComponent* GridMovement = AIMonster->GetGridMovement();
+	if (BlackboardComponent->GetValueAsBool(AttackKey))
+	{
+		GridMovement->Chase(MainCharacter);
+	}
+	else if (IsInvestigatingNoise)
+	{
+		// Straight to the noise first, then back and forth with home
+		GridMovement->Patrol(GridMovement->GetCellAt(NoiseLocation), GridMovement->GetCellAt(HomeLocation));
+	}
+	else
+	{
+		GridMovement->Patrol(GridMovement->GetCellAt(HomeLocation), GridMovement->GetCellAt(PatrolTargetLocation));
+	}
+}
+
+void AAIMonsterController::OnTargetCaught()
+{
+	// Same tasks as the behavior tree when the player is touched
+	Maze->RespawnCharacter();
+	ResetPerception();
+	ResetLocation();
 }
\ No newline at end of file
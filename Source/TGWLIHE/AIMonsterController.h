@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "Maze.h"
+#include "AmazeingCharacter.h"
+#include "MazeEventSubscription.h"
+#include "MazeGridMovement.h"
 #include "AIMonsterController.generated.h"
 
 UCLASS()
@@ -23,10 +27,29 @@ public:
 	// Resets the location of the monster
 	void ResetLocation();
 
+	// Sets the ends of the patrol, in the Blackboard and for the grid movement
+	void SetPatrol(FVector Home, FVector Target);
+
+	// A noise has reached the cell of the monster, Distance cells away from where it was made: unless it attacks, the monster goes there
+	// The noise becomes the target of the patrol, "TargetLocation" in the Blackboard, until the perception is reset
+	void HearNoise(FVector Location, int32 Distance);
+
+	// Location the monster patrols to: the last noise heard if any, otherwise the end of its patrol
+	FVector GetPatrolTargetLocation() const { return IsInvestigatingNoise ? NoiseLocation : PatrolTargetLocation; }
+
+	// Follows the cell of the monster to listen for noises in it, called by the maze with the budget of the AI characters
+	void UpdateListeningCell();
+
 private:
 	// Classic Possess method
 	virtual void Possess(APawn* Pawn) override;
 
+	// Removes the bindings to the events, the monster is going away
+	virtual void UnPossess() override;
+
+	// Same, if the controller is destroyed without being unpossessed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// Determines if the AI Monster Blackboard "Attack" value should be set (=true) and if so, change it
 	UFUNCTION()
 		void OnPlayerSensed(const TArray<AActor*>& SensedActors);
@@ -39,6 +62,16 @@ private:
 	UFUNCTION()
 		void EyesAreOpened();
 
+	// Sets the walking speed of the monster, on its grid movement if enabled
+	void SetWalkSpeed(float Speed);
+
+	// Makes the grid movement follow the "Attack" value of the Blackboard, as the behavior tree does, if the monster walks on the grid
+	void UpdateGridMovement();
+
+	// The grid movement has caught the player
+	UFUNCTION()
+		void OnTargetCaught();
+
 public:
 	// Name of the "HomeLocation" in the Blackboard
 	UPROPERTY(EditAnywhere)
@@ -87,4 +120,25 @@ private:
 	// Used to store the Home Location, so that the Monster can teleport to it
 	UPROPERTY()
 		FVector HomeLocation;
+
+	// Last location of the patrol, for the grid movement
+	UPROPERTY()
+		FVector PatrolTargetLocation;
+
+	// Where the last noise heard was made, at the height of the home location
+	UPROPERTY()
+		FVector NoiseLocation;
+
+	// Whether or not the monster patrols to the last noise heard instead of the end of its patrol
+	UPROPERTY()
+		bool IsInvestigatingNoise;
+
+	// Index of the cell the monster listens for noises in, INDEX_NONE if none
+	int32 ListeningCellIndex;
+
+	// Bindings to the events of the main character and of the maze, removed automatically so that dead monsters are not called
+	TMazeEventSubscription<FEyesMovement> EyesClosedSubscription;
+	TMazeEventSubscription<FEyesMovement> EyesOpenedSubscription;
+	TMazeEventSubscription<FAction> TransitionFinishedSubscription;
+	TMazeEventSubscription<FTargetCaught> TargetCaughtSubscription;
 };
\ No newline at end of file
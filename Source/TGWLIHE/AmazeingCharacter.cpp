@@ -12,13 +12,18 @@
 #include "Runtime/Engine/Classes/Materials/MaterialInstanceDynamic.h"
 #include "AmazeingGameMode.h"
 #include "EndTriggerVolume.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
 #include "Runtime/UMG/Public/Blueprint/UserWidget.h"
 #include "Maze.h"
 #include "AudioManager.h"
+#include "MazeActorRegistry.h"
+#include "MazeStats.h"
+#include "MazeTickCosts.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character Tick"), STAT_MazeCharacterTick, STATGROUP_Maze);
+
 //////////////////////////////////////////////////////////////////////////
 // AAmazeingCharacter
 
@@ -50,18 +55,11 @@ AAmazeingCharacter::AAmazeingCharacter()
 	// Initially, the character is frozen
 	IsMovementEnabled = false;
 
-	// Grab the classes of the UMG
-	static ConstructorHelpers::FObjectFinder<UClass> UMGClassFinder(TEXT("Class'/Game/Blueprints/UI/Pause.Pause_C'"));
-	if (UMGClassFinder.Object)
-	{
-		UMGPauseWidget = UMGClassFinder.Object;
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Pause UMG not found"));
-	}
+	// Reference the classes of the UMG, they are streamed when the game starts
+	UMGPauseWidget = TSoftClassPtr<UUserWidget>(FSoftObjectPath(TEXT("/Game/Blueprints/UI/Pause.Pause_C")));
 
 	CurrentDistance = 0.0f;
+	FootstepNoiseRadius = 3;
 }
 
 void AAmazeingCharacter::BeginPlay()
@@ -69,6 +67,15 @@ void AAmazeingCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	// The AI controllers find the main character of the world from there
+	FMazeActorRegistry::Register(this);
+
+	// The Pause UMG is not needed before the player can move
+	if (!UMGPauseWidget.IsNull())
+	{
+		PauseWidgetHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(UMGPauseWidget.ToSoftObjectPath());
+	}
+
 	// We create a dynamic instance of the closing eyes postprocess material & we add it to the postprocess volume
 	if (PostProcessVolume != nullptr)
 	{
@@ -104,6 +111,9 @@ void AAmazeingCharacter::BeginPlay()
 
 void AAmazeingCharacter::Tick(float DeltaTime)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeCharacterTick);
+	MAZE_TICK_COST_SCOPE();
+
 	// Call the base class
 	Super::Tick(DeltaTime);
 
@@ -150,6 +160,9 @@ void AAmazeingCharacter::Tick(float DeltaTime)
 		if (CurrentDistance >= 1500.0f)
 		{
 			AudioManager->PlayFootstep();
+
+			// The footstep is heard through the passages by the monsters nearby
+			Maze->EmitNoise(GetActorLocation(), FootstepNoiseRadius);
 			CurrentDistance = 0.0f;
 			PreviousLocation = GetActorLocation();
 		}
@@ -310,7 +323,7 @@ void AAmazeingCharacter::OnPaused()
 		// If the widget is not created, create it
 		if (PauseWidget == nullptr)
 		{
-			PauseWidget = CreateWidget<UUserWidget>(UGameplayStatics::GetPlayerController(GetWorld(), 0), UMGPauseWidget);
+			PauseWidget = CreateWidget<UUserWidget>(UGameplayStatics::GetPlayerController(GetWorld(), 0), UMGPauseWidget.LoadSynchronous());
 		}
 
 		// Show the UMG
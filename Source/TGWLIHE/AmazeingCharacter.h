@@ -18,6 +18,9 @@ class AAmazeingCharacter : public ACharacter, public IGenericTeamAgentInterface
 {
 	GENERATED_BODY()
 
+	// The input replay calls the input handlers in place of the player
+	friend class AMazeInputReplay;
+
 public:
 	AAmazeingCharacter();
 
@@ -142,9 +145,12 @@ private:
 	// Used to check whether or not the movement inputs should be taken into account
 	bool IsMovementEnabled;
 
-	// Pause UMG
+	// Pause UMG, streamed when the game starts
 	UPROPERTY(EditAnywhere, Category = Pause)
-		TSubclassOf<class UUserWidget> UMGPauseWidget;
+		TSoftClassPtr<class UUserWidget> UMGPauseWidget;
+
+	// Load of the Pause UMG
+	TSharedPtr<struct FStreamableHandle> PauseWidgetHandle;
 
 	// Stores the Pause widget
 	UPROPERTY()
@@ -160,6 +166,10 @@ private:
 	// Current distance walked
 	float CurrentDistance;
 
+	// Number of cells along the passages a footstep is heard at
+	UPROPERTY(EditAnywhere, Category = Audio)
+		int32 FootstepNoiseRadius;
+
 	// Audio manager
 	UPROPERTY(EditAnywhere, Category = Audio)
 		class AAudioManager* AudioManager;
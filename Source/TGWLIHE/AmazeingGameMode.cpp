@@ -8,10 +8,19 @@
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "TransitionWidget.h"
 #include "Maze.h"
-#include "EngineUtils.h"
+#include "MazeActorRegistry.h"
 #include "Runtime/UMG/Public/Animation/UMGSequencePlayer.h"
 #include "EndTriggerVolume.h"
 #include "AudioManager.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "MazeAutopilot.h"
+#include "MazeInputReplay.h"
 
 // TO DO: Decouple logic and UI functionalities -> Create another class or use the Transition Widget
 AAmazeingGameMode::AAmazeingGameMode()
@@ -26,54 +35,51 @@ AAmazeingGameMode::AAmazeingGameMode()
 
 	// Initialize the state index
 	StateIndex = 0;
+	PrebuiltStateIndex = -1;
+	NextLevelStateIndex = -1;
+	IsRetryingLevel = false;
 
-	// Grab the classes of the UMG
-	static ConstructorHelpers::FObjectFinder<UClass> UMGClassFinder(TEXT("Class'/Game/Blueprints/UI/Transitions.Transitions_C'"));
-	if (UMGClassFinder.Object)
-	{
-		UMGTransitionWidget = UMGClassFinder.Object;
-	}
-	else
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint UMG not found"));
-	}
+	// By default, every maze of the library can be used
+	EndlessMinSolutionLength = 0;
+	EndlessMaxSolutionLength = MAX_int32;
 
-	// Grab the Maze & Main Character Instances
-	if (GetWorld())
-	{
-		for (TActorIterator<AMaze> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			Maze = *ActorItr;
-			//UE_LOG(LogTemp, Warning, TEXT("Got the maze"));
-		}
+	// The telemetry is enabled by the config, for the installs we want field data from
+	RecordLevelTelemetry = false;
+	HitchThresholdMs = 50.0f;
 
-		// Grab the Main Character Instance
-		for (TActorIterator<AAmazeingCharacter> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			MainCharacter = *ActorItr;
-			//UE_LOG(LogTemp, Warning, TEXT("Got the character"));
-		}
+	// Random levels by default, the session seed is set in BeginPlay
+	LevelStream.GenerateNewSeed();
 
-		// Grab the AudioManager instance
-		for (TActorIterator<AAudioManager> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			AudioManager = *ActorItr;
-		}
-	}
+	// The levels are bounded mazes unless the config or -MazeUnbounded asks otherwise
+	PlayUnboundedMaze = false;
+
+	// Flat random levels unless the config or -MazeFloors= asks for floors, the levels of several floors have no Death
+	EndlessFloors = 1;
+
+	// Reference the classes of the UMG, they are loaded when the game starts
+	UMGTransitionWidget = TSoftClassPtr<UTransitionWidget>(FSoftObjectPath(TEXT("/Game/Blueprints/UI/Transitions.Transitions_C")));
+
+	IsStartupTimed = false;
+	BeginPlayTime = 0.0;
 }
 
 void AAmazeingGameMode::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// First, get the Transition Widget and make it visible
-	if (UMGTransitionWidget) // Check if the Asset is assigned in the blueprint.
+	BeginPlayTime = FPlatformTime::Seconds() - GStartTime;
+
+	// Grab the Maze, Main Character & AudioManager instances
+	Maze = FMazeActorRegistry::Get<AMaze>(this);
+	MainCharacter = FMazeActorRegistry::Get<AAmazeingCharacter>(this);
+	AudioManager = FMazeActorRegistry::Get<AAudioManager>(this);
+
+	// First, get the Transition Widget and make it visible: it hides the first generation, so it cannot wait for a stream
+	UClass* TransitionWidgetClass = UMGTransitionWidget.LoadSynchronous();
+	if (TransitionWidgetClass) // Check if the Asset is assigned in the blueprint.
 	{
 		// Create the widget and store it.
-		TransitionWidget = CreateWidget<UTransitionWidget>(UGameplayStatics::GetPlayerController(GetWorld(), 0), UMGTransitionWidget);
+		TransitionWidget = CreateWidget<UTransitionWidget>(UGameplayStatics::GetPlayerController(GetWorld(), 0), TransitionWidgetClass);
 
 		if (TransitionWidget)
 		{
@@ -88,6 +94,12 @@ void AAmazeingGameMode::BeginPlay()
 		}
 	}
 
+	// Map the library of pregenerated mazes used for the random levels, if it has been baked
+	if (!MazeLibraryPath.IsEmpty() && MazeLibrary.Open(FPaths::ProjectDir() / MazeLibraryPath))
+	{
+		MazeLibrary.Filter(EndlessMinSolutionLength, EndlessMaxSolutionLength);
+	}
+
 	// Play the Music box
 	AudioManager->PlayMusicBox();
 
@@ -105,13 +117,56 @@ void AAmazeingGameMode::BeginPlay()
 		// Launch the Monster Kill Fade In animation when the player location has been reset
 		Maze->OnLocationReset().AddUFunction(this, FName("LaunchMonsterKillFadeIn"));
 
+		// Record every level from the first one, on the kiosk installs whose config asks for it, or with -MazeTelemetry
+		RecordLevelTelemetry |= FParse::Param(FCommandLine::Get(), TEXT("MazeTelemetry"));
+		if (RecordLevelTelemetry)
+		{
+			LevelRecorder.Start(Maze, HitchThresholdMs);
+		}
+
+		// Every random choice of the levels comes from the session seed, so that a session can be replayed
+		int32 SessionSeed = FMath::Rand();
+
+#if !UE_BUILD_SHIPPING
+		// Soak test: the game plays itself, level after level
+		if (AMazeAutopilot::IsRequested())
+		{
+			AMazeAutopilot* Autopilot = World->SpawnActor<AMazeAutopilot>();
+			Autopilot->Initialize(Maze, MainCharacter, this);
+		}
+
+		// Input recording, or replay of a recorded session with its seed
+		if (AMazeInputReplay::IsRequested())
+		{
+			AMazeInputReplay* InputReplay = World->SpawnActor<AMazeInputReplay>();
+			SessionSeed = InputReplay->Initialize(Maze, MainCharacter, SessionSeed);
+		}
+#endif
+
+		LevelStream.Initialize(SessionSeed);
+		Maze->SetSeed(SessionSeed);
+
+		PlayUnboundedMaze |= FParse::Param(FCommandLine::Get(), TEXT("MazeUnbounded"));
+		FParse::Value(FCommandLine::Get(), TEXT("MazeFloors="), EndlessFloors);
+
 		// Generate the first Maze
 		GenerateMaze();
 	}
 }
 
+void AAmazeingGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Writes the level being played
+	LevelRecorder.Stop();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AAmazeingGameMode::LaunchFadeIn()
 {
+	// The level appears, the deferred work waits for the next window
+	Maze->GetIdleScheduler().SetWindowOpen(EMazeIdleWindow::FadeOut, false);
+
 	// Launch the fade in animation
 	TransitionWidget->PlayFadeInAnimation();
 
@@ -127,10 +182,39 @@ void AAmazeingGameMode::FadeInActions()
 
 	// Broadcast the Fade In Finished Event, so that other classes can also profit from the "OnSequenceFinishedPlaying()" event
 	FadeInFinishedEvent.Broadcast();
+
+	// The player can move for the first time: this is the end of the startup
+	if (!IsStartupTimed)
+	{
+		IsStartupTimed = true;
+		LogStartupTime();
+	}
+}
+
+void AAmazeingGameMode::LogStartupTime() const
+{
+	const double InteractiveTime = FPlatformTime::Seconds() - GStartTime;
+	UE_LOG(LogTemp, Warning, TEXT("Maze startup: first interactive frame %.2f s after launch, game mode began play at %.2f s"), InteractiveTime, BeginPlayTime);
+
+	// Benchmark: the times are appended to Saved/Profiling/MazeStartup.csv, then the game quits, so that it can be launched again and again
+	if (FParse::Param(FCommandLine::Get(), TEXT("MazeStartupBenchmark")))
+	{
+		const FString Filename = FPaths::ProfilingDir() / TEXT("MazeStartup.csv");
+		if (!FPaths::FileExists(Filename))
+		{
+			FFileHelper::SaveStringToFile(TEXT("Date,BeginPlay (s),FirstInteractiveFrame (s)\n"), *Filename);
+		}
+		const FString Row = FString::Printf(TEXT("%s,%.3f,%.3f\n"), *FDateTime::Now().ToString(), BeginPlayTime, InteractiveTime);
+		FFileHelper::SaveStringToFile(Row, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		FPlatformMisc::RequestExit(false);
+	}
 }
 
 void AAmazeingGameMode::LaunchFadeOut(bool IsDeathKill)
 {
+	// The player is frozen behind the fade until the next level fades in: the deferred work can run
+	Maze->GetIdleScheduler().SetWindowOpen(EMazeIdleWindow::FadeOut, true);
+
 	if (IsDeathKill)
 	{
 		AudioManager->PlayGirlScream();
@@ -157,60 +241,178 @@ void AAmazeingGameMode::LaunchFadeOut(bool IsDeathKill)
 void AAmazeingGameMode::FadeOutActions()
 {
 	// Recreates a maze, the previous one has been destroyed following the event sent by the EndTriggerVolume
+	// The next maze is usually already built and only has to be revealed, so the fade does not hide any work
 	GenerateMaze();
 
 	// Broadcast the Fade In Finished Event, so that other classes can also profit from the "OnSequenceFinishedPlaying()" event
 	FadeOutFinishedEvent.Broadcast();
 }
 
-void AAmazeingGameMode::GenerateMaze()
+FMazeLevelParameters AAmazeingGameMode::GetLevelParameters(int32 Index, FRandomStream& Stream) const
 {
-	// Depending on the state index, generate a different maze
-	switch (StateIndex)
+	// Depending on the state index, a different maze
+	switch (Index)
 	{
 	case 0:
-		Maze->Generate(4, 4, 0, 0);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(4, 4, 0, 0);
 
 	case 1:
-		Maze->Generate(7, 7, 0, 0);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(7, 7, 0, 0);
 
 	case 2:
-		Maze->Generate(20, 1, 1, 10);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(20, 1, 1, 10);
 
 	case 3:
-		Maze->Generate(8, 8, 2, 15);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(8, 8, 2, 15);
 
 	case 4:
-		Maze->Generate(10, 10, 5, 15, 100);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(10, 10, 5, 15, 100);
 
 	case 5:
-		Maze->Generate(15, 15, 8, 20, 300);
-		StateIndex += 1;
-		break;
+		return FMazeLevelParameters(15, 15, 8, 20, 300);
+
+	case LastLevelIndex:
+	{
+		FMazeLevelParameters LastLevel;
+		LastLevel.IsLastLevel = true;
+		return LastLevel;
+	}
+
+	default:
+	{
+		// Taken from the library when possible, so that nothing has to be generated
+		int32 Entry = MazeLibrary.PickEntry(Stream);
+		if (Entry >= 0)
+		{
+			FMazeLevelParameters LibraryLevel(MazeLibrary.GetEntry(Entry).SizeX, MazeLibrary.GetEntry(Entry).SizeY, 0, 0);
+			LibraryLevel.LibraryEntry = Entry;
+			return LibraryLevel;
+		}
+		return FMazeLevelParameters(Stream.RandRange(10, 30), Stream.RandRange(10, 30), Stream.RandRange(10, 30), Stream.RandRange(10, 30), Stream.RandRange(60, 240), EndlessFloors);
+	}
+	}
+}
+
+bool AAmazeingGameMode::LoadLibraryLayout(const FMazeLevelParameters& Parameters, FMazeLayout& OutLayout) const
+{
+	return Parameters.LibraryEntry >= 0 && MazeLibrary.LoadLayout(Parameters.LibraryEntry, OutLayout);
+}
+
+void AAmazeingGameMode::GenerateMaze()
+{
+	MAZE_TELEMETRY_SCOPE("GameMode GenerateMaze");
+
+	// The parameters chosen when the level was prepared, the random ones are only drawn once, and kept for a retry
+	FMazeLevelParameters Parameters;
+	if (IsRetryingLevel)
+	{
+		Parameters = CurrentLevelParameters;
+	}
+	else if (NextLevelStateIndex == StateIndex)
+	{
+		Parameters = NextLevelParameters;
+		NextLevelStateIndex = -1;
+	}
+	else
+	{
+		Parameters = GetLevelParameters(StateIndex, LevelStream);
+	}
+	CurrentLevelParameters = Parameters;
 
-	case 6:
+	if (Parameters.IsLastLevel)
+	{
 		Maze->GenerateLastLevel();
 		// Remove the previous Fade Out callback and replace it by the one for the end game
 		Maze->EndTriggerVolume->OnFadeOutLaunched().Remove(FadeOutHandle);
 		FadeOutHandle = Maze->EndTriggerVolume->OnFadeOutLaunched().AddUFunction(this, FName("LaunchLastFadeOut"));
 		// Warn Maze that it should not Destroy the Maze juste yet - remove the callback for now
 		Maze->UnsubscribeDestroyMaze();
-		StateIndex += 1;
-		break;
+	}
+	else if (PlayUnboundedMaze)
+	{
+		// A maze without bounds, generated around the player as it looks for the exit
+		Maze->GenerateUnbounded(LevelStream.GetUnsignedInt());
+	}
+	else if (IsRetryingLevel)
+	{
+		// Retry after Death: the same level again, restored from its snapshot, or its floors spawned again
+		Maze->RetryLevel();
+	}
+	else if (Parameters.Floors > 1 && Parameters.LibraryEntry < 0)
+	{
+		// Stacked floors, only the one of the player and the ones next to it are spawned
+		Maze->GenerateFloors(Parameters.SizeX, Parameters.SizeY, Parameters.Floors, Parameters.NumberOfMonsters, Parameters.MonsterPathLength);
+	}
+	else if (PrebuiltStateIndex == StateIndex && Maze->HasNextLevel())
+	{
+		// The level has been built during the previous one, it only has to be swapped in
+		Maze->ActivateNextLevel();
+		PrebuiltStateIndex = -1;
+	}
+	else
+	{
+		// Otherwise (first level, prepared level discarded), generate it now
+		FMazeLayout LibraryLayout;
+		if (LoadLibraryLayout(Parameters, LibraryLayout))
+		{
+			Maze->Generate(LibraryLayout);
+		}
+		else
+		{
+			Maze->Generate(Parameters.SizeX, Parameters.SizeY, Parameters.NumberOfMonsters, Parameters.MonsterPathLength, Parameters.DeathTimer);
+		}
+	}
+	LevelRecorder.SetLevel(StateIndex, Parameters.IsLastLevel, IsRetryingLevel, Maze->GetLayout());
+	if (Parameters.IsLastLevel)
+	{
+		// The End music plays when this level is over, it streams meanwhile
+		AudioManager->StreamEndMusic();
+	}
+	StateIndex += 1;
+	IsRetryingLevel = false;
 
-	default:
-		Maze->Generate(FMath::RandRange(10, 30), FMath::RandRange(10, 30), FMath::RandRange(10, 30), FMath::RandRange(10, 30), FMath::RandRange(60, 240));
-		StateIndex += 1;
+	// Then, start preparing the following level while this one is played
+	PrebuildNextLevel();
+}
+
+void AAmazeingGameMode::PrebuildNextLevel()
+{
+	// After the last level, the game restarts from the first one
+	int NextStateIndex = StateIndex > LastLevelIndex ? 0 : StateIndex;
+
+	// Still valid, for instance when a level is retried after Death
+	if (PrebuiltStateIndex == NextStateIndex && Maze->HasNextLevel())
+	{
+		return;
+	}
+
+	if (NextLevelStateIndex != NextStateIndex)
+	{
+		NextLevelParameters = GetLevelParameters(NextStateIndex, LevelStream);
+		NextLevelStateIndex = NextStateIndex;
+	}
+	const FMazeLevelParameters& Parameters = NextLevelParameters;
+
+	// The blueprints the next level needs and the previous ones did not, Death and the last level, stream during this one
+	Maze->StreamBlueprints(Parameters.IsLastLevel, Parameters.DeathTimer > 0);
+
+	if (Parameters.IsLastLevel || PlayUnboundedMaze || (Parameters.Floors > 1 && Parameters.LibraryEntry < 0))
+	{
+		Maze->DiscardNextLevel();
+		PrebuiltStateIndex = -1;
+	}
+	else
+	{
+		FMazeLayout LibraryLayout;
+		if (LoadLibraryLayout(Parameters, LibraryLayout))
+		{
+			Maze->PrepareNextLevel(LibraryLayout);
+		}
+		else
+		{
+			Maze->PrepareNextLevel(Parameters.SizeX, Parameters.SizeY, Parameters.NumberOfMonsters, Parameters.MonsterPathLength, Parameters.DeathTimer);
+		}
+		PrebuiltStateIndex = NextStateIndex;
 	}
 }
 
@@ -218,6 +420,7 @@ void AAmazeingGameMode::DecrementIndex()
 {
 	// We will reload the same state next time the maze is generated
 	StateIndex -= 1;
+	IsRetryingLevel = true;
 
 	// Also warns the audio manager that the ambient sound should be the same as before
 	AudioManager->DecrementAudioIndex();
@@ -225,6 +428,9 @@ void AAmazeingGameMode::DecrementIndex()
 
 void AAmazeingGameMode::LaunchMonsterKillFadeOut()
 {
+	// The player is frozen until the end of the fade in
+	Maze->GetIdleScheduler().SetWindowOpen(EMazeIdleWindow::MonsterKill, true);
+
 	// Show the UMG
 	TransitionWidget->SetVisibility(ESlateVisibility::Visible);
 
@@ -254,6 +460,8 @@ void AAmazeingGameMode::LaunchMonsterKillFadeIn()
 
 void AAmazeingGameMode::MonsterKillFadeInActions()
 {
+	Maze->GetIdleScheduler().SetWindowOpen(EMazeIdleWindow::MonsterKill, false);
+
 	// Hide the UMG
 	TransitionWidget->SetVisibility(ESlateVisibility::Hidden);
 
@@ -263,6 +471,8 @@ void AAmazeingGameMode::MonsterKillFadeInActions()
 
 void AAmazeingGameMode::LaunchLastFadeOut(bool IsDeathKill)
 {
+	Maze->GetIdleScheduler().SetWindowOpen(EMazeIdleWindow::FadeOut, true);
+
 		// TO DO: Lancer sons de Nico !
 		// + Lancer son au dbut du jeu aussi
 		// + Lancer son dans le LastFadeOutActions pour le reset du jeu aussi
@@ -4,12 +4,62 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "MazeLibrary.h"
+#include "MazeTelemetry.h"
 #include "AmazeingGameMode.generated.h"
 
 // Declaration of event signature
 DECLARE_EVENT(AAmazeingGameMode, FFade)
 
-UCLASS(minimalapi)
+/**
+* Parameters of a level, as given by the level table of the game mode
+*/
+USTRUCT()
+struct FMazeLevelParameters
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+		int32 SizeX;
+
+	UPROPERTY()
+		int32 SizeY;
+
+	UPROPERTY()
+		int32 NumberOfMonsters;
+
+	UPROPERTY()
+		int32 MonsterPathLength;
+
+	// 0 if there is no Death in this level
+	UPROPERTY()
+		int32 DeathTimer;
+
+	// The last level is a blueprint, not a generated maze
+	UPROPERTY()
+		bool IsLastLevel;
+
+	// Maze of the library to use instead of generating one, -1 if none
+	UPROPERTY()
+		int32 LibraryEntry;
+
+	// Number of stacked floors linked by stairs, 1 for a flat maze. There is no Death in a maze of several floors
+	UPROPERTY()
+		int32 Floors;
+
+	FMazeLevelParameters()
+		: SizeX(0), SizeY(0), NumberOfMonsters(0), MonsterPathLength(0), DeathTimer(0), IsLastLevel(false), LibraryEntry(-1), Floors(1)
+	{
+	}
+
+	FMazeLevelParameters(int32 InSizeX, int32 InSizeY, int32 InNumberOfMonsters, int32 InMonsterPathLength, int32 InDeathTimer = 0, int32 InFloors = 1)
+		: SizeX(InSizeX), SizeY(InSizeY), NumberOfMonsters(InNumberOfMonsters), MonsterPathLength(InMonsterPathLength), DeathTimer(InDeathTimer), IsLastLevel(false), LibraryEntry(-1), Floors(InFloors)
+	{
+	}
+};
+
+UCLASS(minimalapi, config = Game)
 class AAmazeingGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
@@ -66,15 +116,32 @@ public:
 	// Used for treating Death
 	void DecrementIndex();
 
+	// Returns the parameters of the level at the given state index, the levels after the last one are random, drawn from the stream
+	FMazeLevelParameters GetLevelParameters(int32 Index, FRandomStream& Stream) const;
+
+	// State index of the last level, after which the game restarts
+	static int32 GetLastLevelIndex() { return LastLevelIndex; }
+
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	void GenerateMaze();
 
+	// Prepares, while the current level is played, the level that should come next
+	void PrebuildNextLevel();
+
+	// Loads the layout of a level taken from the maze library, returns false if the level is not from the library
+	bool LoadLibraryLayout(const FMazeLevelParameters& Parameters, FMazeLayout& OutLayout) const;
+
+	// Logs the time from the launch to the first frame the player can move, and writes it down with -MazeStartupBenchmark
+	void LogStartupTime() const;
+
 private:
-	// Reference the UMG asset
+	// Reference the UMG asset, loaded when the game starts rather than with the default object
 	UPROPERTY()
-		TSubclassOf<class UTransitionWidget> UMGTransitionWidget;
+		TSoftClassPtr<class UTransitionWidget> UMGTransitionWidget;
 
 	// Variable to hold the Transition Widget after creating it
 	UPROPERTY()
@@ -95,6 +162,67 @@ private:
 	// Indicates the current Index of the game state
 	int StateIndex;
 
+	// State index of the last level, after which the game restarts
+	static const int LastLevelIndex = 6;
+
+	// State index of the level prepared by the Maze, -1 if none
+	int PrebuiltStateIndex;
+
+	// Parameters of the next level, chosen once by PrebuildNextLevel so that GenerateMaze builds the same level
+	FMazeLevelParameters NextLevelParameters;
+
+	// State index of NextLevelParameters, -1 if they have not been chosen yet
+	int NextLevelStateIndex;
+
+	// Parameters of the level being played, so that a retry after Death is the same level
+	FMazeLevelParameters CurrentLevelParameters;
+
+	// Whether or not the next generated level is a retry of the current one, after a Death kill
+	bool IsRetryingLevel;
+
+	// Library of pregenerated mazes for the random levels, relative to the project directory; empty to generate them at run time
+	UPROPERTY(Config)
+		FString MazeLibraryPath;
+
+	// Solution length range of the library mazes used for the random levels
+	UPROPERTY(Config)
+		int32 EndlessMinSolutionLength;
+
+	UPROPERTY(Config)
+		int32 EndlessMaxSolutionLength;
+
+	// Pregenerated mazes, mapped in memory
+	FMazeLibrary MazeLibrary;
+
+	// Whether or not every level but the last one is an unbounded maze, generated around the player
+	UPROPERTY(Config)
+		bool PlayUnboundedMaze;
+
+	// Number of floors of the random levels, 1 for flat mazes with Death, also set by -MazeFloors=
+	UPROPERTY(Config)
+		int32 EndlessFloors;
+
+	// Gives the parameters of the random levels and the mazes picked from the library
+	FRandomStream LevelStream;
+
+	// Whether or not the frame times, hitches and counts of every level are written to Saved/Profiling/MazeLevels, also set by -MazeTelemetry
+	// Off in the project config: only the installs we want field data from turn it on, in their own config
+	UPROPERTY(Config)
+		bool RecordLevelTelemetry;
+
+	// Frames slower than that are recorded as hitches, in ms
+	UPROPERTY(Config)
+		float HitchThresholdMs;
+
+	// Records the telemetry of the levels
+	FMazeLevelRecorder LevelRecorder;
+
+	// Whether or not the startup time has been logged, on the first fade in
+	bool IsStartupTimed;
+
+	// Time since the process started when the game mode began play, in s
+	double BeginPlayTime;
+
 	// Event for Fade In
 	FFade FadeInFinishedEvent;
 
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnalyzeMazesCommandlet.h"
+#include "MazeAnalytics.h"
+#include "AmazeingGameMode.h"
+#include "Misc/Paths.h"
+
+UAnalyzeMazesCommandlet::UAnalyzeMazesCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAnalyzeMazesCommandlet::Main(const FString& Params)
+{
+	FMazeBatchSettings Settings;
+	Settings.Count = 100000;
+	Settings.PlaceStartEndFarthest = FParse::Param(*Params, TEXT("Farthest"));
+	FString Output = FPaths::ProfilingDir() / TEXT("MazeAnalytics.csv");
+	FParse::Value(*Params, TEXT("Count="), Settings.Count);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+	FParse::Value(*Params, TEXT("Output="), Output);
+
+	// The batches to analyze: a single one from the command line, otherwise the mazes of the scripted levels
+	TArray<TPair<FString, FMazeBatchSettings>> Batches;
+	if (FParse::Value(*Params, TEXT("SizeX="), Settings.SizeX) && FParse::Value(*Params, TEXT("SizeY="), Settings.SizeY))
+	{
+		FParse::Value(*Params, TEXT("Monsters="), Settings.NumberOfMonsters);
+		FParse::Value(*Params, TEXT("PathLength="), Settings.MonsterPathLength);
+		Batches.Add(TPair<FString, FMazeBatchSettings>(FString::Printf(TEXT("%dx%d"), Settings.SizeX, Settings.SizeY), Settings));
+	}
+	else
+	{
+		const AAmazeingGameMode* GameMode = GetDefault<AAmazeingGameMode>();
+		FRandomStream LevelStream(0);
+		for (int32 Level = 0; Level < AAmazeingGameMode::GetLastLevelIndex(); Level++)
+		{
+			FMazeLevelParameters Parameters = GameMode->GetLevelParameters(Level, LevelStream);
+			Settings.SizeX = Parameters.SizeX;
+			Settings.SizeY = Parameters.SizeY;
+			Settings.NumberOfMonsters = Parameters.NumberOfMonsters;
+			Settings.MonsterPathLength = Parameters.MonsterPathLength;
+			Batches.Add(TPair<FString, FMazeBatchSettings>(FString::Printf(TEXT("Level%d"), Level), Settings));
+		}
+	}
+
+	FMazeBatchAnalysis Analysis;
+	for (const TPair<FString, FMazeBatchSettings>& Batch : Batches)
+	{
+		Analysis.Run(Batch.Value);
+		Analysis.LogSummary();
+		if (!Analysis.AppendToCSV(Output, Batch.Key))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Maze analytics: cannot write %s"), *Output);
+			return 1;
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Maze analytics histograms written to %s"), *Output);
+	return 0;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AnalyzeMazesCommandlet.generated.h"
+
+/**
+* Offline tool analyzing batches of seeded mazes on every core, to tune the level table of the game mode from data
+* Every scripted level of the game mode by default, or a single size when SizeX and SizeY are given
+* Usage: UE4Editor-Cmd TGWLIHE -run=AnalyzeMazes -Count=1000000 -Seed=0 [-SizeX=10 -SizeY=10 -Monsters=5 -PathLength=15] [-Farthest] [-Output=Saved/Profiling/MazeAnalytics.csv]
+*/
+UCLASS()
+class TGWLIHE_API UAnalyzeMazesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAnalyzeMazesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -2,10 +2,23 @@
 
 #include "AudioManager.h"
 #include "UObject/ConstructorHelpers.h"
-#include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "Maze.h"
 #include "EndTriggerVolume.h"
 #include "Runtime/Engine/Classes/Components/AudioComponent.h"
+#include "Engine/AssetManager.h"
+#include "Sound/SoundCue.h"
+#include "Sound/SoundNodeWavePlayer.h"
+#include "Sound/SoundWave.h"
+#include "MazeActorRegistry.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("PlayFootstep"), STAT_MazeAudioPlayFootstep, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("PlayDeathSound"), STAT_MazeAudioPlayDeathSound, STATGROUP_Maze);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Audio voices playing"), STAT_MazeAudioVoicesPlaying, STATGROUP_Maze);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Audio voices stolen"), STAT_MazeAudioVoicesStolen, STATGROUP_Maze);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Audio sounds dropped"), STAT_MazeAudioSoundsDropped, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Audio cue loaded late"), STAT_MazeAudioLateLoad, STATGROUP_Maze);
+DECLARE_MEMORY_STAT(TEXT("Audio cues resident"), STAT_MazeAudioResidentMemory, STATGROUP_Maze);
 
 AAudioManager::AAudioManager()
 {
@@ -14,6 +27,26 @@ AAudioManager::AAudioManager()
 
 	// Create the other audio component
 	MusicBoxPlayer = CreateDefaultSubobject<UAudioComponent>(TEXT("MusicBoxPlayer"));
+
+	// And the one of the End music, which plays for long
+	EndMusicPlayer = CreateDefaultSubobject<UAudioComponent>(TEXT("EndMusicPlayer"));
+	EndMusicPlayer->bAutoActivate = false;
+	EndMusicPlayer->bAllowSpatialization = false;
+
+	// Create the voices of the one-shot sounds, which are only ever played again
+	for (int32 i = 0; i < VoiceCount; i++)
+	{
+		Voices[i].Component = CreateDefaultSubobject<UAudioComponent>(*FString::Printf(TEXT("Voice%d"), i));
+		Voices[i].Component->bAutoActivate = false;
+		Voices[i].Component->bAllowSpatialization = false;
+	}
+
+	// Two footsteps may overlap, the Death timer may overlap its arrival and the kill
+	VoiceLimits[EMazeVoiceCategory::Footstep] = 2;
+	VoiceLimits[EMazeVoiceCategory::Cue] = 3;
+	VoiceLimits[EMazeVoiceCategory::Death] = 3;
+
+	StreamedAmbientIndex = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
@@ -21,6 +54,8 @@ void AAudioManager::BeginPlay()
 {
 	Super::BeginPlay();
 
+	FMazeActorRegistry::Register(this);
+
 	// Subscribe to the Maze event related to the presence of Death, to launch the audio timer
 	Maze->OnDeathPresent().AddUFunction(this, FName("PlayDeathSoundWithTimer"));
 
@@ -39,18 +74,33 @@ void AAudioManager::BeginPlay()
 	// Initialize the other variables
 	IsLeftFootstep = false;
 	AudioIndex = 0;
+
+	// Only the footsteps and the music box are loaded with the manager, the ambient cue of the first level streams during its transition
+	UpdateAmbientStreaming();
+	UpdateResidentMemory();
+	UE_LOG(LogTemp, Log, TEXT("Maze audio: manager started %.2f s after launch"), FPlatformTime::Seconds() - GStartTime);
 }
 
 void AAudioManager::PlayDeathSound()
 {
-	if (DeathTimerCue)
+	SCOPE_CYCLE_COUNTER(STAT_MazeAudioPlayDeathSound);
+
+	if (!DeathTimerCue.IsNull())
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), DeathTimerCue, 1.0f, 1.0f, 0.0f);
+		PlayVoice(GetStreamedSound(DeathTimerCue), EMazeVoiceCategory::Death, 1.0f);
 	}
 }
 
 void AAudioManager::PlayDeathSoundWithTimer(int DeathArrivalTime)
 {
+	// The first Death sound is a fifth of the arrival time away, which leaves the cues of Death the time to stream
+	TArray<FSoftObjectPath> DeathCues;
+	DeathCues.Add(DeathTimerCue.ToSoftObjectPath());
+	DeathCues.Add(DeathArrivalCue.ToSoftObjectPath());
+	DeathCues.Add(DeathKillCue.ToSoftObjectPath());
+	DeathCues.Add(GirlScreamCue.ToSoftObjectPath());
+	StreamCues(DeathCues, DeathHandle);
+
 	// Create the timer for the death sound
 	GetWorld()->GetTimerManager().SetTimer(DeathTimerHandle, this, &AAudioManager::PlayDeathSound, DeathArrivalTime / 5.0f, true);
 }
@@ -70,22 +120,24 @@ void AAudioManager::PlayDeathArrivalSound()
 	PlayDeathSound();
 
 	// Play the sound
-	if (DeathArrivalCue)
+	if (!DeathArrivalCue.IsNull())
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), DeathArrivalCue, 1.0f, 1.0f, 0.0f);
+		PlayVoice(GetStreamedSound(DeathArrivalCue), EMazeVoiceCategory::Death, 1.0f);
 	}
 }
 
 void AAudioManager::PlayFootstep()
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeAudioPlayFootstep);
+
 	if (IsLeftFootstep)
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), FootstepCues[0], 0.05f, 1.0f, 0.0f);
+		PlayVoice(FootstepCues[0], EMazeVoiceCategory::Footstep, 0.05f);
 		IsLeftFootstep = false;
 	}
 	else
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), FootstepCues[1], 0.05f, 1.0f, 0.0f);
+		PlayVoice(FootstepCues[1], EMazeVoiceCategory::Footstep, 0.05f);
 		IsLeftFootstep = true;
 	}
 }
@@ -93,18 +145,18 @@ void AAudioManager::PlayFootstep()
 void AAudioManager::PlayDeathKillSound()
 {
 	// Play the sound
-	if (DeathKillCue)
+	if (!DeathKillCue.IsNull())
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), DeathKillCue, 1.0f, 1.0f, 0.0f);
+		PlayVoice(GetStreamedSound(DeathKillCue), EMazeVoiceCategory::Death, 1.0f);
 	}
 }
 
 void AAudioManager::PlayGirlScream()
 {
 	// Play the sound
-	if (GirlScreamCue)
+	if (!GirlScreamCue.IsNull())
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), GirlScreamCue, 1.0f, 1.0f, 0.0f);
+		PlayVoice(GetStreamedSound(GirlScreamCue), EMazeVoiceCategory::Cue, 1.0f);
 	}
 }
 
@@ -121,20 +173,43 @@ void AAudioManager::PlayMusicBox()
 void AAudioManager::PlayEndMusic()
 {
 	// Play the sound
-	if (EndCue)
+	if (!EndCue.IsNull())
 	{
-		UGameplayStatics::PlaySound2D(GetWorld(), EndCue, 1.0f, 1.0f, 0.0f);
+		EndMusicPlayer->SetSound(GetStreamedSound(EndCue));
+		EndMusicPlayer->Play(0.0f);
 	}
+
+	// The component keeps the cue while it plays
+	if (EndHandle.IsValid())
+	{
+		EndHandle->ReleaseHandle();
+		EndHandle.Reset();
+	}
+}
+
+void AAudioManager::StreamEndMusic()
+{
+	TArray<FSoftObjectPath> EndCues;
+	EndCues.Add(EndCue.ToSoftObjectPath());
+	StreamCues(EndCues, EndHandle);
 }
 
 void AAudioManager::FadeInAmbient()
 {
-	if (AmbientCues[AudioIndex])
+	if (AudioIndex < ARRAY_COUNT(AmbientCues) && !AmbientCues[AudioIndex].IsNull())
 	{
-		AudioPlayer->SetSound(AmbientCues[AudioIndex]);
+		AudioPlayer->SetSound(GetStreamedSound(AmbientCues[AudioIndex]));
 		AudioPlayer->FadeIn(2.0f, 1.0f, 0.0f);
 		AudioIndex += 1;
 	}
+
+	// A new level starts: the cues of Death are streamed again if it is present, the previous ambient cue is only kept by the audio player
+	if (DeathHandle.IsValid())
+	{
+		DeathHandle->ReleaseHandle();
+		DeathHandle.Reset();
+	}
+	UpdateAmbientStreaming();
 }
 
 void AAudioManager::FadeOutAmbient()
@@ -145,9 +220,185 @@ void AAudioManager::FadeOutAmbient()
 void AAudioManager::DecrementAudioIndex()
 {
 	AudioIndex -= 1;
+	UpdateAmbientStreaming();
 }
 
 void AAudioManager::ResetAudioIndex()
 {
 	AudioIndex = 0;
-}
\ No newline at end of file
+	UpdateAmbientStreaming();
+}
+
+void AAudioManager::StreamCues(const TArray<FSoftObjectPath>& Cues, TSharedPtr<FStreamableHandle>& Handle)
+{
+	if (Handle.IsValid())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> ValidCues;
+	for (const FSoftObjectPath& Cue : Cues)
+	{
+		if (Cue.IsValid())
+		{
+			ValidCues.Add(Cue);
+		}
+	}
+	if (ValidCues.Num() > 0)
+	{
+		Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(ValidCues, FStreamableDelegate::CreateUObject(this, &AAudioManager::OnCuesStreamed, FPlatformTime::Seconds()));
+	}
+}
+
+void AAudioManager::OnCuesStreamed(double RequestTime)
+{
+	UE_LOG(LogTemp, Log, TEXT("Maze audio: cues streamed in %.1f ms"), (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+	UpdateResidentMemory();
+}
+
+void AAudioManager::UpdateAmbientStreaming()
+{
+	if (StreamedAmbientIndex == AudioIndex)
+	{
+		return;
+	}
+
+	// The cue of the previous level is released, the audio player keeps it loaded until it plays another one
+	if (AmbientHandle.IsValid())
+	{
+		AmbientHandle->ReleaseHandle();
+		AmbientHandle.Reset();
+	}
+
+	StreamedAmbientIndex = AudioIndex;
+	if (AudioIndex < ARRAY_COUNT(AmbientCues))
+	{
+		TArray<FSoftObjectPath> NextCues;
+		NextCues.Add(AmbientCues[AudioIndex].ToSoftObjectPath());
+		StreamCues(NextCues, AmbientHandle);
+	}
+}
+
+USoundBase* AAudioManager::GetStreamedSound(const TSoftObjectPtr<USoundBase>& Cue) const
+{
+	USoundBase* Sound = Cue.Get();
+	if (!Sound && !Cue.IsNull())
+	{
+		// Still streaming: we wait for it rather than play nothing
+		SCOPE_CYCLE_COUNTER(STAT_MazeAudioLateLoad);
+		UE_LOG(LogTemp, Warning, TEXT("Maze audio: %s not streamed in time, loaded now"), *Cue.ToString());
+		Sound = Cue.LoadSynchronous();
+		UpdateResidentMemory();
+	}
+	return Sound;
+}
+
+void AAudioManager::UpdateResidentMemory() const
+{
+#if STATS
+	// The size of a cue is the size of the waves it plays, the cues of the manager being loaded or not
+	TArray<USoundBase*> Sounds;
+	Sounds.Add(MusicBoxCue);
+	Sounds.Add(FootstepCues[0]);
+	Sounds.Add(FootstepCues[1]);
+	for (const TSoftObjectPtr<USoundBase>& Cue : AmbientCues)
+	{
+		Sounds.Add(Cue.Get());
+	}
+	Sounds.Add(DeathTimerCue.Get());
+	Sounds.Add(DeathArrivalCue.Get());
+	Sounds.Add(DeathKillCue.Get());
+	Sounds.Add(GirlScreamCue.Get());
+	Sounds.Add(EndCue.Get());
+
+	TSet<USoundWave*> Waves;
+	for (USoundBase* Sound : Sounds)
+	{
+		if (USoundWave* Wave = Cast<USoundWave>(Sound))
+		{
+			Waves.Add(Wave);
+		}
+		else if (USoundCue* Cue = Cast<USoundCue>(Sound))
+		{
+			TArray<USoundNodeWavePlayer*> WavePlayers;
+			Cue->RecursiveFindNode<USoundNodeWavePlayer>(Cue->FirstNode, WavePlayers);
+			for (USoundNodeWavePlayer* WavePlayer : WavePlayers)
+			{
+				if (WavePlayer->GetSoundWave())
+				{
+					Waves.Add(WavePlayer->GetSoundWave());
+				}
+			}
+		}
+	}
+
+	int64 ResidentBytes = 0;
+	for (USoundWave* Wave : Waves)
+	{
+		ResidentBytes += Wave->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+	SET_MEMORY_STAT(STAT_MazeAudioResidentMemory, ResidentBytes);
+#endif
+}
+
+int32 AAudioManager::GetPlayingVoiceCount() const
+{
+	int32 PlayingCount = 0;
+	for (const FMazeAudioVoice& Voice : Voices)
+	{
+		PlayingCount += Voice.Component->IsPlaying() ? 1 : 0;
+	}
+	return PlayingCount;
+}
+
+void AAudioManager::PlayVoice(USoundBase* Sound, EMazeVoiceCategory::Type Category, float VolumeMultiplier)
+{
+	if (!Sound)
+	{
+		return;
+	}
+
+	// The oldest voice of the category, the oldest one it may steal, and an idle one
+	int32 CategoryCount = 0;
+	FMazeAudioVoice* OldestOfCategory = nullptr;
+	FMazeAudioVoice* OldestStealable = nullptr;
+	FMazeAudioVoice* IdleVoice = nullptr;
+	for (FMazeAudioVoice& Voice : Voices)
+	{
+		if (!Voice.Component->IsPlaying())
+		{
+			IdleVoice = IdleVoice ? IdleVoice : &Voice;
+			continue;
+		}
+		if (Voice.Category == Category)
+		{
+			CategoryCount += 1;
+			OldestOfCategory = (!OldestOfCategory || Voice.StartTime < OldestOfCategory->StartTime) ? &Voice : OldestOfCategory;
+		}
+		if (Voice.Category <= Category && (!OldestStealable || Voice.StartTime < OldestStealable->StartTime))
+		{
+			OldestStealable = &Voice;
+		}
+	}
+
+	// A category at its limit replaces its oldest sound, otherwise an idle voice plays it, otherwise a lower priority sound is cut
+	FMazeAudioVoice* Chosen = CategoryCount >= VoiceLimits[Category] ? OldestOfCategory : (IdleVoice ? IdleVoice : OldestStealable);
+	if (!Chosen)
+	{
+		INC_DWORD_STAT(STAT_MazeAudioSoundsDropped);
+		return;
+	}
+	if (Chosen->Component->IsPlaying())
+	{
+		INC_DWORD_STAT(STAT_MazeAudioVoicesStolen);
+		Chosen->Component->Stop();
+	}
+
+	Chosen->Category = Category;
+	Chosen->StartTime = GetWorld()->GetTimeSeconds();
+	Chosen->Component->SetSound(Sound);
+	Chosen->Component->SetVolumeMultiplier(VolumeMultiplier);
+	Chosen->Component->Play(0.0f);
+
+	SET_DWORD_STAT(STAT_MazeAudioVoicesPlaying, GetPlayingVoiceCount());
+}
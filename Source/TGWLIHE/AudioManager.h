@@ -4,8 +4,47 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
 #include "AudioManager.generated.h"
 
+/**
+* Categories of the one-shot sounds, from the lowest priority to the highest: a sound can only steal the voice of a sound of its category or below
+*/
+namespace EMazeVoiceCategory
+{
+	enum Type : uint8
+	{
+		Footstep,
+		Cue,
+		Death,
+		Count
+	};
+}
+
+/**
+* A reusable voice of the pool of the audio manager
+*/
+USTRUCT()
+struct FMazeAudioVoice
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+		class UAudioComponent* Component;
+
+	// Category of the sound last played, EMazeVoiceCategory
+	uint8 Category;
+
+	// Time the sound last played started, to steal the oldest one
+	float StartTime;
+
+	FMazeAudioVoice()
+		: Component(nullptr), Category(EMazeVoiceCategory::Footstep), StartTime(0.0f)
+	{
+	}
+};
+
 UCLASS()
 class TGWLIHE_API AAudioManager : public AActor
 {
@@ -46,6 +85,9 @@ public:
 	UFUNCTION()
 		void PlayEndMusic();
 
+	// Starts streaming the End music cue, for the last level
+	void StreamEndMusic();
+
 	// Plays a footstep sound randomly
 	void PlayFootstep();
 
@@ -63,34 +105,59 @@ public:
 	// Resets the ambient sounds table index - used for restarting the game
 	void ResetAudioIndex();
 
+	// Number of voices of the pool playing a sound
+	int32 GetPlayingVoiceCount() const;
+
+	// Number of voices of the pool
+	static const int32 VoiceCount = 8;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
 private:
-	// Cue of the Death timer
+	// Plays a one-shot sound on a voice of the pool: an idle one, or the oldest one of its category or below, or not at all
+	void PlayVoice(class USoundBase* Sound, EMazeVoiceCategory::Type Category, float VolumeMultiplier);
+
+	// Starts streaming the given cues, unless the handle already does
+	void StreamCues(const TArray<FSoftObjectPath>& Cues, TSharedPtr<FStreamableHandle>& Handle);
+
+	// Called when streamed cues are loaded
+	void OnCuesStreamed(double RequestTime);
+
+	// Streams the ambient cue of the next level, and releases the other ones
+	void UpdateAmbientStreaming();
+
+	// Gives the sound of a cue, loaded now if it has not been streamed in time
+	class USoundBase* GetStreamedSound(const TSoftObjectPtr<class USoundBase>& Cue) const;
+
+	// Updates the memory stat of the cues loaded
+	void UpdateResidentMemory() const;
+
+private:
+	// Cue of the Death timer, streamed when Death is present
 	UPROPERTY(EditAnywhere)
-		class USoundBase* DeathTimerCue;
+		TSoftObjectPtr<class USoundBase> DeathTimerCue;
 
-	// Cue of the Death arrival
+	// Cue of the Death arrival, streamed when Death is present
 	UPROPERTY(EditAnywhere)
-		class USoundBase* DeathArrivalCue;
+		TSoftObjectPtr<class USoundBase> DeathArrivalCue;
 
-	// Cue of the Death Kill
+	// Cue of the Death Kill, streamed when Death is present
 	UPROPERTY(EditAnywhere)
-		class USoundBase* DeathKillCue;
+		TSoftObjectPtr<class USoundBase> DeathKillCue;
 
-	// Cue of the Girl scream
+	// Cue of the Girl scream, streamed when Death is present
 	UPROPERTY(EditAnywhere)
-		class USoundBase* GirlScreamCue;
+		TSoftObjectPtr<class USoundBase> GirlScreamCue;
 
 	// Cue of the Music box
 	UPROPERTY(EditAnywhere)
 		class USoundBase* MusicBoxCue;
 
-	// Cue of the End music
+	// Cue of the End music, streamed for the last level
 	UPROPERTY(EditAnywhere)
-		class USoundBase* EndCue;
+		TSoftObjectPtr<class USoundBase> EndCue;
 
 	// Maze instance
 	UPROPERTY(EditAnywhere)
@@ -114,14 +181,34 @@ private:
 	UPROPERTY()
 	UAudioComponent* MusicBoxPlayer;
 
+	// Audio component of the End music, out of the voices so that no one-shot sound takes it over
+	UPROPERTY()
+	UAudioComponent* EndMusicPlayer;
+
 	// End trigger, used to subscribe to the event
 	UPROPERTY(EditAnywhere)
 		class AEndTriggerVolume* EndTrigger;
 
-	// Ambient sound cues
+	// Ambient sound cues, the one of the next level is streamed during the current one
 	UPROPERTY(EditAnywhere)
-		class USoundBase* AmbientCues[8];
+		TSoftObjectPtr<class USoundBase> AmbientCues[8];
 
 	// Ambient sound table index
 		uint8 AudioIndex;
+
+	// Loads of the streamed cues: released, the cues are unloaded by the garbage collection once no audio component plays them anymore
+	TSharedPtr<FStreamableHandle> AmbientHandle;
+	TSharedPtr<FStreamableHandle> DeathHandle;
+	TSharedPtr<FStreamableHandle> EndHandle;
+
+	// Index of the ambient cue being streamed
+	int32 StreamedAmbientIndex;
+
+	// Voices of the one-shot sounds, created once with the manager
+	UPROPERTY()
+		FMazeAudioVoice Voices[VoiceCount];
+
+	// Maximum number of voices playing a sound of each category at the same time, EMazeVoiceCategory
+	UPROPERTY(EditAnywhere)
+		int32 VoiceLimits[EMazeVoiceCategory::Count];
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BakeMazeLibraryCommandlet.h"
+#include "MazeLibrary.h"
+#include "Misc/Paths.h"
+
+UBakeMazeLibraryCommandlet::UBakeMazeLibraryCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UBakeMazeLibraryCommandlet::Main(const FString& Params)
+{
+	// Parameters, with the ranges of the random levels of the game mode by default
+	int32 Count = 10000;
+	int32 Seed = 0;
+	int32 MinSize = 10;
+	int32 MaxSize = 30;
+	FString Output = FPaths::ProjectContentDir() / TEXT("MazeLibrary/Endless.mazelib");
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MinSize="), MinSize);
+	FParse::Value(*Params, TEXT("MaxSize="), MaxSize);
+	FParse::Value(*Params, TEXT("Output="), Output);
+
+	// Each maze is planned from its own seed, drawn from the library seed, so that a library can be baked again identically
+	FRandomStream Stream(Seed);
+	TArray<FMazeLayout> Layouts;
+	Layouts.Reserve(Count);
+	int32 Rejected = 0;
+	double StartTime = FPlatformTime::Seconds();
+	while (Layouts.Num() < Count && Rejected <= Count)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(Stream.RandRange(MinSize, MaxSize), Stream.RandRange(MinSize, MaxSize), Stream.RandRange(10, 30), Stream.RandRange(10, 30), Stream.RandRange(60, 240), Stream.GetUnsignedInt());
+
+		// Only valid mazes go in the library
+		if (Layout.Validate())
+		{
+			Layouts.Add(Layout);
+		}
+		else
+		{
+			Rejected += 1;
+		}
+	}
+
+	if (!FMazeLibrary::Write(Output, Layouts))
+	{
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Baked %d mazes (%d rejected) in %.1f s to %s"), Layouts.Num(), Rejected, FPlatformTime::Seconds() - StartTime, *Output);
+	return 0;
+}
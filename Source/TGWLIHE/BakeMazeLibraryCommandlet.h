@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BakeMazeLibraryCommandlet.generated.h"
+
+/**
+* Offline tool baking a library of validated mazes for the endless mode
+* Usage: UE4Editor-Cmd TGWLIHE -run=BakeMazeLibrary -Count=10000 -Seed=0 -Output=Content/MazeLibrary/Endless.mazelib
+*/
+UCLASS()
+class TGWLIHE_API UBakeMazeLibraryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBakeMazeLibraryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -2,22 +2,9 @@
 
 #include "DeathKill.h"
 #include "EndTriggerVolume.h"
-#include "EngineUtils.h"
+#include "MazeActorRegistry.h"
 #include "AmazeingGameMode.h"
 
-UDeathKill::UDeathKill()
-{
-	// Grab the Maze Instance
-	if (GetWorld())
-	{
-		for (TActorIterator<AEndTriggerVolume> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			EndTriggerVolume = *ActorItr;
-		}
-	}
-}
-
 EBTNodeResult::Type UDeathKill::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
 	// Find the GameMode
@@ -29,7 +16,12 @@ EBTNodeResult::Type UDeathKill::ExecuteTask(UBehaviorTreeComponent& OwnerComp, u
 	}
 
 	// Then, behave like the end trigger volume was touched, instead it restarts the same level
-	EndTriggerVolume->DeathBroadcast();
+	// The node is shared by every Death, the end trigger is the one of the world of the behavior tree
+	AEndTriggerVolume* EndTriggerVolume = FMazeActorRegistry::Get<AEndTriggerVolume>(&OwnerComp);
+	if (EndTriggerVolume)
+	{
+		EndTriggerVolume->DeathBroadcast();
+	}
 
 	return EBTNodeResult::Succeeded;
 }
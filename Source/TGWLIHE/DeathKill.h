@@ -15,12 +15,6 @@ class TGWLIHE_API UDeathKill : public UBTTaskNode
 	GENERATED_BODY()
 
 public:
-	UDeathKill();
-
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
-private:
-	// EndTriggerVolume reference
-	class AEndTriggerVolume* EndTriggerVolume;
-
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "EndTriggerVolume.h"
 #include "AmazeingCharacter.h"
 #include "AmazeingGameMode.h"
+#include "MazeActorRegistry.h"
 
 AEndTriggerVolume::AEndTriggerVolume()
 {
@@ -10,6 +11,13 @@ AEndTriggerVolume::AEndTriggerVolume()
 	OnActorBeginOverlap.AddDynamic(this, &AEndTriggerVolume::OnOverlapBegin);
 }
 
+void AEndTriggerVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FMazeActorRegistry::Register(this);
+}
+
 void AEndTriggerVolume::OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor)
 {
 	if (Cast<AAmazeingCharacter>(OtherActor))
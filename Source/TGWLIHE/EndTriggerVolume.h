@@ -35,6 +35,10 @@ public:
 	// Launch the death actions, used by the Behavior tree custom Kill task of Death
 	void DeathBroadcast();
 
+protected:
+	// Called when the game starts, registers the end trigger of the world
+	virtual void BeginPlay() override;
+
 private:
 	// Event based on the delegate signature
 	FFadeOut LaunchFadeOutEvent;
@@ -2,7 +2,8 @@
 
 #include "Maze.h"
 #include "MazeCell.h"
-#include "ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "MazeActorRegistry.h"
 #include "MazePassage.h"
 #include "MazeWall.h"
 #include <EngineGlobals.h>
@@ -13,228 +14,439 @@
 #include "AICharacter.h"
 #include "AmazeingGameMode.h"
 #include "Runtime/Engine/Classes/Components/ArrowComponent.h"
+#include "MazeStats.h"
+#include "MazeTelemetry.h"
+#include "AIController.h"
+#include "UObject/UObjectIterator.h"
+#include "MazeEventSubscription.h"
+#include "MazeStairs.h"
+#include "AIMonsterController.h"
+#include "TimerManager.h"
+#include "MazeTickCosts.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DECLARE_CYCLE_STAT(TEXT("Maze Tick"), STAT_MazeTick, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Generate"), STAT_MazeGenerate, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Retry level"), STAT_MazeRetryLevel, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Prepare next level"), STAT_MazePrepareNextLevel, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Discard next level"), STAT_MazeDiscardNextLevel, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Activate level"), STAT_MazeActivateLevel, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Materialize cell"), STAT_MazeMaterializeNextCell, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("CreateCell"), STAT_MazeCreateCell, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("CreatePassage"), STAT_MazeCreatePassage, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("CreateWall"), STAT_MazeCreateWall, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("CreateAIPath"), STAT_MazeCreateAIPath, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("DestroyMaze"), STAT_MazeDestroyMaze, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Update regions"), STAT_MazeUpdateRegions, STATGROUP_Maze);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unbounded maze regions"), STAT_MazeRegions, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Update AI budget"), STAT_MazeUpdateAIBudget, STATGROUP_MazeAI);
+DECLARE_CYCLE_STAT(TEXT("EmitNoise"), STAT_MazeEmitNoise, STATGROUP_MazeAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Noise cells"), STAT_MazeNoiseCells, STATGROUP_MazeAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Animated AI characters"), STAT_MazeAnimatedCharacters, STATGROUP_MazeAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Paused AI characters animations"), STAT_MazePausedAnimations, STATGROUP_MazeAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Culled AI characters sounds"), STAT_MazeCulledSounds, STATGROUP_MazeAI);
 
 // Sets default values
 AMaze::AMaze()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// The maze only ticks while it has background work: the next level, the regions or floors around the player, or idle work in an open window
 	PrimaryActorTick.bCanEverTick = true;
 
-	// Grabs the classes of the blueprints
-	static ConstructorHelpers::FObjectFinder<UClass> CellClassFinder(TEXT("Class'/Game/Blueprints/Maze/BP_MazeCell.BP_MazeCell_C'"));
-	if (CellClassFinder.Object)
+	// The blueprints are only streamed when the game starts, they are not loaded with the default object
+	CellBlueprint = TSoftClassPtr<AMazeCell>(FSoftObjectPath(TEXT("/Game/Blueprints/Maze/BP_MazeCell.BP_MazeCell_C")));
+	PassageBlueprint = TSoftClassPtr<AMazeCellEdge>(FSoftObjectPath(TEXT("/Game/Blueprints/Maze/BP_MazePassage.BP_MazePassage_C")));
+	WallBlueprint = TSoftClassPtr<AMazeCellEdge>(FSoftObjectPath(TEXT("/Game/Blueprints/Maze/BP_MazeWall.BP_MazeWall_C")));
+	LastLevelBlueprint = TSoftClassPtr<AMazeCell>(FSoftObjectPath(TEXT("/Game/Blueprints/Maze/BP_LastLevel.BP_LastLevel_C")));
+	AIMonsterBlueprint = TSoftClassPtr<AAICharacter>(FSoftObjectPath(TEXT("/Game/Blueprints/AI/BP_AICharacter.BP_AICharacter_C")));
+	AIDeathBlueprint = TSoftClassPtr<AAICharacter>(FSoftObjectPath(TEXT("/Game/Blueprints/AI/BP_AIDeath.BP_AIDeath_C")));
+
+	IsEventNeeded = false;
+	IsCountdownFinished = false;
+	IsGenerationFinished = false;
+
+	MaterializeNextLevel = true;
+	NextLevelCellsPerFrame = 4;
+	IdleFrameBudgetMs = 4.0f;
+	PlaceStartEndFarthest = false;
+	RetryWithSameLayout = true;
+	AuditTeardown = false;
+	IsTeardownAuditPending = false;
+	NextPatrolIndex = 0;
+
+	// Random seeds by default, SetSeed replaces them to play a session again
+	SeedStream.GenerateNewSeed();
+
+	RegionSize = 8;
+	RegionRadius = 1;
+	RegionBorderOpenings = 2;
+	ExitRegionDistance = 4;
+	IsUnboundedLevel = false;
+	WorldSeed = 0;
+	IsOnLastLevel = false;
+	FloorHeight = 1000.0f;
+	IsFloorLevel = false;
+	CurrentFloor = 0;
+	LayoutOffset = FVector::ZeroVector;
+	AIBudgetPeriod = 0.2f;
+	FullRateAnimationDistance = 3;
+	AnimationIntervalPerCell = 1.0f / 60.0f;
+	MaxAnimationInterval = 0.1f;
+	MaxAudibleDistance = 8;
+	OccludedLowPassFrequency = 2000.0f;
+
+	// The idle work wakes the maze tick up when it may run
+	IdleScheduler.SetWakeUp([this]() { SetActorTickEnabled(true); });
+}
+
+// Called when the game starts or when spawned
+void AMaze::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The AI controllers and behavior tree tasks find the maze of the world from there
+	FMazeActorRegistry::Register(this);
+
+	// The audit goes through every object after every teardown, it is only run when asked for
+	AuditTeardown |= FParse::Param(FCommandLine::Get(), TEXT("MazeAuditTeardown"));
+	if (AuditTeardown)
 	{
-		CellBlueprint = CellClassFinder.Object;
+		// Once the collection is over, where the engine runs it, every object of the level should be gone
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &AMaze::OnPostGarbageCollect);
 	}
-	else
+
+	// Subscribe to the end trigger fade out event, so that the maze is destroyed when we reach this trigger
+	SubscribeDestroyMaze();
+
+	// The blueprints of every level stream while the first transition starts
+	StreamBlueprints(false, false);
+
+	if (GetWorld())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint MazeCell not found"));
+		// Teleport the player once the Monster Kill Fade Out animation is finished
+		GameMode = (AAmazeingGameMode*)GetWorld()->GetAuthGameMode();
+		GameMode->OnMonsterKillFadeOutFinished().AddUFunction(this, FName("ResetCharacterLocation"));
+
+		// The animation and the sounds of the AI characters follow the player a few times per second
+		GetWorldTimerManager().SetTimer(AIBudgetTimerHandle, this, &AMaze::UpdateAIBudget, AIBudgetPeriod, true);
 	}
+}
+
+void AMaze::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeTick);
+	MAZE_TICK_COST_SCOPE();
 
-	static ConstructorHelpers::FObjectFinder<UClass> PassageClassFinder(TEXT("Class'/Game/Blueprints/Maze/BP_MazePassage.BP_MazePassage_C'"));
-	if (PassageClassFinder.Object)
+	// Call the base class
+	Super::Tick(DeltaTime);
+
+	// Spawn the prepared next level in the background, a few cells per frame, so that the transition only has to reveal it
+	if (MaterializeNextLevel && HasNextLevel())
 	{
-		PassageBlueprint = PassageClassFinder.Object;
+		MAZE_TELEMETRY_SCOPE("Maze MaterializeNextLevel");
+		for (int32 i = 0; i < NextLevelCellsPerFrame && !NextLevel.IsFullyMaterialized(); i++)
+		{
+			MaterializeNextCell(NextLevel);
+		}
+		SET_DWORD_STAT(STAT_MazeNextLevelActors, NextLevel.Actors.Num());
 	}
-	else
+
+	// The unbounded maze follows the player
+	if (IsUnboundedLevel)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint MazePassage not found"));
+		UpdateRegions();
 	}
 
-	static ConstructorHelpers::FObjectFinder<UClass> WallClassFinder(TEXT("Class'/Game/Blueprints/Maze/BP_MazeWall.BP_MazeWall_C'"));
-	if (WallClassFinder.Object)
+	// The floors around the player are prepared in the background
+	if (IsFloorLevel)
 	{
-		WallBlueprint = WallClassFinder.Object;
+		UpdateFloors();
 	}
-	else
+
+	// The deferred work runs while the player cannot see it: the transition text, the fades
+	IdleScheduler.Tick(IdleFrameBudgetMs);
+
+	// Nothing left to do in the background, the maze sleeps until a level, the floors or the idle work wake it up
+	if (!NeedsTick())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint MazeWall not found"));
+		SetActorTickEnabled(false);
 	}
+}
+
+bool AMaze::NeedsTick() const
+{
+	return (MaterializeNextLevel && HasNextLevel() && !NextLevel.IsFullyMaterialized())
+		|| IsUnboundedLevel
+		|| IsFloorLevel
+		|| (IdleScheduler.Num() > 0 && IdleScheduler.IsWindowOpen());
+}
+
+void AMaze::StartTransition()
+{
+	IsEventNeeded = true;
+	IsCountdownFinished = false;
+	IsGenerationFinished = false;
+
+	// Death of the previous level does not come into this one
+	GetWorldTimerManager().ClearTimer(DeathTimerHandle);
 
-	static ConstructorHelpers::FObjectFinder<UClass> LastLevelClassFinder(TEXT("Class'/Game/Blueprints/Maze/BP_LastLevel.BP_LastLevel_C'"));
-	if (LastLevelClassFinder.Object)
+	// The text of the transition is read for at least TransitionDuration
+	if (TransitionDuration > 0)
 	{
-		LastLevelBlueprint = LastLevelClassFinder.Object;
+		GetWorldTimerManager().SetTimer(TransitionTimerHandle, this, &AMaze::OnTransitionCountdownFinished, TransitionDuration, false);
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint LastLevel not found"));
+		GetWorldTimerManager().SetTimerForNextTick(this, &AMaze::OnTransitionCountdownFinished);
 	}
 
-	static ConstructorHelpers::FObjectFinder<UClass> AIMonsterClassFinder(TEXT("Class'/Game/Blueprints/AI/BP_AICharacter.BP_AICharacter_C'"));
-	if (AIMonsterClassFinder.Object)
-	{
-		AIMonsterBlueprint = AIMonsterClassFinder.Object;
-	}
-	else
+	// The deferred work runs while the transition text hides the maze
+	IdleScheduler.SetWindowOpen(EMazeIdleWindow::Transition, true);
+}
+
+void AMaze::OnTransitionCountdownFinished()
+{
+	IsCountdownFinished = true;
+	if (IsGenerationFinished)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint AIMonster not found"));
+		FinishTransition();
 	}
+}
+
+void AMaze::FinishGeneration()
+{
+	IsGenerationFinished = true;
 
-	static ConstructorHelpers::FObjectFinder<UClass> AIDeathClassFinder(TEXT("Class'/Game/Blueprints/AI/BP_AIDeath.BP_AIDeath_C'"));
-	if (AIDeathClassFinder.Object)
+	// The generation took longer than the text: the event is broadcast once the generating call has returned, as it was from the tick
+	if (IsEventNeeded && IsCountdownFinished)
 	{
-		AIDeathBlueprint = AIDeathClassFinder.Object;
+		GetWorldTimerManager().SetTimerForNextTick(this, &AMaze::FinishTransition);
 	}
-	else
+}
+
+void AMaze::FinishTransition()
+{
+	if (!IsEventNeeded)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Error: Blueprint AIDeath not found"));
+		return;
 	}
 
+	// Reinitialize the parameters
 	IsEventNeeded = false;
 	IsCountdownFinished = false;
 	IsGenerationFinished = false;
-	Countdown = 0.0f;
-}
+	IdleScheduler.SetWindowOpen(EMazeIdleWindow::Transition, false);
 
-// Called when the game starts or when spawned
-void AMaze::BeginPlay()
-{
-	Super::BeginPlay();
+	// Broadcast event
+	TransitionFinishedEvent.Broadcast();
 
-	// Subscribe to the end trigger fade out event, so that the maze is destroyed when we reach this trigger
-	SubscribeDestroyMaze();
+	// Launch the countdown at this point: event for sound + here
+	if (IsDeathActivated)
+	{
+		// Broadcast the event notifying that this maze has Death
+		DeathPresentEvent.Broadcast(DeathArrivalTime);
+		GetWorldTimerManager().SetTimer(DeathTimerHandle, this, &AMaze::SpawnDeath, FMath::Max(DeathArrivalTime, 1), false);
+	}
+}
 
+void AMaze::SpawnDeath()
+{
 	if (GetWorld())
 	{
-		// Teleport the player once the Monster Kill Fade Out animation is finished
-		GameMode = (AAmazeingGameMode*)GetWorld()->GetAuthGameMode();
-		GameMode->OnMonsterKillFadeOutFinished().AddUFunction(this, FName("ResetCharacterLocation"));
+		FActorSpawnParameters Params;
+		AAICharacter* AIMonster = GetWorld()->SpawnActor<AAICharacter>(GetBlueprintClass(AIDeathBlueprint), StartLocation + FVector(0.0f, 0.0f, 200.0f), FRotator(0.0f), Params);
+		AIMonster->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
 	}
+
+	// Broadcast that Death has arrived
+	DeathArrivalEvent.Broadcast();
+	IsDeathActivated = false;
 }
 
-void AMaze::Tick(float DeltaTime)
+// Generates a Maze, returns two random locations for the start and finish
+void AMaze::Generate(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimer)
 {
-	// Call the base class
-	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_MazeGenerate);
+	MAZE_TELEMETRY_SCOPE("Maze Generate");
 
-	// Global logic: if we launch a transition, we need to know when to launch the "fadein" of the next scene --> This class will broadcast an event
-	// This ensures that the event is broadcasted 1) Once the generation of the maze is finished & 2) After a given duration, to enable actually reading the transition text
-	if (IsEventNeeded)
-	{
-		if (!IsCountdownFinished)
-		{
-			Countdown += DeltaTime;
+	// The level is planned, then spawned and activated right away
+	double StartTime = FPlatformTime::Seconds();
+	FMazeLevelBuffer Level;
+	Level.Layout.Plan(SizeX, SizeY, NumberOfMonsters, MonsterPathLength, DeathTimer, SeedStream.GetUnsignedInt(), PlaceStartEndFarthest);
+	double PlanningTime = FPlatformTime::Seconds() - StartTime;
+	ActivateLevel(Level);
 
-			if (Countdown >= TransitionDuration)
-			{
-				IsCountdownFinished = true;
-			}
-		}
-		else
-		{
-			if (IsGenerationFinished)
-			{
-				// Broadcast event
-				TransitionFinishedEvent.Broadcast();
+	UE_LOG(LogTemp, Warning, TEXT("Maze generated in %.2f ms (planning %.3f ms)"), (FPlatformTime::Seconds() - StartTime) * 1000.0, PlanningTime * 1000.0);
+}
 
-				// Launch the countdown at this point: event for sound + here
-				if (IsDeathActivated)
-				{
-					// Broadcast the event notifying that this maze has Death
-					DeathPresentEvent.Broadcast(DeathArrivalTime);
-					DeathCountdown = 0.0f;
-				}
+void AMaze::Generate(const FMazeLayout& PlannedLayout)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeGenerate);
+	MAZE_TELEMETRY_SCOPE("Maze Generate");
 
-				// Reinitialize the parameters
-				IsEventNeeded = false;
-				IsCountdownFinished = false;
-				IsGenerationFinished = false;
-				Countdown = 0.0f;
-			}
-		}
+	FMazeLevelBuffer Level;
+	Level.Layout = PlannedLayout;
+	ActivateLevel(Level);
+}
+
+void AMaze::RetryLevel()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeRetryLevel);
+	MAZE_TELEMETRY_SCOPE("Maze RetryLevel");
+
+	// The floors are still packed: they are spawned again
+	if (FloorPlan.IsValid())
+	{
+		ActivateFloors();
+		return;
 	}
 
-	// Countdown of the "Death" character
-	if (IsDeathActivated)
+	double StartTime = FPlatformTime::Seconds();
+	FMazeLevelBuffer Level;
+
+	// The snapshot holds the topology, the start, the end and the patrols: neither carving nor path planning is needed
+	if (RetryWithSameLayout && Level.Layout.LoadSnapshot(Snapshot))
 	{
-		DeathCountdown += DeltaTime;
+		double UnpackingTime = FPlatformTime::Seconds() - StartTime;
+		int32 SnapshotSize = Snapshot.Num();
+		ActivateLevel(Level);
 
-		if (DeathCountdown >= DeathArrivalTime)
-		{
-			if (GetWorld())
-			{
-				FActorSpawnParameters Params;
-				AAICharacter* AIMonster = GetWorld()->SpawnActor<AAICharacter>(AIDeathBlueprint, StartLocation + FVector(0.0f, 0.0f, 200.0f), FRotator(0.0f), Params);
-				AIMonster->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
-			}
+		UE_LOG(LogTemp, Warning, TEXT("Maze restored from a %d bytes snapshot in %.2f ms (unpacking %.3f ms)"), SnapshotSize, (FPlatformTime::Seconds() - StartTime) * 1000.0, UnpackingTime * 1000.0);
+	}
+	else
+	{
+		// Same parameters, new layout
+		Generate(Layout.Size.X, Layout.Size.Y, Layout.MonsterNumber, Layout.AIPathLength, Layout.DeathTimer);
+	}
+}
 
-			// Broadcast that Death has arrived
-			DeathArrivalEvent.Broadcast();
+void AMaze::PrepareNextLevel(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimer)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazePrepareNextLevel);
+	MAZE_TELEMETRY_SCOPE("Maze PrepareNextLevel");
 
-			// Reinitialize the parameters
-			IsDeathActivated = false;
-			DeathCountdown = 0.0f;
-		}
+	// Only one level can be prepared at a time
+	DiscardNextLevel();
+
+	// Planning is cheap, the actors are then spawned a few at a time in Tick, hidden until the level is activated
+	NextLevel.Layout.Plan(SizeX, SizeY, NumberOfMonsters, MonsterPathLength, DeathTimer, SeedStream.GetUnsignedInt(), PlaceStartEndFarthest);
+	NextLevel.IsHidden = MaterializeNextLevel;
+
+	// The maze ticks to spawn it
+	if (MaterializeNextLevel)
+	{
+		SetActorTickEnabled(true);
 	}
 }
 
-// Generates a Maze, returns two random locations for the start and finish
-void AMaze::Generate(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimer)
+void AMaze::PrepareNextLevel(const FMazeLayout& PlannedLayout)
 {
-	// For the "fadein" event broadcast
-	IsEventNeeded = true;
+	SCOPE_CYCLE_COUNTER(STAT_MazePrepareNextLevel);
+	MAZE_TELEMETRY_SCOPE("Maze PrepareNextLevel");
+
+	DiscardNextLevel();
 
-	// We update all the class values with the new ones
-	Size.X = SizeX;
-	Size.Y = SizeY;
-	MonsterNumber = NumberOfMonsters;
-	AIPathLength = MonsterPathLength;
+	NextLevel.Layout = PlannedLayout;
+	NextLevel.IsHidden = MaterializeNextLevel;
+
+	if (MaterializeNextLevel)
+	{
+		SetActorTickEnabled(true);
+	}
+}
 
-	// First, we initialize the size of the Cells array
-	Cells.AddZeroed(Size.X);
-	for (int i = 0; i < Size.X; i++)
+void AMaze::ActivateNextLevel()
+{
+	if (HasNextLevel())
 	{
-		Cells[i].AddZeroed(Size.Y);
+		ActivateLevel(NextLevel);
 	}
-	// We give every element the "nullptr" value
-	for (int i = 0; i < Size.X; i++)
+	else
 	{
-		for (int j = 0; j < Size.Y; j++)
-		{
-			Cells[i].Array2ndDimension[j] = nullptr;
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Error: no next level prepared in AMaze::ActivateNextLevel"));
+	}
+}
+
+void AMaze::CompleteNextLevel()
+{
+	while (HasNextLevel() && !NextLevel.IsFullyMaterialized())
+	{
+		MaterializeNextCell(NextLevel);
 	}
+	SET_DWORD_STAT(STAT_MazeNextLevelActors, NextLevel.Actors.Num());
+}
+
+void AMaze::DiscardNextLevel()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeDiscardNextLevel);
+	MAZE_TELEMETRY_SCOPE("Maze DiscardNextLevel");
+
+	DestroyLevelActors(NextLevel);
+	NextLevel = FMazeLevelBuffer();
+	SET_DWORD_STAT(STAT_MazeNextLevelActors, 0);
+}
 
-	// Then, we do the same for the IsCellUsed array
-	IsCellUsed.AddZeroed(Size.X);
-	for (int i = 0; i < Size.X; i++)
+void AMaze::ActivateLevel(FMazeLevelBuffer& Level)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeActivateLevel);
+	MAZE_TELEMETRY_SCOPE("Maze ActivateLevel");
+
+	// For the "fadein" event broadcast
+	StartTransition();
+
+	// First, we spawn what has not been spawned in the background yet
+	while (!Level.IsFullyMaterialized())
 	{
-		IsCellUsed[i].AddZeroed(Size.Y);
+		MaterializeNextCell(Level);
 	}
-	// We give every element the "false" value
-	for (int i = 0; i < Size.X; i++)
+
+	// Then, we reveal the level: every actor becomes visible and collides again, and the cells are attached to the maze
+	if (Level.IsHidden)
 	{
-		for (int j = 0; j < Size.Y; j++)
+		for (AActor* Actor : Level.Actors)
 		{
-			IsCellUsed[i].Array2ndDimension[j] = false;
+			SetLevelActorHidden(Actor, false);
 		}
 	}
-
-	// Then, we create the maze
-	DoFirstGenerationStep(ActiveCells);
-
-	while (ActiveCells.Num() > 0)
+	for (FMazeCell2DArray& Column : Level.Cells)
 	{
-		DoNextGenerationStep(ActiveCells);
+		for (AMazeCell* Cell : Column.Array2ndDimension)
+		{
+			if (Cell)
+			{
+				Cell->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
+			}
+		}
 	}
 
-	// Then, we define the random coordinates for the initial placement of the FPC & Goal - And remove them from possible placements for the AI
+	// The level becomes the current one, and we update all the class values with the new ones
+	FloorPlan = FMazeFloorPlan();
+	LayoutOffset = FVector::ZeroVector;
+	Layout = Level.Layout;
+	Cells = MoveTemp(Level.Cells);
+	Level = FMazeLevelBuffer();
+	SET_DWORD_STAT(STAT_MazeNextLevelActors, NextLevel.Actors.Num());
+	Size = Layout.Size;
+	MonsterNumber = Layout.MonsterNumber;
+	AIPathLength = Layout.AIPathLength;
+
+	// Keep a snapshot of the level as it starts, in case it has to be retried
+	Layout.SaveSnapshot(Snapshot);
+	UE_LOG(LogTemp, Warning, TEXT("Maze snapshot is %d bytes for %d cells"), Snapshot.Num(), Layout.Num());
+
+	// Then, we place the FPC & Goal at the coordinates planned with the layout
 	// Starting point, which goes to the player
-	int32 TempY = FMath::RandRange(0, Size.Y - 1);
-	StartLocation = Cells[0].Array2ndDimension[TempY]->GetActorLocation();
-	IsCellUsed[0].Array2ndDimension[TempY] = true;
+	StartLocation = Cells[0][Layout.StartY]->GetActorLocation();
 	UE_LOG(LogTemp, Warning, TEXT("Start is %s"), *StartLocation.ToString());
 	FirstPersonCharacter->InitializeLocation(StartLocation);
 
 	// Finish point, which goes to the end trigger
-	TempY = FMath::RandRange(0, Size.Y - 1);
-	FVector EndLocation = Cells[Size.X - 1].Array2ndDimension[TempY]->GetActorLocation();
-	IsCellUsed[Size.X - 1].Array2ndDimension[TempY] = true;
+	FVector EndLocation = Cells[Size.X - 1][Layout.EndY]->GetActorLocation();
 	UE_LOG(LogTemp, Warning, TEXT("End is %s"), *EndLocation.ToString());
 	EndTriggerVolume->SetActorLocation(EndLocation + FVector(0.0f, 0.0f, 100));
 
-	// Finally, we spawn the appropriate number of monsters
+	// Finally, we spawn the appropriate number of monsters, each one takes the next patrol of the layout in CreateAIPath
+	NextPatrolIndex = 0;
 	UWorld* const World = GetWorld();
 	for (int i = 0; i < MonsterNumber; i++)
 	{
@@ -242,41 +454,128 @@ void AMaze::Generate(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 Mon
 		{
 			FActorSpawnParameters Params;
 			Params.Name = FName(*FString("Monster number " + FString::FromInt(i)));
-			AAICharacter* AIMonster = World->SpawnActor<AAICharacter>(AIMonsterBlueprint, EndLocation + FVector(0.0f, 0.0f, 0.0f), FRotator(0.0f), Params);
+			AAICharacter* AIMonster = World->SpawnActor<AAICharacter>(GetBlueprintClass(AIMonsterBlueprint), EndLocation + FVector(0.0f, 0.0f, 0.0f), FRotator(0.0f), Params);
 			AIMonster->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
 		}
 	}
 
 	// Signals that the maze generation is finished
-	IsGenerationFinished = true;
+	FinishGeneration();
 
 	// Enable the death timer if needed, and set it. If DeathTimer has the default value, do not enable "Death"
-	if (DeathTimer == 0)
+	if (Layout.DeathTimer == 0)
 	{
 		IsDeathActivated = false;
 	}
 	else
 	{
 		IsDeathActivated = true;
-		DeathArrivalTime = DeathTimer;
+		DeathArrivalTime = Layout.DeathTimer;
+
+		// Usually already streamed during the previous level, otherwise Death arrives late enough for it to stream now
+		StreamBlueprints(false, true);
+	}
+}
+
+void AMaze::MaterializeNextCell(FMazeLevelBuffer& Level)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeMaterializeNextCell);
+
+	const FMazeLayout& LevelLayout = Level.Layout;
+
+	// Before the first cell, we initialize the size of the Cells array, with every element at the "nullptr" value
+	if (Level.MaterializedCellCount == 0)
+	{
+		Level.Cells.Reset();
+		Level.Cells.AddZeroed(LevelLayout.Size.X);
+		for (int i = 0; i < LevelLayout.Size.X; i++)
+		{
+			Level.Cells[i].Init(nullptr, LevelLayout.Size.Y);
+		}
+	}
+
+	FIntVector Coordinates = LevelLayout.ToCoordinates(Level.MaterializedCellCount);
+	Level.MaterializedCellCount += 1;
+
+	AMazeCell* Cell = CreateCell(Level, Coordinates);
+	if (Cell == nullptr)
+	{
+		return;
+	}
+
+	// Then, the edges: the outer walls, and the edges shared with the cells already spawned (each edge is spawned only once)
+	for (uint8 i = 0; i < UMazeDirections::Count; i++)
+	{
+		EMazeDirection Direction = (EMazeDirection)i;
+		FIntVector OtherCoordinates = Coordinates + UMazeDirections::ToIntVector(Direction);
+		AMazeCellEdge* Edge = nullptr;
+
+		if (!LevelLayout.ContainsCoordinates(OtherCoordinates))
+		{
+			if (!Level.IsRegion)
+			{
+				Edge = CreateWall(Cell, nullptr, Direction);
+			}
+			// The borders of a region toward +X and +Y are spawned by the neighbor regions, the other ones here, open where the regions are stitched
+			else if (Direction == EMazeDirection::East || Direction == EMazeDirection::South)
+			{
+				if (LevelLayout.HasBorderOpening(Coordinates, Direction))
+				{
+					Edge = CreatePassage(Cell, nullptr, Direction);
+				}
+				else
+				{
+					Edge = CreateWall(Cell, nullptr, Direction);
+				}
+			}
+		}
+		else if (LevelLayout.ToIndex(OtherCoordinates) < LevelLayout.ToIndex(Coordinates))
+		{
+			AMazeCell* OtherCell = Level.Cells[OtherCoordinates.X][OtherCoordinates.Y];
+			if (LevelLayout.HasPassage(Coordinates, Direction))
+			{
+				Edge = CreatePassage(Cell, OtherCell, Direction);
+			}
+			else
+			{
+				Edge = CreateWall(Cell, OtherCell, Direction);
+			}
+		}
+
+		if (Edge)
+		{
+			Level.Actors.Add(Edge);
+			if (Level.IsHidden)
+			{
+				SetLevelActorHidden(Edge, true);
+			}
+		}
 	}
 }
 
 // Creates a Cell with a Plane at location (X,Y)
-AMazeCell* AMaze::CreateCell(FIntVector Coordinates)
+AMazeCell* AMaze::CreateCell(FMazeLevelBuffer& Level, FIntVector Coordinates)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeCreateCell);
+
 	// First, spawn an instance of the cell blueprint
 	UWorld* const World = GetWorld();
 	if (World)
 	{
+		// Two levels can exist at the same time, so the name is made unique
 		FActorSpawnParameters Params;
-		Params.Name = FName(*FString("Cell x=" + FString::FromInt(Coordinates.X) + " y=" + FString::FromInt(Coordinates.Y)));
-		AMazeCell* NewCell = World->SpawnActor<AMazeCell>(CellBlueprint, Params);
-		NewCell->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
-		NewCell->SetActorRelativeLocation(FVector(500 * (Coordinates.X - Size.X * 0.5f + 0.5f), 500 * (Coordinates.Y - Size.Y * 0.5f + 0.5f), 0.0f));
-		// Then, we keep track of the cell created in the Cells 2D array
+		UClass* CellClass = GetBlueprintClass(CellBlueprint);
+		Params.Name = MakeUniqueObjectName(GetLevel(), CellClass, FName(*FString("Cell x=" + FString::FromInt(Coordinates.X) + " y=" + FString::FromInt(Coordinates.Y))));
+		FVector Location = GetActorTransform().TransformPosition(Level.Layout.GetCellRelativeLocation(Coordinates) + Level.LevelOffset);
+		AMazeCell* NewCell = World->SpawnActor<AMazeCell>(CellClass, Location, GetActorRotation(), Params);
+		// Then, we keep track of the cell created in the Cells 2D array of the level
 		NewCell->SetCoordinates(Coordinates);
-		Cells[Coordinates.X].Array2ndDimension[Coordinates.Y] = NewCell;
+		Level.Cells[Coordinates.X].Array2ndDimension[Coordinates.Y] = NewCell;
+		Level.Actors.Add(NewCell);
+		if (Level.IsHidden)
+		{
+			SetLevelActorHidden(NewCell, true);
+		}
 		return NewCell;
 	}
 	else
@@ -286,171 +585,161 @@ AMazeCell* AMaze::CreateCell(FIntVector Coordinates)
 	}
 }
 
-FIntVector AMaze::RandomCoordinates()
+void AMaze::StreamBlueprints(bool IsLastLevel, bool HasDeath)
 {
-	return FIntVector(FMath::RandRange(0, Size.X - 1), FMath::RandRange(0, Size.Y - 1), 0);
-}
+	FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
 
-bool AMaze::ContainsCoordinates(FIntVector Coordinate)
-{
-	return Coordinate.X >= 0 && Coordinate.X < Size.X && Coordinate.Y >= 0 && Coordinate.Y < Size.Y;
-}
+	if (!LevelBlueprintsHandle.IsValid())
+	{
+		TArray<FSoftObjectPath> LevelBlueprints;
+		LevelBlueprints.Add(CellBlueprint.ToSoftObjectPath());
+		LevelBlueprints.Add(PassageBlueprint.ToSoftObjectPath());
+		LevelBlueprints.Add(WallBlueprint.ToSoftObjectPath());
+		LevelBlueprints.Add(AIMonsterBlueprint.ToSoftObjectPath());
+		LevelBlueprints.RemoveAll([](const FSoftObjectPath& Blueprint) { return Blueprint.IsNull(); });
+		LevelBlueprintsHandle = StreamableManager.RequestAsyncLoad(LevelBlueprints);
+	}
 
-AMazeCell* AMaze::GetCell(FIntVector Coordinates)
-{
-	return Cells[Coordinates.X][Coordinates.Y];
-}
+	if (HasDeath && !DeathBlueprintHandle.IsValid() && !AIDeathBlueprint.IsNull())
+	{
+		DeathBlueprintHandle = StreamableManager.RequestAsyncLoad(AIDeathBlueprint.ToSoftObjectPath());
+	}
 
-void AMaze::DoFirstGenerationStep(TArray<AMazeCell*>& ActiveCells)
-{
-	ActiveCells.Add(CreateCell(RandomCoordinates()));
+	if (IsLastLevel && !LastLevelBlueprintHandle.IsValid() && !LastLevelBlueprint.IsNull())
+	{
+		LastLevelBlueprintHandle = StreamableManager.RequestAsyncLoad(LastLevelBlueprint.ToSoftObjectPath());
+	}
 }
 
-void AMaze::DoNextGenerationStep(TArray<AMazeCell*>& ActiveCells)
+void AMaze::SetLevelActorHidden(AActor* Actor, bool IsHidden)
 {
-	int32 CurrentIndex = ActiveCells.Num() - 1;
-	CurrentCell = ActiveCells[CurrentIndex];
-
-	if (CurrentCell->IsFullyInitialized())
+	if (Actor)
 	{
-		ActiveCells.RemoveAt(CurrentIndex);
-		return;
+		Actor->SetActorHiddenInGame(IsHidden);
+		Actor->SetActorEnableCollision(!IsHidden);
 	}
+}
 
-	EMazeDirection Direction = CurrentCell->RandomUninitializedDirection();
-	FIntVector Coordinates = CurrentCell->GetCoordinates() + UMazeDirections::ToIntVector(Direction);
+bool AMaze::ContainsCoordinates(FIntVector Coordinate)
+{
+	return Layout.ContainsCoordinates(Coordinate);
+}
 
-	if (ContainsCoordinates(Coordinates))
-	{
-		Neighbor = GetCell(Coordinates);
-		if (Neighbor == nullptr)
-		{
-			Neighbor = CreateCell(Coordinates);
-			CreatePassage(CurrentCell, Neighbor, Direction);
-			ActiveCells.Add(Neighbor);
-		}
-		else
-		{
-			CreateWall(CurrentCell, Neighbor, Direction);
-		}
-	}
-	else
-	{
-		CreateWall(CurrentCell, nullptr, Direction);
-	}
+AMazeCell* AMaze::GetCell(FIntVector Coordinates)
+{
+	return Cells[Coordinates.X][Coordinates.Y];
 }
 
-void AMaze::CreatePassage(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction)
+AMazeCellEdge* AMaze::CreatePassage(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeCreatePassage);
+
 	UWorld * const World = GetWorld();
 	if (World)
 	{
-		AMazePassage* Passage = World->SpawnActor<AMazePassage>(PassageBlueprint);
+		AMazePassage* Passage = World->SpawnActor<AMazePassage>(GetBlueprintClass(PassageBlueprint));
 		Passage->Initialize(Cell, OtherCell, Direction, ECellEdgeType::Passage);
-		Passage->Initialize(OtherCell, Cell, UMazeDirections::GetOppositeDirection(Direction), ECellEdgeType::Passage);
+		if (OtherCell != nullptr)
+		{
+			Passage->Initialize(OtherCell, Cell, UMazeDirections::GetOppositeDirection(Direction), ECellEdgeType::Passage);
+		}
+		INC_DWORD_STAT(STAT_MazePassages);
+		return Passage;
 	}
+	return nullptr;
 }
 
-void AMaze::CreateWall(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction)
+AMazeCellEdge* AMaze::CreateWall(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_MazeCreateWall);
+
 	UWorld * const World = GetWorld();
 	if (World)
 	{
-		AMazeWall* Wall = World->SpawnActor<AMazeWall>(WallBlueprint);
+		AMazeWall* Wall = World->SpawnActor<AMazeWall>(GetBlueprintClass(WallBlueprint));
 		Wall->Initialize(Cell, OtherCell, Direction, ECellEdgeType::Wall);
 		if (OtherCell != nullptr)
 		{
 			Wall->Initialize(OtherCell, Cell, UMazeDirections::GetOppositeDirection(Direction), ECellEdgeType::Wall);
 		}
+		INC_DWORD_STAT(STAT_MazeWalls);
+		return Wall;
 	}
+	return nullptr;
 }
 
 TArray<FVector> AMaze::CreateAIPath()
 {
-	TArray<FVector> AIPath;
-	// First, we select a random cell that is not used : this will be the "home" location of the AI
-	int RandomX;
-	int RandomY;
-	do
-	{
-		RandomX = FMath::RandRange(0, Size.X - 1);
-		RandomY = FMath::RandRange(0, Size.Y - 1);
-	} while (IsCellUsed[RandomX][RandomY] == true);
-	IsCellUsed[RandomX].Array2ndDimension[RandomY] = true; // The cell is now used
+	SCOPE_CYCLE_COUNTER(STAT_MazeCreateAIPath);
 
-														   // We store the "home" location in the first element of the array
-	AIPath.Add(Cells[RandomX][RandomY]->GetActorLocation());
-
-	// Then, we determine a path of AIPathLength length
-	TArray<AMazeCell*> CellsInAIPath;
-	CellsInAIPath.Add(Cells[RandomX][RandomY]);
+	TArray<FVector> AIPath;
 
-	while (CellsInAIPath.Num() < AIPathLength)
+	// The patrols are planned with the layout, each monster takes the next one
+	// The locations are the ones of the cells, on the floor of the player for a multi-floor level
+	if (Layout.Patrols.Num() == 0)
 	{
-		// Get a random available cell, use it if any is available, otherwise keep the path as it is
-		AMazeCell* NextCell = RandomUsableNeighborCell(CellsInAIPath.Last(0));
-		if (NextCell != nullptr)
-		{
-			CellsInAIPath.Add(NextCell);
-		}
-		else
-		{
-			break;
-		}
+		UE_LOG(LogTemp, Warning, TEXT("Error: no AI Monster patrol planned for this maze"));
+		FVector EndLocation = GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(FIntVector(Size.X - 1, Layout.EndY, 0)) + LayoutOffset);
+		AIPath.Add(EndLocation);
+		AIPath.Add(EndLocation);
+		return AIPath;
 	}
+	const FMazePatrol& Patrol = Layout.Patrols[NextPatrolIndex % Layout.Patrols.Num()];
+	NextPatrolIndex += 1;
 
-	UE_LOG(LogTemp, Warning, TEXT("Number of cells of path=%d"), CellsInAIPath.Num());
-	// We store the last "target" location in the second element of the array
-	AIPath.Add(CellsInAIPath.Last(0)->GetActorLocation());
+	UE_LOG(LogTemp, Warning, TEXT("Number of cells of path=%d"), Patrol.Length);
+	// We store the "home" location in the first element of the array, and the last "target" location in the second element
+	AIPath.Add(GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(Patrol.Home) + LayoutOffset));
+	AIPath.Add(GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(Patrol.Target) + LayoutOffset));
 
 	return AIPath;
 }
 
-AMazeCell* AMaze::RandomUsableNeighborCell(AMazeCell* Cell)
+void AMaze::DestroyMaze(bool IsDeathKill)
 {
-	TArray<AMazeCellEdge*> ValidPassageEdges;
-	FIntVector SelectedCoordinates;
-	// We get the passage edges of the cell
-	TArray<AMazeCellEdge*> PassageEdges = Cell->GetPassageEdges();
+	SCOPE_CYCLE_COUNTER(STAT_MazeDestroyMaze);
+	MAZE_TELEMETRY_SCOPE("Maze DestroyMaze");
 
-	// Then, we keep only the valid ones (not used yet)
-	for (uint8 i = 0; i < PassageEdges.Num(); i++)
+	// The regions of an unbounded maze are not attached to the maze
+	for (TPair<FIntVector, FMazeLevelBuffer>& Region : Regions)
 	{
-		SelectedCoordinates = Cell->GetCoordinates() + UMazeDirections::ToIntVector(PassageEdges[i]->GetDirection());
-		// Clamp so that we are never out of the domain
-		SelectedCoordinates.X = FMath::Clamp<int>(SelectedCoordinates.X, 0, Size.X - 1);
-		SelectedCoordinates.Y = FMath::Clamp<int>(SelectedCoordinates.Y, 0, Size.Y - 1);
-		if (!IsCellUsed[SelectedCoordinates.X][SelectedCoordinates.Y])
-		{
-			ValidPassageEdges.Add(PassageEdges[i]);
-		}
+		DestroyLevelActors(Region.Value);
 	}
-
-	if (ValidPassageEdges.Num() == 0)
+	Regions.Reset();
+	NoiseListeners.Reset();
+	SET_DWORD_STAT(STAT_MazeRegions, 0);
+	IsUnboundedLevel = false;
+	IsOnLastLevel = false;
+
+	// Nor are the floors, which stay packed in case the level is retried
+	for (TPair<int32, FMazeLevelBuffer>& Floor : Floors)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("AI Monster path not completely defined"));
-		return nullptr;
+		DestroyLevelActors(Floor.Value);
 	}
-	else
+	Floors.Reset();
+	for (AActor* Actor : CurrentFloorActors)
 	{
-		// Then, we return a randomly selected one
-		int RandomIndex = FMath::RandRange(0, ValidPassageEdges.Num() - 1);
-		SelectedCoordinates = Cell->GetCoordinates() + UMazeDirections::ToIntVector(ValidPassageEdges[RandomIndex]->GetDirection());
-		IsCellUsed[SelectedCoordinates.X].Array2ndDimension[SelectedCoordinates.Y] = true;
-		return Cells[SelectedCoordinates.X][SelectedCoordinates.Y];
+		if (APawn* Pawn = Cast<APawn>(Actor))
+		{
+			DestroyAIController(Pawn);
+		}
+		Actor->Destroy();
 	}
+	CurrentFloorActors.Reset();
+	IsFloorLevel = false;
 
-	// TO DO: Ajouter test pour viter culs de sacs ? Et si tout mne  cul de sac, arrter ?
-}
-
-void AMaze::DestroyMaze(bool IsDeathKill)
-{
 	TArray<AActor*> AttachedActors;
 	GetAttachedActors(AttachedActors);
 
 	TArray<AActor*> ChildAttachedActors;
 	for (AActor* Actor : AttachedActors)
 	{
+		// The AI controllers are not attached to their character: they are unpossessed and destroyed explicitly
+		if (APawn* Pawn = Cast<APawn>(Actor))
+		{
+			DestroyAIController(Pawn);
+		}
+
 		// For the AI Characters, the controller should be destroyed at the same time
 		Actor->GetAttachedActors(ChildAttachedActors);
 
@@ -463,7 +752,114 @@ void AMaze::DestroyMaze(bool IsDeathKill)
 		Actor->Destroy();
 	}
 
-	// TO DO: Forcer le passage du GC ici ?
+	// The cells are gone with the rest of the level
+	Cells.Reset();
+
+	// Once collected, nothing of the level should have survived
+	IsTeardownAuditPending = AuditTeardown;
+
+	// The level is collected during the transition, where the pause is hidden, instead of during the next level
+	// The task only asks for the collection: the engine runs it at the end of the world tick, where it is safe, so it costs next to nothing in the idle budget
+	IdleScheduler.Submit(TEXT("Garbage collection"), EMazeIdlePriority::High, 0.1f, []()
+	{
+		GEngine->ForceGarbageCollection(true);
+	});
+}
+
+void AMaze::OnPostGarbageCollect()
+{
+	if (IsTeardownAuditPending)
+	{
+		IsTeardownAuditPending = false;
+		ReportSurvivingObjects();
+	}
+}
+
+void AMaze::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMaze::DestroyAIController(APawn* Pawn)
+{
+	AController* Controller = Pawn->GetController();
+	if (Controller && Controller->IsA<AAIController>())
+	{
+		Controller->UnPossess();
+		Controller->Destroy();
+	}
+}
+
+void AMaze::ReportSurvivingObjects() const
+{
+	// The levels alive when the audit runs, the prepared one and the floors, are expected to be there, as the actors attached to the maze
+	TSet<AActor*> LiveActors(NextLevel.Actors);
+	LiveActors.Append(CurrentFloorActors);
+	for (const TPair<int32, FMazeLevelBuffer>& Floor : Floors)
+	{
+		LiveActors.Append(Floor.Value.Actors);
+	}
+	auto IsLive = [this, &LiveActors](AActor* Actor)
+	{
+		for (AActor* Parent = Actor; Parent; Parent = Parent->GetAttachParentActor())
+		{
+			if (Parent == this || LiveActors.Contains(Parent))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Every maze actor, or component of a maze actor, left once the garbage has been collected, out of the live levels
+	TMap<FName, int32> SurvivorsByClass;
+	int32 SurvivorCount = 0;
+	int32 LiveCount = 0;
+	for (TObjectIterator<UObject> It; It; ++It)
+	{
+		UObject* Object = *It;
+		if (Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || !(Object->IsA<AActor>() || Object->IsA<UActorComponent>()))
+		{
+			continue;
+		}
+
+		AActor* OwnerActor = Object->IsA<AActor>() ? (AActor*)Object : Object->GetTypedOuter<AActor>();
+		if (OwnerActor == nullptr || OwnerActor->GetWorld() != GetWorld())
+		{
+			continue;
+		}
+
+		if (OwnerActor->IsA<AMazeCell>() || OwnerActor->IsA<AMazeCellEdge>() || OwnerActor->IsA<AMazeStairs>() || OwnerActor->IsA<AAICharacter>() || OwnerActor->IsA<AAIController>())
+		{
+			// The AI controllers belong to the level of their character
+			AAIController* Controller = Cast<AAIController>(OwnerActor);
+			if (!OwnerActor->IsPendingKill() && IsLive(Controller ? Controller->GetPawn() : OwnerActor))
+			{
+				LiveCount += 1;
+				continue;
+			}
+			SurvivorsByClass.FindOrAdd(Object->GetClass()->GetFName()) += 1;
+			SurvivorCount += 1;
+		}
+	}
+
+	// The bindings of the dead AI Monsters should be gone with them
+	FMazeEventBindings::LogAll(GetWorld());
+
+	if (SurvivorCount == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Maze teardown audit: no maze object survived, %d in the live levels"), LiveCount);
+		return;
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("Maze teardown audit: %d maze objects survived the teardown, %d in the live levels"), SurvivorCount, LiveCount);
+	for (const TPair<FName, int32>& Survivors : SurvivorsByClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("    %s: %d"), *Survivors.Key.ToString(), Survivors.Value);
+	}
 }
 
 void AMaze::RespawnCharacter()
@@ -475,6 +871,12 @@ void AMaze::RespawnCharacter()
 
 void AMaze::ResetCharacterLocation()
 {
+	// The start is on the first floor
+	if (IsFloorLevel && CurrentFloor != 0)
+	{
+		SetCurrentFloor(0);
+	}
+
 	FirstPersonCharacter->SetActorLocation(StartLocation + FVector(0.0f, 0.0f, 100.0f));
 	LocationResetEvent.Broadcast();
 }
@@ -482,7 +884,8 @@ void AMaze::ResetCharacterLocation()
 void AMaze::GenerateLastLevel()
 {
 	// For the "fadein" event broadcast
-	IsEventNeeded = true;
+	StartTransition();
+	IsOnLastLevel = true;
 
 	// First, spawn an instance of the last level blueprint
 	UWorld* const World = GetWorld();
@@ -490,13 +893,13 @@ void AMaze::GenerateLastLevel()
 	if (World)
 	{
 		FActorSpawnParameters Params;
-		LastLevel = World->SpawnActor<AMazeCell>(LastLevelBlueprint, Params);
+		LastLevel = World->SpawnActor<AMazeCell>(GetBlueprintClass(LastLevelBlueprint), Params);
 		LastLevel->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
 		LastLevel->SetActorRelativeLocation(FVector(0.0f, 0.0f, 0.0f));
 	}
 
 	// Signals that the level generation is finished
-	IsGenerationFinished = true;
+	FinishGeneration();
 
 	// Then, we define the initial coordinates for the initial placement of the FPC & Goal
 	FirstPersonCharacter->InitializeLocation(FVector(0.0f, 0.0f, 0.0f));
@@ -520,6 +923,488 @@ void AMaze::GenerateLastLevel()
 	IsDeathActivated = false;
 }
 
+void AMaze::GenerateUnbounded(int32 InWorldSeed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeGenerate);
+	MAZE_TELEMETRY_SCOPE("Maze GenerateUnbounded");
+
+	// For the "fadein" event broadcast
+	StartTransition();
+
+	IsUnboundedLevel = true;
+	WorldSeed = InWorldSeed;
+	SetActorTickEnabled(true);
+
+	// The region of the start is spawned right away, the other ones around it over the next frames
+	FMazeLevelBuffer& Origin = Regions.FindOrAdd(FIntVector::ZeroValue);
+	Origin.Layout.PlanRegion(RegionSize, FIntVector::ZeroValue, WorldSeed, RegionBorderOpenings);
+	Origin.IsRegion = true;
+	while (!Origin.IsFullyMaterialized())
+	{
+		MaterializeNextCell(Origin);
+	}
+	SET_DWORD_STAT(STAT_MazeRegions, Regions.Num());
+
+	// The layout of the level is the one of the first region, no monster and no Death
+	FloorPlan = FMazeFloorPlan();
+	LayoutOffset = FVector::ZeroVector;
+	Layout = Origin.Layout;
+	Size = Layout.Size;
+	MonsterNumber = 0;
+	AIPathLength = 0;
+	NextPatrolIndex = 0;
+	IsDeathActivated = false;
+
+	StartLocation = Origin.Cells[0][Layout.StartY]->GetActorLocation();
+	FirstPersonCharacter->InitializeLocation(StartLocation);
+
+	// The exit is in a region a few regions away, chosen by the seed: every region is connected to its neighbors, so it can always be reached
+	FRandomStream Stream(WorldSeed);
+	FIntVector ExitRegion(Stream.RandBool() ? ExitRegionDistance : -ExitRegionDistance, Stream.RandRange(-ExitRegionDistance, ExitRegionDistance), 0);
+	FIntVector ExitCell(Stream.RandRange(0, RegionSize - 1), Stream.RandRange(0, RegionSize - 1), 0);
+	FVector RegionExtent(RegionSize * FMazeLayout::CellSpacing, RegionSize * FMazeLayout::CellSpacing, 0.0f);
+	FVector EndLocation = GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(ExitCell) + FVector(ExitRegion) * RegionExtent);
+	EndTriggerVolume->SetActorLocation(EndLocation + FVector(0.0f, 0.0f, 100));
+
+	UE_LOG(LogTemp, Warning, TEXT("Unbounded maze with seed %d, exit in region (%d, %d)"), WorldSeed, ExitRegion.X, ExitRegion.Y);
+
+	// Signals that the maze generation is finished
+	FinishGeneration();
+}
+
+FIntVector AMaze::GetRegionAt(FVector Location) const
+{
+	// The region (0, 0) is centered on the maze actor, as a level is
+	FVector RelativeLocation = GetActorTransform().InverseTransformPosition(Location);
+	float RegionExtent = RegionSize * FMazeLayout::CellSpacing;
+	return FIntVector(FMath::FloorToInt(RelativeLocation.X / RegionExtent + 0.5f), FMath::FloorToInt(RelativeLocation.Y / RegionExtent + 0.5f), 0);
+}
+
+const FMazeLayout* AMaze::GetLayoutAt(FVector Location, FTransform& OutLayoutTransform) const
+{
+	if (IsOnLastLevel)
+	{
+		return nullptr;
+	}
+
+	// Every region of an unbounded maze has its own layout, placed by its offset
+	if (IsUnboundedLevel)
+	{
+		const FMazeLevelBuffer* Region = Regions.Find(GetRegionAt(Location));
+		if (Region == nullptr)
+		{
+			return nullptr;
+		}
+		OutLayoutTransform = FTransform(Region->LevelOffset) * GetActorTransform();
+		return &Region->Layout;
+	}
+
+	OutLayoutTransform = GetLayoutTransform();
+	return Layout.IsValid() ? &Layout : nullptr;
+}
+
+void AMaze::UpdateRegions()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeUpdateRegions);
+	MAZE_TELEMETRY_SCOPE("Maze UpdateRegions");
+
+	FIntVector PlayerRegion = GetRegionAt(FirstPersonCharacter->GetActorLocation());
+	float RegionExtent = RegionSize * FMazeLayout::CellSpacing;
+
+	// Plan the regions of the neighborhood which are missing, planning is cheap
+	for (int32 X = -RegionRadius; X <= RegionRadius; X++)
+	{
+		for (int32 Y = -RegionRadius; Y <= RegionRadius; Y++)
+		{
+			FIntVector Region = PlayerRegion + FIntVector(X, Y, 0);
+			if (!Regions.Contains(Region))
+			{
+				FMazeLevelBuffer& NewRegion = Regions.Add(Region);
+				NewRegion.Layout.PlanRegion(RegionSize, Region, WorldSeed, RegionBorderOpenings);
+				NewRegion.IsRegion = true;
+				NewRegion.LevelOffset = FVector(Region.X * RegionExtent, Region.Y * RegionExtent, 0.0f);
+			}
+		}
+	}
+
+	// Discard the regions the player has left, one region further than the neighborhood, so that walking along a border does not respawn them
+	for (TMap<FIntVector, FMazeLevelBuffer>::TIterator It = Regions.CreateIterator(); It; ++It)
+	{
+		FIntVector Distance = It.Key() - PlayerRegion;
+		if (FMath::Max(FMath::Abs(Distance.X), FMath::Abs(Distance.Y)) > RegionRadius + 1)
+		{
+			DestroyLevelActors(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+	SET_DWORD_STAT(STAT_MazeRegions, Regions.Num());
+
+	// The region of the player cannot wait, for instance after a teleport
+	FMazeLevelBuffer& CurrentRegion = Regions.FindChecked(PlayerRegion);
+	while (!CurrentRegion.IsFullyMaterialized())
+	{
+		MaterializeNextCell(CurrentRegion);
+	}
+
+	// The other ones are spawned a few cells per frame, as the next level is
+	int32 CellBudget = NextLevelCellsPerFrame;
+	for (TPair<FIntVector, FMazeLevelBuffer>& Region : Regions)
+	{
+		while (CellBudget > 0 && !Region.Value.IsFullyMaterialized())
+		{
+			MaterializeNextCell(Region.Value);
+			CellBudget -= 1;
+		}
+	}
+}
+
+void AMaze::GenerateFloors(int32 SizeX, int32 SizeY, int32 FloorCount, int32 NumberOfMonsters, int32 MonsterPathLength)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeGenerate);
+	MAZE_TELEMETRY_SCOPE("Maze GenerateFloors");
+
+	// Every floor is planned, but kept packed until the player gets close to it
+	double StartTime = FPlatformTime::Seconds();
+	FloorPlan.Plan(SizeX, SizeY, FloorCount, NumberOfMonsters, MonsterPathLength, 0, SeedStream.GetUnsignedInt());
+	double PlanningTime = FPlatformTime::Seconds() - StartTime;
+	ActivateFloors();
+
+	UE_LOG(LogTemp, Warning, TEXT("Maze of %d floors generated in %.2f ms (planning %.3f ms), %d bytes packed"), FloorCount, (FPlatformTime::Seconds() - StartTime) * 1000.0, PlanningTime * 1000.0, FloorPlan.GetPackedSize());
+}
+
+void AMaze::ActivateFloors()
+{
+	MAZE_TELEMETRY_SCOPE("Maze ActivateFloors");
+
+	// For the "fadein" event broadcast
+	StartTransition();
+
+	IsFloorLevel = true;
+	SetActorTickEnabled(true);
+	CurrentFloor = INDEX_NONE;
+	SetCurrentFloor(0);
+	Size = FloorPlan.Size;
+
+	// The player starts on the first floor, the end is on the last one
+	StartLocation = GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(FIntVector(0, FloorPlan.StartY, 0)));
+	FirstPersonCharacter->InitializeLocation(StartLocation);
+
+	FVector EndLocation = GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(FIntVector(Size.X - 1, FloorPlan.EndY, 0)) + FVector(0.0f, 0.0f, (Size.Z - 1) * FloorHeight));
+	EndTriggerVolume->SetActorLocation(EndLocation + FVector(0.0f, 0.0f, 100));
+
+	// Death does not climb stairs
+	IsDeathActivated = false;
+
+	// Signals that the maze generation is finished
+	FinishGeneration();
+}
+
+void AMaze::SetCurrentFloor(int32 Floor)
+{
+	MAZE_TELEMETRY_SCOPE("Maze SetCurrentFloor");
+
+	// The previous floor is hidden, and its stairs and monsters go away
+	if (FMazeLevelBuffer* PreviousFloor = Floors.Find(CurrentFloor))
+	{
+		PreviousFloor->IsHidden = true;
+		for (AActor* Actor : PreviousFloor->Actors)
+		{
+			SetLevelActorHidden(Actor, true);
+		}
+	}
+	for (AActor* Actor : CurrentFloorActors)
+	{
+		if (APawn* Pawn = Cast<APawn>(Actor))
+		{
+			DestroyAIController(Pawn);
+		}
+		Actor->Destroy();
+	}
+	CurrentFloorActors.Reset();
+	CurrentFloor = Floor;
+
+	// Only the floors next to the one of the player are kept spawned, the other ones are only packed
+	for (TMap<int32, FMazeLevelBuffer>::TIterator It = Floors.CreateIterator(); It; ++It)
+	{
+		if (FMath::Abs(It.Key() - CurrentFloor) > 1)
+		{
+			DestroyLevelActors(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	// The floor of the player is spawned at once if it is not yet, then revealed
+	FMazeLevelBuffer& Current = FindOrUnpackFloor(Floor);
+	while (!Current.IsFullyMaterialized())
+	{
+		MaterializeNextCell(Current);
+	}
+	Current.IsHidden = false;
+	for (AActor* Actor : Current.Actors)
+	{
+		SetLevelActorHidden(Actor, false);
+	}
+
+	// Its layout becomes the one of the level, for the patrols of its monsters
+	Layout = Current.Layout;
+	LayoutOffset = Current.LevelOffset;
+	MonsterNumber = Layout.MonsterNumber;
+	AIPathLength = Layout.AIPathLength;
+	NextPatrolIndex = 0;
+
+	UWorld* const World = GetWorld();
+	if (World)
+	{
+		// The stairs of the floor, up or down
+		TArray<TPair<FIntVector, int32>> FloorStairs;
+		FloorPlan.GetStairs(Floor, FloorStairs);
+		for (const TPair<FIntVector, int32>& Stairs : FloorStairs)
+		{
+			FVector Location = GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(Stairs.Key) + LayoutOffset);
+			AMazeStairs* NewStairs = World->SpawnActor<AMazeStairs>(Location + FVector(0.0f, 0.0f, 100.0f), GetActorRotation());
+			NewStairs->Initialize(this, Stairs.Key, Stairs.Value);
+			CurrentFloorActors.Add(NewStairs);
+		}
+
+		// The monsters of the floor, each one takes the next patrol of the floor in CreateAIPath
+		for (int32 i = 0; i < MonsterNumber; i++)
+		{
+			FActorSpawnParameters Params;
+			UClass* AIMonsterClass = GetBlueprintClass(AIMonsterBlueprint);
+			Params.Name = MakeUniqueObjectName(GetLevel(), AIMonsterClass, FName(*FString::Printf(TEXT("Monster number %d floor %d"), i, Floor)));
+			AAICharacter* AIMonster = World->SpawnActor<AAICharacter>(AIMonsterClass, GetActorLocation() + LayoutOffset, FRotator(0.0f), Params);
+			AIMonster->AttachToActor(this, FAttachmentTransformRules(EAttachmentRule::KeepWorld, true));
+			CurrentFloorActors.Add(AIMonster);
+		}
+	}
+}
+
+FMazeLevelBuffer& AMaze::FindOrUnpackFloor(int32 Floor)
+{
+	FMazeLevelBuffer* Existing = Floors.Find(Floor);
+	if (Existing)
+	{
+		return *Existing;
+	}
+
+	// Spawned hidden and without collision, until the player comes to this floor
+	FMazeLevelBuffer& NewFloor = Floors.Add(Floor);
+	FloorPlan.UnpackFloor(Floor, NewFloor.Layout);
+	NewFloor.IsHidden = true;
+	NewFloor.LevelOffset = FVector(0.0f, 0.0f, Floor * FloorHeight);
+	return NewFloor;
+}
+
+void AMaze::UpdateFloors()
+{
+	MAZE_TELEMETRY_SCOPE("Maze UpdateFloors");
+
+	// The floors the stairs of the current one lead to, spawned a few cells per frame, as the next level is
+	int32 CellBudget = NextLevelCellsPerFrame;
+	for (int32 Floor = CurrentFloor - 1; Floor <= CurrentFloor + 1 && CellBudget > 0; Floor++)
+	{
+		if (Floor < 0 || Floor >= FloorPlan.Num())
+		{
+			continue;
+		}
+
+		FMazeLevelBuffer& Level = FindOrUnpackFloor(Floor);
+		while (CellBudget > 0 && !Level.IsFullyMaterialized())
+		{
+			MaterializeNextCell(Level);
+			CellBudget -= 1;
+		}
+	}
+}
+
+void AMaze::UpdateAIBudget()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeUpdateAIBudget);
+
+	if (!FirstPersonCharacter)
+	{
+		return;
+	}
+
+	// The AI characters are attached to the maze: the monsters of the level or of the floor, and Death
+	TArray<AActor*> AttachedActors;
+	GetAttachedActors(AttachedActors);
+	const FTransform LayoutTransform = GetLayoutTransform();
+	const FIntVector PlayerCell = Layout.GetCellCoordinates(LayoutTransform.InverseTransformPosition(FirstPersonCharacter->GetActorLocation()));
+	const bool IsPlayerInMaze = Layout.Num() > 0 && Layout.ContainsCoordinates(PlayerCell);
+	if (IsPlayerInMaze)
+	{
+		Layout.ComputeDistances(PlayerCell, PlayerDistances);
+	}
+
+	int32 AnimatedCount = 0;
+	int32 PausedCount = 0;
+	int32 CulledCount = 0;
+	for (AActor* Actor : AttachedActors)
+	{
+		AAICharacter* AICharacter = Cast<AAICharacter>(Actor);
+		if (!AICharacter)
+		{
+			continue;
+		}
+
+		// The AI Monsters listen for noises in their cell, followed at the same rate
+		AAIMonsterController* MonsterController = Cast<AAIMonsterController>(AICharacter->GetController());
+		if (MonsterController)
+		{
+			MonsterController->UpdateListeningCell();
+		}
+
+		// Out of the maze (the last level, Death arriving from above), every frame and unfiltered
+		FIntVector Cell = Layout.GetCellCoordinates(LayoutTransform.InverseTransformPosition(AICharacter->GetActorLocation()));
+		if (!IsPlayerInMaze || !Layout.ContainsCoordinates(Cell))
+		{
+			AICharacter->SetAnimationUpdateInterval(0.0f);
+			AICharacter->SetSoundOcclusion(1.0f, MAX_FILTER_FREQUENCY);
+			AnimatedCount += 1;
+			continue;
+		}
+
+		// In sight: down the same corridor, or next to the player around a corner
+		int32 Distance = PlayerDistances[Layout.ToIndex(Cell)];
+		bool IsInSight = Distance >= 0 && (Distance <= 1 || Layout.IsInSight(PlayerCell, Cell));
+		if (IsInSight)
+		{
+			AICharacter->SetAnimationUpdateInterval(FMath::Min(FMath::Max(Distance - FullRateAnimationDistance, 0) * AnimationIntervalPerCell, MaxAnimationInterval));
+			AnimatedCount += 1;
+		}
+		else
+		{
+			AICharacter->SetAnimationUpdateInterval(-1.0f);
+			PausedCount += 1;
+		}
+
+		// The sounds travel along the passages rather than through the walls: they fade with the path distance, and are muffled out of sight
+		if (Distance < 0 || Distance > MaxAudibleDistance)
+		{
+			AICharacter->SetSoundOcclusion(0.0f, OccludedLowPassFrequency);
+			CulledCount += 1;
+		}
+		else
+		{
+			AICharacter->SetSoundOcclusion(1.0f - (float)Distance / (MaxAudibleDistance + 1), IsInSight ? MAX_FILTER_FREQUENCY : OccludedLowPassFrequency);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_MazeAnimatedCharacters, AnimatedCount);
+	SET_DWORD_STAT(STAT_MazePausedAnimations, PausedCount);
+	SET_DWORD_STAT(STAT_MazeCulledSounds, CulledCount);
+}
+
+void AMaze::EmitNoise(FVector Location, int32 Radius)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeEmitNoise);
+
+	int32 CellIndex = GetCellIndexAt(Location);
+	if (CellIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Only the cells within reach are visited, whatever the number of AI Monsters
+	Layout.GetCellsWithin(Layout.ToCoordinates(CellIndex), Radius, NoiseCells);
+	INC_DWORD_STAT_BY(STAT_MazeNoiseCells, NoiseCells.Num());
+
+	TArray<AAIMonsterController*, TInlineAllocator<8>> Listeners;
+	for (const TPair<FIntVector, int32>& Cell : NoiseCells)
+	{
+		Listeners.Reset();
+		for (auto It = NoiseListeners.CreateConstKeyIterator(Layout.ToIndex(Cell.Key)); It; ++It)
+		{
+			Listeners.Add(It.Value());
+		}
+		for (AAIMonsterController* Listener : Listeners)
+		{
+			Listener->HearNoise(Location, Cell.Value);
+		}
+	}
+}
+
+int32 AMaze::GetCellIndexAt(FVector Location) const
+{
+	FIntVector Cell = Layout.GetCellCoordinates(GetLayoutTransform().InverseTransformPosition(Location));
+	return Layout.Num() > 0 && Layout.ContainsCoordinates(Cell) ? Layout.ToIndex(Cell) : INDEX_NONE;
+}
+
+void AMaze::MoveNoiseListener(AAIMonsterController* Listener, int32 PreviousCellIndex, int32 CellIndex)
+{
+	if (PreviousCellIndex != INDEX_NONE)
+	{
+		NoiseListeners.RemoveSingle(PreviousCellIndex, Listener);
+	}
+	if (CellIndex != INDEX_NONE)
+	{
+		NoiseListeners.Add(CellIndex, Listener);
+	}
+}
+
+void AMaze::GetStairsUp(TArray<FIntVector>& OutCells) const
+{
+	OutCells.Reset();
+	if (!IsFloorLevel)
+	{
+		return;
+	}
+
+	TArray<TPair<FIntVector, int32>> FloorStairs;
+	FloorPlan.GetStairs(CurrentFloor, FloorStairs);
+	for (const TPair<FIntVector, int32>& Stairs : FloorStairs)
+	{
+		if (Stairs.Value > CurrentFloor)
+		{
+			// In the coordinates of the layout of the floor
+			OutCells.Add(FIntVector(Stairs.Key.X, Stairs.Key.Y, 0));
+		}
+	}
+}
+
+void AMaze::TakeStairs(AMazeStairs* Stairs)
+{
+	if (!IsFloorLevel || !FloorPlan.Floors.IsValidIndex(Stairs->DestinationFloor))
+	{
+		return;
+	}
+
+	FIntVector Arrival(Stairs->Coordinates.X, Stairs->Coordinates.Y, Stairs->DestinationFloor);
+	SetCurrentFloor(Stairs->DestinationFloor);
+
+	// The player arrives in the stairs of the other floor, which should not send it back
+	for (AActor* Actor : CurrentFloorActors)
+	{
+		AMazeStairs* OtherEnd = Cast<AMazeStairs>(Actor);
+		if (OtherEnd && OtherEnd->Coordinates == Arrival)
+		{
+			OtherEnd->Disarm();
+		}
+	}
+
+	FirstPersonCharacter->InitializeLocation(GetActorTransform().TransformPosition(Layout.GetCellRelativeLocation(Arrival) + LayoutOffset));
+}
+
+void AMaze::DestroyLevelActors(FMazeLevelBuffer& Level)
+{
+	for (AActor* Actor : Level.Actors)
+	{
+		if (Actor)
+		{
+			Actor->Destroy();
+		}
+	}
+	Level.Actors.Reset();
+}
+
+void AMaze::SetSeed(int32 Seed)
+{
+	// The prepared level was planned with the previous seeds
+	DiscardNextLevel();
+	SeedStream.Initialize(Seed);
+}
+
 void AMaze::SubscribeDestroyMaze()
 {
 	DestroyMazeHandle = EndTriggerVolume->OnFadeOutLaunched().AddUFunction(this, FName("DestroyMaze"));
@@ -4,14 +4,18 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/StreamableManager.h"
 class AMazeCell;
 #include "MazeCell2DArray.h"
 class AMazePassage;
 class AMazeWall;
+class AMazeCellEdge;
 class AEndTriggerVolume;
 class AAmazeingCharacter;
 class AAICharacter;
-#include "Bool2DArray.h"
+#include "MazeLayout.h"
+#include "MazeFloors.h"
+#include "MazeIdleScheduler.h"
 #include "Maze.generated.h"
 
 // Declaration of event signature with no return and no param
@@ -32,11 +36,72 @@ public:
 	// Generates a Maze, sets the player at a start point, the end at an end point, and the AI characters
 	void Generate(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimer = 0);
 
+	// Generates a Maze from a layout planned beforehand, for instance by the maze library
+	void Generate(const FMazeLayout& PlannedLayout);
+
+	// Plans the next level while the current one is played, and spawns it hidden and without collision over the next frames
+	void PrepareNextLevel(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimer = 0);
+
+	// Same, from a layout planned beforehand
+	void PrepareNextLevel(const FMazeLayout& PlannedLayout);
+
+	// Topology of the current level
+	const FMazeLayout& GetLayout() const { return Layout; }
+
+	// From the current layout to the world: the maze actor, plus the floor of the player for a multi-floor level
+	FTransform GetLayoutTransform() const { return FTransform(LayoutOffset) * GetActorTransform(); }
+
+	// Whether or not a next level has been prepared
+	bool HasNextLevel() const { return NextLevel.Layout.IsValid(); }
+
+	// Swaps the prepared level in: reveals it, sets the player, the end and the AI characters
+	void ActivateNextLevel();
+
+	// Destroys the prepared level, if any
+	void DiscardNextLevel();
+
+	// Spawns at once what remains of the prepared level, instead of waiting for the next frames
+	void CompleteNextLevel();
+
+	// Generates the current level again for a retry after a Death kill, restored from its snapshot if RetryWithSameLayout
+	void RetryLevel();
+
 	// Generates the last level
 	void GenerateLastLevel();
 
-	// Returns random coordinates
-	FIntVector RandomCoordinates();
+	// Generates a maze without bounds: its regions are generated around the player as it walks, and discarded behind it
+	void GenerateUnbounded(int32 InWorldSeed);
+
+	// Whether or not the current level is an unbounded maze
+	bool IsUnbounded() const { return IsUnboundedLevel; }
+
+	// Region of the unbounded maze containing the location
+	FIntVector GetRegionAt(FVector Location) const;
+
+	// Layout of the part of the level at the location, with its transform to the world: its region for an unbounded maze, the floor of the player otherwise
+	// Returns nullptr if there is none, for the last level or a region which is not planned
+	const FMazeLayout* GetLayoutAt(FVector Location, FTransform& OutLayoutTransform) const;
+
+	// Whether or not the current level is the last one, a blueprint instead of a generated maze
+	bool IsPlayingLastLevel() const { return IsOnLastLevel; }
+
+	// Generates a maze of stacked floors linked by stairs: only the floor of the player is shown, the floors next to it are spawned hidden
+	void GenerateFloors(int32 SizeX, int32 SizeY, int32 FloorCount, int32 NumberOfMonsters, int32 MonsterPathLength);
+
+	// Whether or not the current level has several floors
+	bool HasFloors() const { return IsFloorLevel; }
+
+	// Floor of the player on a multi-floor level
+	int32 GetCurrentFloor() const { return CurrentFloor; }
+
+	// Cells of the floor of the player with stairs going up, toward the end, none on the last floor
+	void GetStairsUp(TArray<FIntVector>& OutCells) const;
+
+	// Takes the player to the other end of the stairs, called by the stairs
+	void TakeStairs(class AMazeStairs* Stairs);
+
+	// Seeds the layouts planned from now on, so that a session can be played again with the same levels
+	void SetSeed(int32 Seed);
 
 	// Verifies whether or not the coordinates are inside the maze
 	bool ContainsCoordinates(FIntVector Coordinate);
@@ -44,19 +109,13 @@ public:
 	// Gets the cell at given coordinates, returns nullptr if none has been found
 	AMazeCell* GetCell(FIntVector Coordinates);
 
-	// Initializes the maze generation by adding a cell to the active cells list
-	void DoFirstGenerationStep(TArray<AMazeCell*>& ActiveCells);
-
-	// Generates the next maze cell following a backtrack algorithm
-	void DoNextGenerationStep(TArray<AMazeCell*>& ActiveCells);
-
 	// Generates a passage
-	void CreatePassage(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction);
+	AMazeCellEdge* CreatePassage(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction);
 
 	// Generates a wall
-	void CreateWall(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction);
+	AMazeCellEdge* CreateWall(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction);
 
-	// Gives the beginning and end of the patrol path for the AI Monster
+	// Gives the beginning and end of the patrol path for the AI Monster, planned with the layout
 	TArray<FVector> CreateAIPath();
 
 	// Accessor to the event to warn that the maze is generated && minimal waiting time passed is elapsed
@@ -91,19 +150,105 @@ public:
 	// Reset the End trigger scale - used for the restart of the game
 	void ResetEndTriggerScale();
 
+	// Spreads a noise along the passages from a location, for Radius cells: the AI Monsters listening in these cells hear it
+	void EmitNoise(FVector Location, int32 Radius);
+
+	// Index of the cell of the current layout at a location, INDEX_NONE if it is out of the maze
+	int32 GetCellIndexAt(FVector Location) const;
+
+	// Moves an AI Monster listening for noises from a cell to another, INDEX_NONE for none
+	void MoveNoiseListener(class AAIMonsterController* Listener, int32 PreviousCellIndex, int32 CellIndex);
+
+	// Work deferred to the moments the player cannot see, run in the maze tick
+	FMazeIdleScheduler& GetIdleScheduler() { return IdleScheduler; }
+
+	// Starts streaming the blueprints of the levels: the cells, passages, walls and monsters, plus Death and the last level when a coming level needs them
+	void StreamBlueprints(bool IsLastLevel, bool HasDeath);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// Called every frame, used here to generate events for the transitions
+	// Called while the maze has background work, see NeedsTick
 	virtual void Tick(float DeltaSeconds) override;
 
+	// Removes the teardown audit from the garbage collection
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
-	// Creates a Cell with a Plane at location (X,Y), and returns a pointer to it
-	AMazeCell * CreateCell(FIntVector Coordinates);
+	// Creates a Cell with a Plane at location (X,Y) of the level, and returns a pointer to it
+	AMazeCell * CreateCell(FMazeLevelBuffer& Level, FIntVector Coordinates);
+
+	// Spawns the next cell of the level, with its edges toward the cells already spawned
+	void MaterializeNextCell(FMazeLevelBuffer& Level);
+
+	// Makes the level the current one: finishes spawning it, reveals it, then places the player, the end and the AI characters
+	void ActivateLevel(FMazeLevelBuffer& Level);
+
+	// Unpossesses and destroys the AI controller of a character of the maze, with its perception, blackboard and behavior tree
+	void DestroyAIController(class APawn* Pawn);
+
+	// Logs, grouped by class, the objects of the maze actors and AI controllers which are still alive once the torn down level is collected
+	void ReportSurvivingObjects() const;
+
+	// After every garbage collection, audits the level torn down before it, if any
+	void OnPostGarbageCollect();
+
+	// Destroys every actor spawned for a level
+	void DestroyLevelActors(FMazeLevelBuffer& Level);
+
+	// Plans the regions around the player, spawns them a few cells per frame, and discards the ones it has left
+	void UpdateRegions();
+
+	// Starts the planned floors: the player on the first one, the end on the last one
+	void ActivateFloors();
+
+	// Makes a floor the one of the player: the previous one is hidden, this one is revealed with its stairs and monsters, the floors too far are discarded
+	void SetCurrentFloor(int32 Floor);
+
+	// Unpacks a floor to spawn it, if it is not already
+	FMazeLevelBuffer& FindOrUnpackFloor(int32 Floor);
+
+	// Spawns the floors next to the one of the player, hidden, a few cells per frame
+	void UpdateFloors();
 
-	// Returns a random Cell which has a passage edge with the Cell in parameter and is not yet used for the AI
-	AMazeCell* RandomUsableNeighborCell(AMazeCell* Cell);
+	// Whether or not the maze has work for its tick: the next level to spawn, the regions or floors to follow the player with, or idle work that may run
+	bool NeedsTick() const;
+
+	// Starts the countdown of the transition text, the "fadein" event is broadcast once it is over and the generation is finished
+	void StartTransition();
+
+	// The transition text has been shown long enough
+	void OnTransitionCountdownFinished();
+
+	// Signals that the maze generation is finished
+	void FinishGeneration();
+
+	// Broadcasts the "fadein" event, and starts the countdown of Death if the level has it
+	void FinishTransition();
+
+	// Spawns Death at the start of the level
+	void SpawnDeath();
+
+	// Budgets the AI characters from their distance to the player along the passages: their animation is slower further and paused out of sight,
+	// their sounds are muffled behind the walls and culled beyond MaxAudibleDistance
+	void UpdateAIBudget();
+
+	// Hides an actor of a level and disables its collision, or the opposite
+	void SetLevelActorHidden(AActor* Actor, bool IsHidden);
+
+	// Gives the class of a blueprint, loaded now if it has not been streamed in time
+	template<class T>
+	UClass* GetBlueprintClass(const TSoftClassPtr<T>& Blueprint) const
+	{
+		UClass* Class = Blueprint.Get();
+		if (!Class && !Blueprint.IsNull())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Maze: %s not streamed in time, loaded now"), *Blueprint.ToString());
+			Class = Blueprint.LoadSynchronous();
+		}
+		return Class;
+	}
 
 	// Resets the player character position to the start of the maze
 	UFUNCTION()
@@ -122,29 +267,29 @@ public:
 	UPROPERTY()
 		int32 AIPathLength;
 
-	// Blueprint pointer to the MazeCell Blueprint
+	// Blueprint pointer to the MazeCell Blueprint, streamed when the game starts
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AMazeCell> CellBlueprint;
+		TSoftClassPtr<class AMazeCell> CellBlueprint;
 
-	// Blueprint pointer to the MazeWall Blueprint
+	// Blueprint pointer to the MazeWall Blueprint, streamed when the game starts
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AMazeCellEdge> WallBlueprint;
+		TSoftClassPtr<class AMazeCellEdge> WallBlueprint;
 
-	// Blueprint pointer to the MazePassage Blueprint
+	// Blueprint pointer to the MazePassage Blueprint, streamed when the game starts
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AMazeCellEdge> PassageBlueprint;
+		TSoftClassPtr<class AMazeCellEdge> PassageBlueprint;
 
-	// Blueprint pointer to the Last Level Blueprint
+	// Blueprint pointer to the Last Level Blueprint, streamed during the level before the last one
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AMazeCell> LastLevelBlueprint;
+		TSoftClassPtr<class AMazeCell> LastLevelBlueprint;
 
-	// Blueprint pointer to the AIMonster Blueprint
+	// Blueprint pointer to the AIMonster Blueprint, streamed when the game starts
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AAICharacter> AIMonsterBlueprint;
+		TSoftClassPtr<class AAICharacter> AIMonsterBlueprint;
 
-	// Blueprint pointer to the AIDeath Blueprint
+	// Blueprint pointer to the AIDeath Blueprint, streamed before the first level with Death
 	UPROPERTY(EditAnywhere)
-		TSubclassOf<class AAICharacter> AIDeathBlueprint;
+		TSoftClassPtr<class AAICharacter> AIDeathBlueprint;
 
 	// Pointer to the FPC
 	UPROPERTY(EditAnywhere)
@@ -162,22 +307,138 @@ public:
 	UPROPERTY(EditAnywhere)
 		int32 TransitionDuration;
 
+	// Whether or not the prepared next level is spawned in the background, otherwise it is spawned when activated
+	UPROPERTY(EditAnywhere)
+		bool MaterializeNextLevel;
+
+	// Number of cells of the next level spawned each frame in the background
+	UPROPERTY(EditAnywhere)
+		int32 NextLevelCellsPerFrame;
+
+	// Time the idle work may take in a frame of an idle window, in ms
+	UPROPERTY(EditAnywhere)
+		float IdleFrameBudgetMs;
+
+	// Whether or not the start and the end of the generated levels are placed the farthest apart along the passages, otherwise on random rows
+	UPROPERTY(EditAnywhere)
+		bool PlaceStartEndFarthest;
+
+	// Whether or not a level retried after a Death kill keeps the exact same layout, otherwise a new one of the same size is generated
+	UPROPERTY(EditAnywhere)
+		bool RetryWithSameLayout;
+
+	// Whether or not the objects surviving the destruction of a level are reported, which goes through every object, also set by -MazeAuditTeardown
+	UPROPERTY(EditAnywhere)
+		bool AuditTeardown;
+
+	// Number of cells along each side of a region of the unbounded maze
+	UPROPERTY(EditAnywhere)
+		int32 RegionSize;
+
+	// Number of regions kept around the region of the player, in each direction
+	UPROPERTY(EditAnywhere)
+		int32 RegionRadius;
+
+	// Number of passages through each border between two regions
+	UPROPERTY(EditAnywhere)
+		int32 RegionBorderOpenings;
+
+	// Distance, in regions, from the start to the region of the exit
+	UPROPERTY(EditAnywhere)
+		int32 ExitRegionDistance;
+
+	// Height between two floors of a multi-floor maze, above the walls
+	UPROPERTY(EditAnywhere)
+		float FloorHeight;
+
+	// Time between two updates of the animation and sound budget of the AI characters, in s
+	UPROPERTY(EditAnywhere)
+		float AIBudgetPeriod;
+
+	// Distance along the passages, in cells, up to which the AI characters in sight are animated every frame
+	UPROPERTY(EditAnywhere)
+		int32 FullRateAnimationDistance;
+
+	// Time added between two animation updates of an AI character in sight for every cell beyond FullRateAnimationDistance, in s
+	UPROPERTY(EditAnywhere)
+		float AnimationIntervalPerCell;
+
+	// Longest time between two animation updates of an AI character in sight, in s
+	UPROPERTY(EditAnywhere)
+		float MaxAnimationInterval;
+
+	// Distance along the passages, in cells, beyond which the sounds of an AI character are culled. They fade with the distance up to it
+	UPROPERTY(EditAnywhere)
+		int32 MaxAudibleDistance;
+
+	// Cutoff frequency of the sounds of an AI character which is not in sight, heard through the walls, in Hz
+	UPROPERTY(EditAnywhere)
+		float OccludedLowPassFrequency;
+
 private:
-	// Used to track the cell path during the backtrack algorithm (Defined here to be properly garbaged collected)
+	// Topology of the current level
+	UPROPERTY()
+		FMazeLayout Layout;
+
+	// Next level, prepared while the current one is played
+	UPROPERTY()
+		FMazeLevelBuffer NextLevel;
+
+	// Bit-packed layout of the current level, captured when it starts, used to retry it
 	UPROPERTY()
-		TArray<AMazeCell*> ActiveCells;
+		TArray<uint8> Snapshot;
+
+	// Gives the seeds of the planned layouts
+	FRandomStream SeedStream;
+
+	// Regions of the unbounded maze around the player, by region coordinates
+	UPROPERTY()
+		TMap<FIntVector, FMazeLevelBuffer> Regions;
+
+	// Whether or not the current level is an unbounded maze
+	bool IsUnboundedLevel;
+
+	// Seed of the unbounded maze, every region is derived from it
+	int32 WorldSeed;
+
+	// Whether or not the current level is the last one
+	bool IsOnLastLevel;
 
-	// Used to track which cells shall not be used for the AI Monster paths
+	// Floors of the multi-floor level, packed, kept after the level is destroyed so that it can be retried
 	UPROPERTY()
-		TArray<FBool2DArray> IsCellUsed;
+		FMazeFloorPlan FloorPlan;
 
-	// Current Cell of the maze generation
+	// Spawned floors: the one of the player, and the hidden ones next to it
 	UPROPERTY()
-		AMazeCell* CurrentCell;
+		TMap<int32, FMazeLevelBuffer> Floors;
 
-	// Current Neighbor of the maze generation
+	// Stairs and monsters of the floor of the player, gone when the player leaves it
 	UPROPERTY()
-		AMazeCell* Neighbor;
+		TArray<AActor*> CurrentFloorActors;
+
+	// Whether or not the current level has several floors
+	bool IsFloorLevel;
+
+	// Floor of the player
+	int32 CurrentFloor;
+
+	// Location of the current layout relative to the maze actor, the floor of the player for a multi-floor level
+	FVector LayoutOffset;
+
+	// Updates the budget of the AI characters every AIBudgetPeriod
+	FTimerHandle AIBudgetTimerHandle;
+
+	// AI Monsters listening for noises, by index of their cell, so that a noise only looks at the cells it reaches
+	TMultiMap<int32, class AAIMonsterController*> NoiseListeners;
+
+	// Cells reached by the last noise, kept to avoid allocating at every footstep
+	TArray<TPair<FIntVector, int32>> NoiseCells;
+
+	// Distances from the cell of the player along the passages, kept between the updates of the animation budget
+	TArray<int32> PlayerDistances;
+
+	// Index of the next patrol of the layout to give to an AI Monster
+	int32 NextPatrolIndex;
 
 	// Used for broadcasting the "fadein" event at the right time
 	bool IsEventNeeded;
@@ -189,13 +450,13 @@ private:
 	bool IsGenerationFinished;
 
 	// Used for broadcasting the "fadein" event at the right time : countdown
-	float Countdown;
+	FTimerHandle TransitionTimerHandle;
 
 	// Used for the Death activation
 	bool IsDeathActivated;
 
 	// Used for Death spawn
-	float DeathCountdown;
+	FTimerHandle DeathTimerHandle;
 
 	// Used for the Death activation
 	int32 DeathArrivalTime;
@@ -223,4 +484,18 @@ private:
 
 	// Delegate used for removing a function from an event
 	FDelegateHandle DestroyMazeHandle;
+
+	// Binding of the teardown audit to the end of the garbage collections
+	FDelegateHandle PostGarbageCollectHandle;
+
+	// Whether or not a level has been torn down since the last garbage collection, for the audit
+	bool IsTeardownAuditPending;
+
+	// Deferred work, run during the transitions and the fades
+	FMazeIdleScheduler IdleScheduler;
+
+	// Loads of the streamed blueprints, kept for the whole game
+	TSharedPtr<FStreamableHandle> LevelBlueprintsHandle;
+	TSharedPtr<FStreamableHandle> DeathBlueprintHandle;
+	TSharedPtr<FStreamableHandle> LastLevelBlueprintHandle;
 };
\ No newline at end of file
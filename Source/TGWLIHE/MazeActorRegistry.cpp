@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeActorRegistry.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "MazeStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registry actor scans"), STAT_MazeRegistryScans, STATGROUP_Maze);
+
+TMap<FObjectKey, TMap<UClass*, TWeakObjectPtr<AActor>>> FMazeActorRegistry::Actors;
+
+void FMazeActorRegistry::Add(AActor* Actor, UClass* Class)
+{
+	check(IsInGameThread());
+
+	UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+	if (!World)
+	{
+		return;
+	}
+
+	// The worlds are forgotten when they are cleaned up, the editor and the tests create several of them
+	static FDelegateHandle WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&FMazeActorRegistry::OnWorldCleanup);
+
+	Actors.FindOrAdd(FObjectKey(World)).Add(Class, Actor);
+}
+
+AActor* FMazeActorRegistry::Find(UWorld* World, UClass* Class)
+{
+	check(IsInGameThread());
+
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	TMap<UClass*, TWeakObjectPtr<AActor>>* WorldActors = Actors.Find(FObjectKey(World));
+	TWeakObjectPtr<AActor>* Actor = WorldActors ? WorldActors->Find(Class) : nullptr;
+	if (Actor && Actor->IsValid())
+	{
+		return Actor->Get();
+	}
+
+	// Not registered yet, for instance asked for before its BeginPlay: we look for it once
+	INC_DWORD_STAT(STAT_MazeRegistryScans);
+	for (TActorIterator<AActor> ActorItr(World, Class); ActorItr; ++ActorItr)
+	{
+		if (!ActorItr->IsPendingKill())
+		{
+			Add(*ActorItr, Class);
+			return *ActorItr;
+		}
+	}
+	return nullptr;
+}
+
+void FMazeActorRegistry::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	Actors.Remove(FObjectKey(World));
+}
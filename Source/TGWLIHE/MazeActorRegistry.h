@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+class AActor;
+class UWorld;
+
+/**
+* The actors a world has only one of, the maze, the main character, the audio manager and the end trigger, by native class
+* They register in their BeginPlay, and are found without walking the actors of the world. One that has not registered yet
+* is looked for once among the actors, then kept
+*/
+class TGWLIHE_API FMazeActorRegistry
+{
+public:
+	// Registers the actor as the one of its class in its world
+	template<class T>
+	static void Register(T* Actor)
+	{
+		Add(Actor, T::StaticClass());
+	}
+
+	// The actor of the class in the world of the context object, nullptr if there is none
+	template<class T>
+	static T* Get(const UObject* WorldContextObject)
+	{
+		return Cast<T>(Find(WorldContextObject ? WorldContextObject->GetWorld() : nullptr, T::StaticClass()));
+	}
+
+private:
+	static void Add(AActor* Actor, UClass* Class);
+
+	static AActor* Find(UWorld* World, UClass* Class);
+
+	// Forgets the actors of a world being cleaned up
+	static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	// Actors of every world, by native class
+	static TMap<FObjectKey, TMap<UClass*, TWeakObjectPtr<AActor>>> Actors;
+};
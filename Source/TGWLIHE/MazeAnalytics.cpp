@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeAnalytics.h"
+#include "MazeDirections.h"
+#include "Async/ParallelFor.h"
+#include "Containers/BitArray.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Batch analysis"), STAT_MazeBatchAnalysis, STATGROUP_Maze);
+
+FMazeAnalysis::FMazeAnalysis()
+	: SolutionLength(-1)
+	, DeadEnds(0)
+	, Junctions(0)
+	, BranchingFactor(0.0f)
+	, AverageCorridorLength(0.0f)
+	, FarthestCell(FIntVector::ZeroValue)
+	, FarthestDistance(0)
+	, PatrolCoverage(0.0f)
+	, SolutionPatrolCoverage(0.0f)
+{
+}
+
+void FMazeAnalysis::Analyze(const FMazeLayout& Layout)
+{
+	*this = FMazeAnalysis();
+	if (!Layout.IsValid())
+	{
+		return;
+	}
+
+	const FIntVector Start(0, Layout.StartY, 0);
+	const FIntVector End(Layout.Size.X - 1, Layout.EndY, 0);
+	TArray<int32> Distances;
+	Layout.ComputeDistances(Start, Distances);
+	FarthestCell = Start;
+
+	// One pass over the cells: a corridor goes from a cell which is not in the middle of one to another, so that there are half as many
+	// corridors as passages out of these cells
+	int32 PassageEnds = 0;
+	int32 CorridorEnds = 0;
+	int32 WaysOn = 0;
+	int32 CrossedCells = 0;
+	for (int32 Index = 0; Index < Layout.Num(); Index++)
+	{
+		int32 Passages = FMath::CountBits(Layout.PassageMasks[Index]);
+		PassageEnds += Passages;
+		if (Passages != 2)
+		{
+			CorridorEnds += Passages;
+		}
+		if (Passages == 1)
+		{
+			DeadEnds += 1;
+		}
+		else if (Passages >= 2)
+		{
+			WaysOn += Passages - 1;
+			CrossedCells += 1;
+			if (Passages >= 3)
+			{
+				Junctions += 1;
+			}
+		}
+
+		if (Distances[Index] > FarthestDistance)
+		{
+			FarthestDistance = Distances[Index];
+			FarthestCell = Layout.ToCoordinates(Index);
+		}
+	}
+	BranchingFactor = CrossedCells > 0 ? (float)WaysOn / CrossedCells : 0.0f;
+	AverageCorridorLength = CorridorEnds > 0 ? (float)PassageEnds / CorridorEnds : 0.0f;
+
+	int32 EndDistance = Distances[Layout.ToIndex(End)];
+	SolutionLength = EndDistance < 0 ? -1 : EndDistance + 1;
+
+	// Every cell but the start has a neighbor one step closer to it: the paths between two cells are walked up from the farther one
+	auto StepToStart = [&Layout, &Distances](FIntVector Cell) -> FIntVector
+	{
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			FIntVector Neighbor = Cell + UMazeDirections::ToIntVector((EMazeDirection)i);
+			if (Layout.HasPassage(Cell, (EMazeDirection)i) && Distances[Layout.ToIndex(Neighbor)] == Distances[Layout.ToIndex(Cell)] - 1)
+			{
+				return Neighbor;
+			}
+		}
+		return Cell;
+	};
+
+	TBitArray<> IsOnPatrol(false, Layout.Num());
+	int32 PatrolCells = 0;
+	auto MarkPatrolCell = [&Layout, &IsOnPatrol, &PatrolCells](FIntVector Cell)
+	{
+		int32 Index = Layout.ToIndex(Cell);
+		if (!IsOnPatrol[Index])
+		{
+			IsOnPatrol[Index] = true;
+			PatrolCells += 1;
+		}
+	};
+
+	for (const FMazePatrol& Patrol : Layout.Patrols)
+	{
+		if (!Layout.ContainsCoordinates(Patrol.Home) || !Layout.ContainsCoordinates(Patrol.Target)
+			|| Distances[Layout.ToIndex(Patrol.Home)] < 0 || Distances[Layout.ToIndex(Patrol.Target)] < 0)
+		{
+			continue;
+		}
+
+		FIntVector Home = Patrol.Home;
+		FIntVector Target = Patrol.Target;
+		MarkPatrolCell(Home);
+		MarkPatrolCell(Target);
+		while (Home != Target)
+		{
+			if (Distances[Layout.ToIndex(Home)] >= Distances[Layout.ToIndex(Target)])
+			{
+				Home = StepToStart(Home);
+				MarkPatrolCell(Home);
+			}
+			else
+			{
+				Target = StepToStart(Target);
+				MarkPatrolCell(Target);
+			}
+		}
+	}
+	PatrolCoverage = (float)PatrolCells / Layout.Num();
+
+	if (SolutionLength > 0)
+	{
+		int32 SolutionPatrolCells = IsOnPatrol[Layout.ToIndex(End)] ? 1 : 0;
+		for (FIntVector Cell = End; Cell != Start; )
+		{
+			Cell = StepToStart(Cell);
+			SolutionPatrolCells += IsOnPatrol[Layout.ToIndex(Cell)] ? 1 : 0;
+		}
+		SolutionPatrolCoverage = (float)SolutionPatrolCells / SolutionLength;
+	}
+}
+
+FMazeHistogram::FMazeHistogram(float InBucketWidth)
+	: BucketWidth(FMath::Max(InBucketWidth, KINDA_SMALL_NUMBER))
+	, ValueCount(0)
+	, Sum(0.0)
+	, MinValue(0.0f)
+	, MaxValue(0.0f)
+{
+}
+
+void FMazeHistogram::Add(float Value)
+{
+	int32 Bucket = FMath::Max(FMath::FloorToInt(Value / BucketWidth), 0);
+	if (Bucket >= Buckets.Num())
+	{
+		Buckets.AddZeroed(Bucket + 1 - Buckets.Num());
+	}
+	Buckets[Bucket] += 1;
+
+	MinValue = ValueCount > 0 ? FMath::Min(MinValue, Value) : Value;
+	MaxValue = ValueCount > 0 ? FMath::Max(MaxValue, Value) : Value;
+	ValueCount += 1;
+	Sum += Value;
+}
+
+void FMazeHistogram::Merge(const FMazeHistogram& Other)
+{
+	check(Other.BucketWidth == BucketWidth);
+	if (Other.ValueCount == 0)
+	{
+		return;
+	}
+
+	if (Other.Buckets.Num() > Buckets.Num())
+	{
+		Buckets.AddZeroed(Other.Buckets.Num() - Buckets.Num());
+	}
+	for (int32 Bucket = 0; Bucket < Other.Buckets.Num(); Bucket++)
+	{
+		Buckets[Bucket] += Other.Buckets[Bucket];
+	}
+
+	MinValue = ValueCount > 0 ? FMath::Min(MinValue, Other.MinValue) : Other.MinValue;
+	MaxValue = ValueCount > 0 ? FMath::Max(MaxValue, Other.MaxValue) : Other.MaxValue;
+	ValueCount += Other.ValueCount;
+	Sum += Other.Sum;
+}
+
+float FMazeHistogram::GetPercentile(float Fraction) const
+{
+	int64 Rank = (int64)(Fraction * ValueCount);
+	int64 Counted = 0;
+	for (int32 Bucket = 0; Bucket < Buckets.Num(); Bucket++)
+	{
+		Counted += Buckets[Bucket];
+		if (Counted > Rank)
+		{
+			return Bucket * BucketWidth;
+		}
+	}
+	return GetMax();
+}
+
+FMazeBatchAnalysis::FMazeBatchAnalysis()
+	: UnsolvableCount(0)
+	, RunSeconds(0.0)
+{
+	for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+	{
+		Histograms[Metric] = MakeHistogram((EMazeMetric::Type)Metric);
+	}
+}
+
+FMazeHistogram FMazeBatchAnalysis::MakeHistogram(EMazeMetric::Type Metric)
+{
+	switch (Metric)
+	{
+	case EMazeMetric::BranchingFactor:
+		return FMazeHistogram(0.05f);
+	case EMazeMetric::AverageCorridorLength:
+		return FMazeHistogram(0.25f);
+	case EMazeMetric::PatrolCoverage:
+	case EMazeMetric::SolutionPatrolCoverage:
+		return FMazeHistogram(0.01f);
+	default:
+		return FMazeHistogram(1.0f);
+	}
+}
+
+const TCHAR* FMazeBatchAnalysis::GetMetricName(EMazeMetric::Type Metric)
+{
+	static const TCHAR* Names[EMazeMetric::Count] = { TEXT("SolutionLength"), TEXT("DeadEnds"), TEXT("BranchingFactor"), TEXT("AverageCorridorLength"), TEXT("FarthestDistance"), TEXT("PatrolCoverage"), TEXT("SolutionPatrolCoverage") };
+	return Metric < EMazeMetric::Count ? Names[Metric] : TEXT("");
+}
+
+int32 FMazeBatchAnalysis::GetMazeSeed(int32 BatchSeed, int32 Index)
+{
+	return (int32)HashCombine(GetTypeHash(BatchSeed), GetTypeHash(Index));
+}
+
+void FMazeBatchAnalysis::AddAnalysis(const FMazeAnalysis& Analysis, FMazeHistogram* OutHistograms)
+{
+	OutHistograms[EMazeMetric::SolutionLength].Add(Analysis.SolutionLength);
+	OutHistograms[EMazeMetric::DeadEnds].Add(Analysis.DeadEnds);
+	OutHistograms[EMazeMetric::BranchingFactor].Add(Analysis.BranchingFactor);
+	OutHistograms[EMazeMetric::AverageCorridorLength].Add(Analysis.AverageCorridorLength);
+	OutHistograms[EMazeMetric::FarthestDistance].Add(Analysis.FarthestDistance);
+	OutHistograms[EMazeMetric::PatrolCoverage].Add(Analysis.PatrolCoverage);
+	OutHistograms[EMazeMetric::SolutionPatrolCoverage].Add(Analysis.SolutionPatrolCoverage);
+}
+
+void FMazeBatchAnalysis::Run(const FMazeBatchSettings& InSettings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeBatchAnalysis);
+
+	Settings = InSettings;
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Every task fills its own histograms, merged once all are done: the workers share nothing
+	struct FTaskResult
+	{
+		FMazeHistogram Histograms[EMazeMetric::Count];
+		int32 UnsolvableCount;
+	};
+	const int32 TaskCount = FMath::DivideAndRoundUp(FMath::Max(Settings.Count, 0), MazesPerTask);
+	TArray<FTaskResult> TaskResults;
+	TaskResults.SetNum(TaskCount);
+
+	ParallelFor(TaskCount, [this, &TaskResults](int32 Task)
+	{
+		FTaskResult& Result = TaskResults[Task];
+		for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+		{
+			Result.Histograms[Metric] = MakeHistogram((EMazeMetric::Type)Metric);
+		}
+		Result.UnsolvableCount = 0;
+
+		FMazeLayout Layout;
+		FMazeAnalysis Analysis;
+		const int32 LastIndex = FMath::Min((Task + 1) * MazesPerTask, Settings.Count);
+		for (int32 Index = Task * MazesPerTask; Index < LastIndex; Index++)
+		{
+			Layout.Plan(Settings.SizeX, Settings.SizeY, Settings.NumberOfMonsters, Settings.MonsterPathLength, 0, GetMazeSeed(Settings.Seed, Index), Settings.PlaceStartEndFarthest);
+			Analysis.Analyze(Layout);
+			if (Analysis.SolutionLength < 0)
+			{
+				Result.UnsolvableCount += 1;
+				continue;
+			}
+			AddAnalysis(Analysis, Result.Histograms);
+		}
+	});
+
+	UnsolvableCount = 0;
+	for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+	{
+		Histograms[Metric] = MakeHistogram((EMazeMetric::Type)Metric);
+	}
+	for (const FTaskResult& Result : TaskResults)
+	{
+		for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+		{
+			Histograms[Metric].Merge(Result.Histograms[Metric]);
+		}
+		UnsolvableCount += Result.UnsolvableCount;
+	}
+
+	RunSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void FMazeBatchAnalysis::LogSummary() const
+{
+	UE_LOG(LogTemp, Display, TEXT("Maze analytics: %d mazes of %dx%d, %d monsters of %d cells%s, seed %d, %d unsolvable, in %.2f s"),
+		Settings.Count, Settings.SizeX, Settings.SizeY, Settings.NumberOfMonsters, Settings.MonsterPathLength, Settings.PlaceStartEndFarthest ? TEXT(", start and end farthest apart") : TEXT(""),
+		Settings.Seed, UnsolvableCount, RunSeconds);
+
+	for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+	{
+		const FMazeHistogram& Histogram = Histograms[Metric];
+		UE_LOG(LogTemp, Display, TEXT("  %-24s mean %8.2f, min %8.2f, p10 %8.2f, p50 %8.2f, p90 %8.2f, max %8.2f"), GetMetricName((EMazeMetric::Type)Metric),
+			Histogram.GetMean(), Histogram.GetMin(), Histogram.GetPercentile(0.1f), Histogram.GetPercentile(0.5f), Histogram.GetPercentile(0.9f), Histogram.GetMax());
+	}
+}
+
+bool FMazeBatchAnalysis::AppendToCSV(const FString& Filename, const FString& BatchName) const
+{
+	FString Lines;
+	if (!FPaths::FileExists(Filename))
+	{
+		Lines += TEXT("Batch,SizeX,SizeY,Monsters,MonsterPathLength,Metric,BucketStart,Count\n");
+	}
+
+	for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+	{
+		const FMazeHistogram& Histogram = Histograms[Metric];
+		const TArray<int64>& Buckets = Histogram.GetBuckets();
+		for (int32 Bucket = 0; Bucket < Buckets.Num(); Bucket++)
+		{
+			if (Buckets[Bucket] > 0)
+			{
+				Lines += FString::Printf(TEXT("%s,%d,%d,%d,%d,%s,%g,%lld\n"), *BatchName, Settings.SizeX, Settings.SizeY, Settings.NumberOfMonsters, Settings.MonsterPathLength,
+					GetMetricName((EMazeMetric::Type)Metric), Bucket * Histogram.GetBucketWidth(), Buckets[Bucket]);
+			}
+		}
+	}
+
+	return FFileHelper::SaveStringToFile(Lines, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeLayout.h"
+
+/**
+* Difficulty metrics of a maze layout, computed in linear time: one walk of the distances from the start, one pass over the cells,
+* and the patrol paths walked up the tree of the distances
+*/
+struct TGWLIHE_API FMazeAnalysis
+{
+public:
+	FMazeAnalysis();
+
+	// Computes every metric of the layout
+	void Analyze(const FMazeLayout& Layout);
+
+public:
+	// Number of cells from the start to the end, the start and the end included, -1 if the end cannot be reached
+	int32 SolutionLength;
+
+	// Number of cells with only one passage
+	int32 DeadEnds;
+
+	// Number of cells with three passages or more
+	int32 Junctions;
+
+	// Ways on from a cell entered by one of its passages, averaged over the cells which are not dead ends
+	float BranchingFactor;
+
+	// Passages between two cells which are not in the middle of a corridor (dead ends, junctions), averaged over the corridors
+	float AverageCorridorLength;
+
+	// Cell the farthest from the start along the passages, and its distance
+	FIntVector FarthestCell;
+	int32 FarthestDistance;
+
+	// Part of the cells on a patrol path, from 0 to 1
+	float PatrolCoverage;
+
+	// Part of the cells of the solution on a patrol path, from 0 to 1: the monsters the player has to go past
+	float SolutionPatrolCoverage;
+};
+
+/**
+* Metrics of the batch analysis, one histogram each
+*/
+namespace EMazeMetric
+{
+	enum Type : uint8
+	{
+		SolutionLength,
+		DeadEnds,
+		BranchingFactor,
+		AverageCorridorLength,
+		FarthestDistance,
+		PatrolCoverage,
+		SolutionPatrolCoverage,
+		Count
+	};
+}
+
+/**
+* Histogram of a metric, with buckets of a fixed width from 0, grown as values come
+*/
+class TGWLIHE_API FMazeHistogram
+{
+public:
+	explicit FMazeHistogram(float InBucketWidth = 1.0f);
+
+	// Counts a value, the negative ones in the first bucket
+	void Add(float Value);
+
+	// Adds the values of another histogram of the same bucket width
+	void Merge(const FMazeHistogram& Other);
+
+	// Number of values counted
+	int64 Num() const { return ValueCount; }
+
+	float GetMin() const { return ValueCount > 0 ? MinValue : 0.0f; }
+	float GetMax() const { return ValueCount > 0 ? MaxValue : 0.0f; }
+	float GetMean() const { return ValueCount > 0 ? (float)(Sum / ValueCount) : 0.0f; }
+
+	// Start of the bucket holding the given fraction of the values, 0.5 for the median, within a bucket width
+	float GetPercentile(float Fraction) const;
+
+	float GetBucketWidth() const { return BucketWidth; }
+	const TArray<int64>& GetBuckets() const { return Buckets; }
+
+private:
+	float BucketWidth;
+	TArray<int64> Buckets;
+	int64 ValueCount;
+	double Sum;
+	float MinValue;
+	float MaxValue;
+};
+
+/**
+* Settings of a batch of mazes planned with the same parameters, each from its own seed
+*/
+struct FMazeBatchSettings
+{
+	int32 SizeX;
+	int32 SizeY;
+	int32 NumberOfMonsters;
+	int32 MonsterPathLength;
+
+	// Whether or not the start and the end are placed the farthest apart, see FMazeLayout::Plan
+	bool PlaceStartEndFarthest;
+
+	// Number of mazes, and seed of the batch the seeds of the mazes are hashed from
+	int32 Count;
+	int32 Seed;
+
+	FMazeBatchSettings()
+		: SizeX(10), SizeY(10), NumberOfMonsters(0), MonsterPathLength(0), PlaceStartEndFarthest(false), Count(0), Seed(0)
+	{
+	}
+};
+
+/**
+* Plans and analyzes a batch of mazes on every core with ParallelFor, into one histogram per metric
+* The seed of a maze only depends on the seed of the batch and on its index, the histograms are the same whatever the number of threads
+*/
+class TGWLIHE_API FMazeBatchAnalysis
+{
+public:
+	FMazeBatchAnalysis();
+
+	// Plans and analyzes the mazes of the batch, replacing the previous results
+	void Run(const FMazeBatchSettings& InSettings);
+
+	const FMazeHistogram& GetHistogram(EMazeMetric::Type Metric) const { return Histograms[Metric]; }
+
+	// Name of a metric, for the logs and the files
+	static const TCHAR* GetMetricName(EMazeMetric::Type Metric);
+
+	// Logs the mean, the percentiles and the extremes of every metric
+	void LogSummary() const;
+
+	// Appends the buckets of every histogram to a CSV file, one line per bucket, returns false if it cannot be written
+	bool AppendToCSV(const FString& Filename, const FString& BatchName) const;
+
+	// Seed of a maze of a batch
+	static int32 GetMazeSeed(int32 BatchSeed, int32 Index);
+
+private:
+	// Empty histogram of a metric, its buckets as wide as a unit of the metric
+	static FMazeHistogram MakeHistogram(EMazeMetric::Type Metric);
+
+	// Adds the metrics of a maze to a set of histograms
+	static void AddAnalysis(const FMazeAnalysis& Analysis, FMazeHistogram* OutHistograms);
+
+	FMazeBatchSettings Settings;
+	FMazeHistogram Histograms[EMazeMetric::Count];
+
+	// Mazes whose end cannot be reached, left out of the histograms
+	int32 UnsolvableCount;
+
+	// Duration of the last run, in seconds
+	double RunSeconds;
+
+	// Number of mazes a task of ParallelFor plans and analyzes, so that a task is worth scheduling
+	static const int32 MazesPerTask = 256;
+};
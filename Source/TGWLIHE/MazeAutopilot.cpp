@@ -0,0 +1,293 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeAutopilot.h"
+#include "Maze.h"
+#include "AmazeingCharacter.h"
+#include "AmazeingGameMode.h"
+#include "EndTriggerVolume.h"
+#include "MazeTickCosts.h"
+#include "MazeDirections.h"
+#include "Engine/World.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformMisc.h"
+#include "UObject/UObjectArray.h"
+
+// Sets default values
+AMazeAutopilot::AMazeAutopilot()
+{
+	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	WalkSpeed = 2000.0f;
+	CyclesToRun = 0;
+	WarmUpCycles = 2;
+	ObjectGrowthTolerance = 500;
+	ActorGrowthTolerance = 10;
+	MemoryGrowthToleranceMB = 64;
+	GrowingCyclesTolerance = 10;
+
+	Maze = nullptr;
+	Character = nullptr;
+	GameMode = nullptr;
+	NextWaypoint = 0;
+	PlannedFloor = 0;
+	IsWalking = false;
+	LevelsFinished = 0;
+	CyclesFinished = 0;
+	IsSamplePending = false;
+	GrowingCycles = 0;
+	LeakCount = 0;
+	StartTime = 0.0;
+}
+
+bool AMazeAutopilot::IsRequested()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("MazeAutopilot"));
+}
+
+void AMazeAutopilot::Initialize(AMaze* InMaze, AAmazeingCharacter* InCharacter, AAmazeingGameMode* InGameMode)
+{
+	Maze = InMaze;
+	Character = InCharacter;
+	GameMode = InGameMode;
+	StartTime = FPlatformTime::Seconds();
+
+	// Options of the soak test
+	FParse::Value(FCommandLine::Get(), TEXT("AutopilotCycles="), CyclesToRun);
+	FParse::Value(FCommandLine::Get(), TEXT("AutopilotSpeed="), WalkSpeed);
+	FParse::Value(FCommandLine::Get(), TEXT("AutopilotWarmUp="), WarmUpCycles);
+
+	// The character is moved only when the player could move it
+	GameMode->OnFadeInFinished().AddUFunction(this, FName("StartWalking"));
+	GameMode->OnMonsterKillFadeInFinished().AddUFunction(this, FName("StartWalking"));
+	Maze->OnMonsterKill().AddUFunction(this, FName("StopWalking"));
+	Maze->EndTriggerVolume->OnFadeOutLaunched().AddUFunction(this, FName("OnLevelFinished"));
+
+	UE_LOG(LogTemp, Warning, TEXT("Maze autopilot: %d cycles, speed %.0f, %d warm up cycles"), CyclesToRun, WalkSpeed, WarmUpCycles);
+}
+
+void AMazeAutopilot::Tick(float DeltaSeconds)
+{
+	MAZE_TICK_COST_SCOPE();
+
+	Super::Tick(DeltaSeconds);
+
+	if (!IsWalking || Character == nullptr)
+	{
+		return;
+	}
+
+	// Through the border of a region or up the stairs, the path goes on from there
+	if (NextWaypoint >= Waypoints.Num() || (Maze->HasFloors() && Maze->GetCurrentFloor() != PlannedFloor))
+	{
+		PlanPath();
+		if (NextWaypoint >= Waypoints.Num())
+		{
+			return;
+		}
+	}
+
+	// Straight to the next waypoint, the path follows the passages so no wall is crossed
+	FVector Location = Character->GetActorLocation();
+	FVector Target = Waypoints[NextWaypoint];
+	Target.Z = Location.Z;
+	FVector ToTarget = Target - Location;
+	float Step = WalkSpeed * DeltaSeconds;
+	if (ToTarget.Size() <= Step)
+	{
+		Character->SetActorLocation(Target);
+		NextWaypoint += 1;
+	}
+	else
+	{
+		Character->SetActorLocation(Location + ToTarget.GetSafeNormal() * Step);
+	}
+}
+
+void AMazeAutopilot::StartWalking()
+{
+	// The previous cycle is finished and the garbage has been collected since: the counts can be compared
+	if (IsSamplePending)
+	{
+		IsSamplePending = false;
+		SampleCycle();
+	}
+
+	PlanPath();
+	IsWalking = true;
+}
+
+void AMazeAutopilot::StopWalking()
+{
+	IsWalking = false;
+}
+
+void AMazeAutopilot::OnLevelFinished(bool IsDeathKill)
+{
+	IsWalking = false;
+	LevelsFinished += 1;
+
+	// The game restarts after the last level
+	if (Maze->IsPlayingLastLevel() && !IsDeathKill)
+	{
+		CyclesFinished += 1;
+		IsSamplePending = true;
+		GetWorld()->ForceGarbageCollection(true);
+	}
+}
+
+void AMazeAutopilot::PlanPath()
+{
+	Waypoints.Reset();
+	NextWaypoint = 0;
+
+	// The last level is a blueprint, not a generated maze: it has no layout and leads straight to the end trigger
+	FVector EndLocation = Maze->EndTriggerVolume->GetActorLocation();
+	PlannedFloor = Maze->GetCurrentFloor();
+	FTransform LayoutTransform;
+	const FMazeLayout* Layout = Maze->GetLayoutAt(Character->GetActorLocation(), LayoutTransform);
+	if (Layout == nullptr)
+	{
+		Waypoints.Add(EndLocation);
+		return;
+	}
+
+	// The path is planned on the layout the character is in, to the end if it is there: on a multi-floor level, the end is on the last floor only
+	FIntVector From = Layout->GetCellCoordinates(LayoutTransform.InverseTransformPosition(Character->GetActorLocation()));
+	FIntVector To = Layout->GetCellCoordinates(LayoutTransform.InverseTransformPosition(EndLocation));
+	TArray<FIntVector> StairsUp;
+	Maze->GetStairsUp(StairsUp);
+	bool IsEndReachable = Layout->ContainsCoordinates(To) && StairsUp.Num() == 0;
+	FIntVector Step = FIntVector::ZeroValue;
+	if (!IsEndReachable)
+	{
+		TArray<int32> Distances;
+		Layout->ComputeDistances(From, Distances);
+		int32 BestDistance = MAX_int32;
+		if (StairsUp.Num() > 0)
+		{
+			// Below the last floor, to the nearest stairs going up, which take the character to the next floor
+			for (const FIntVector& Stairs : StairsUp)
+			{
+				int32 Distance = Distances[Layout->ToIndex(Stairs)];
+				if (Distance >= 0 && Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					To = Stairs;
+				}
+			}
+		}
+		else if (Maze->IsUnbounded())
+		{
+			// Otherwise, to the nearest opening of the border toward the region of the exit, then one step beyond it
+			FIntVector ToExit = Maze->GetRegionAt(EndLocation) - Maze->GetRegionAt(Character->GetActorLocation());
+			EMazeDirection Direction = FMath::Abs(ToExit.X) >= FMath::Abs(ToExit.Y) ? (ToExit.X > 0 ? EMazeDirection::West : EMazeDirection::East) : (ToExit.Y > 0 ? EMazeDirection::North : EMazeDirection::South);
+			Step = UMazeDirections::ToIntVector(Direction);
+			for (int32 Index = 0; Index < Layout->Num(); Index++)
+			{
+				if (Distances[Index] >= 0 && Distances[Index] < BestDistance && Layout->HasBorderOpening(Layout->ToCoordinates(Index), Direction))
+				{
+					BestDistance = Distances[Index];
+					To = Layout->ToCoordinates(Index);
+				}
+			}
+		}
+	}
+
+	TArray<FIntVector> Path;
+	if (Layout->ContainsCoordinates(To) && Layout->FindPath(From, To, Path))
+	{
+		for (const FIntVector& Coordinates : Path)
+		{
+			Waypoints.Add(LayoutTransform.TransformPosition(Layout->GetCellRelativeLocation(Coordinates)));
+		}
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Maze autopilot: no path from (%d, %d) to (%d, %d)"), From.X, From.Y, To.X, To.Y);
+		return;
+	}
+
+	if (IsEndReachable)
+	{
+		Waypoints.Add(EndLocation);
+	}
+	else if (Step != FIntVector::ZeroValue)
+	{
+		Waypoints.Add(LayoutTransform.TransformPosition(Layout->GetCellRelativeLocation(To + Step)));
+	}
+}
+
+void AMazeAutopilot::SampleCycle()
+{
+	FMazeAutopilotSample Sample;
+	Sample.Cycle = CyclesFinished;
+	Sample.Seconds = FPlatformTime::Seconds() - StartTime;
+	Sample.UsedPhysicalMB = (int64)(FPlatformMemory::GetStats().UsedPhysical / (1024 * 1024));
+	Sample.Objects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	Sample.Actors = GetWorld()->GetActorCount();
+	Sample.MazeCells = Maze->Cells.Num();
+
+	// One line per cycle, to plot the long sessions
+	FString Filename = FPaths::ProfilingDir() / TEXT("MazeAutopilot.csv");
+	if (CyclesFinished == 1)
+	{
+		FFileHelper::SaveStringToFile(TEXT("Cycle,Seconds,UsedPhysicalMB,Objects,Actors,MazeCells\n"), *Filename);
+	}
+	FFileHelper::SaveStringToFile(FString::Printf(TEXT("%d,%.1f,%lld,%d,%d,%d\n"), Sample.Cycle, Sample.Seconds, Sample.UsedPhysicalMB, Sample.Objects, Sample.Actors, Sample.MazeCells), *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogTemp, Warning, TEXT("Maze autopilot cycle %d (%d levels, %.0f s): %lld MB, %d objects, %d actors, %d maze columns"), Sample.Cycle, LevelsFinished, Sample.Seconds, Sample.UsedPhysicalMB, Sample.Objects, Sample.Actors, Sample.MazeCells);
+
+	// The first level of the cycle is being played, so the maze has exactly one column per X
+	bool IsLeaking = false;
+	if (Sample.MazeCells > Maze->GetLayout().Size.X)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Maze autopilot: leak, AMaze::Cells has %d columns for a maze of %d"), Sample.MazeCells, Maze->GetLayout().Size.X);
+		IsLeaking = true;
+	}
+
+	// The baseline is taken once the warm up cycles are played, the next samples are compared with it
+	if (CyclesFinished >= WarmUpCycles)
+	{
+		if (Samples.Num() > 0)
+		{
+			const FMazeAutopilotSample& Baseline = Samples[0];
+			if (Sample.Objects - Baseline.Objects > ObjectGrowthTolerance || Sample.Actors - Baseline.Actors > ActorGrowthTolerance || Sample.UsedPhysicalMB - Baseline.UsedPhysicalMB > MemoryGrowthToleranceMB)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Maze autopilot: leak since the baseline, %+d objects, %+d actors, %+lld MB"), Sample.Objects - Baseline.Objects, Sample.Actors - Baseline.Actors, Sample.UsedPhysicalMB - Baseline.UsedPhysicalMB);
+				IsLeaking = true;
+			}
+
+			// A slow leak stays below the tolerances for a long time, but never stops growing
+			GrowingCycles = Sample.Objects > Samples.Last().Objects ? GrowingCycles + 1 : 0;
+			if (GrowingCycles >= GrowingCyclesTolerance)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Maze autopilot: leak, the object count has grown for %d cycles in a row"), GrowingCycles);
+				IsLeaking = true;
+			}
+		}
+		Samples.Add(Sample);
+	}
+
+	if (IsLeaking)
+	{
+		LeakCount += 1;
+	}
+
+	if (CyclesToRun > 0 && CyclesFinished >= CyclesToRun)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void AMazeAutopilot::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UE_LOG(LogTemp, Warning, TEXT("Maze autopilot finished: %d cycles, %d levels in %.0f s, leaks flagged after %d cycles"), CyclesFinished, LevelsFinished, FPlatformTime::Seconds() - StartTime, LeakCount);
+
+	Super::EndPlay(EndPlayReason);
+}
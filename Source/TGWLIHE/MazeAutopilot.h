@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "MazeAutopilot.generated.h"
+
+/**
+* Memory and object counts sampled after each cycle of the game (every level, the last one, then the restart)
+*/
+struct FMazeAutopilotSample
+{
+	int32 Cycle;
+	double Seconds;
+	int64 UsedPhysicalMB;
+	int32 Objects;
+	int32 Actors;
+	int32 MazeCells;
+};
+
+/**
+* Soak test: plays the game by itself, walking the solution of every level to the end trigger, again and again
+* Spawned by the game mode with -MazeAutopilot, for instance headless with a fixed time step so that the transitions do not wait:
+* UE4Editor TGWLIHE.uproject -game -nullrhi -nosound -unattended -benchmark -fps=30 -MazeAutopilot -AutopilotCycles=1000
+* After each cycle, the memory and object counts are compared with the first cycles to flag leaks
+*/
+UCLASS(NotPlaceable)
+class TGWLIHE_API AMazeAutopilot : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AMazeAutopilot();
+
+	// Whether or not the autopilot has been asked for on the command line
+	static bool IsRequested();
+
+	// Subscribes to the level events, and reads the options of the command line
+	void Initialize(class AMaze* InMaze, class AAmazeingCharacter* InCharacter, class AAmazeingGameMode* InGameMode);
+
+protected:
+	// Called every frame, used here to walk the path
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Logs the summary of the soak test
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// The character can move: the path is planned from where it is, then walked
+	UFUNCTION()
+		void StartWalking();
+
+	// The character has been touched by a Monster, it will be moved back to the start
+	UFUNCTION()
+		void StopWalking();
+
+	// The end trigger has been reached, or Death killed the character
+	UFUNCTION()
+		void OnLevelFinished(bool IsDeathKill);
+
+	// Computes the waypoints from the character location to the end trigger, along the passages of the layout the character is in
+	// When the end is not in it, the waypoints stop beyond the border toward the region of the exit, or in the stairs going up, and the next ones are planned from there
+	void PlanPath();
+
+	// Samples the memory and object counts after a cycle, and compares them with the baseline
+	void SampleCycle();
+
+public:
+	// Speed of the character, in units per second
+	UPROPERTY(EditAnywhere)
+		float WalkSpeed;
+
+	// Number of cycles to play before quitting, 0 to play until stopped
+	UPROPERTY(EditAnywhere)
+		int32 CyclesToRun;
+
+	// Number of cycles played before the baseline is sampled, so that caches and pools are warm
+	UPROPERTY(EditAnywhere)
+		int32 WarmUpCycles;
+
+	// Growth from the baseline above which a leak is flagged
+	UPROPERTY(EditAnywhere)
+		int32 ObjectGrowthTolerance;
+
+	UPROPERTY(EditAnywhere)
+		int32 ActorGrowthTolerance;
+
+	UPROPERTY(EditAnywhere)
+		int32 MemoryGrowthToleranceMB;
+
+	// Number of consecutive cycles with more objects than the previous one, flagged as a slow leak
+	UPROPERTY(EditAnywhere)
+		int32 GrowingCyclesTolerance;
+
+private:
+	UPROPERTY()
+		class AMaze* Maze;
+
+	UPROPERTY()
+		class AAmazeingCharacter* Character;
+
+	UPROPERTY()
+		class AAmazeingGameMode* GameMode;
+
+	// Locations to walk through, the end trigger last
+	TArray<FVector> Waypoints;
+
+	// Index of the waypoint being walked to
+	int32 NextWaypoint;
+
+	// Floor the path has been planned on, for a multi-floor level
+	int32 PlannedFloor;
+
+	// Whether or not the character is being moved
+	bool IsWalking;
+
+	// Number of levels and cycles finished
+	int32 LevelsFinished;
+	int32 CyclesFinished;
+
+	// Set when a cycle is finished, the sample is taken once the next one has started and the garbage has been collected
+	bool IsSamplePending;
+
+	// Samples of every cycle, the baseline first
+	TArray<FMazeAutopilotSample> Samples;
+
+	// Number of consecutive cycles with more objects than the previous one
+	int32 GrowingCycles;
+
+	// Number of cycles after which a leak has been flagged
+	int32 LeakCount;
+
+	// When the soak test started
+	double StartTime;
+};
@@ -0,0 +1,268 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeBitboard.h"
+#include "MazeDirections.h"
+#include "Containers/BitArray.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bitboard flood fill"), STAT_MazeBitboardFloodFill, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Bitboard cells within"), STAT_MazeBitboardCellsWithin, STATGROUP_Maze);
+
+FMazeCellSet::FMazeCellSet()
+	: Origin(0, 0, 0)
+	, RowCount(0)
+	, WordsPerRow(0)
+{
+}
+
+void FMazeCellSet::Init(FIntVector InOrigin, FIntVector InSize)
+{
+	Origin = FIntVector(InOrigin.X, InOrigin.Y & ~63, 0);
+	RowCount = InSize.X;
+	WordsPerRow = FMath::DivideAndRoundUp(InOrigin.Y + InSize.Y - Origin.Y, 64);
+	Words.Init(0, RowCount * WordsPerRow);
+}
+
+int32 FMazeCellSet::Num() const
+{
+	int32 Count = 0;
+	for (uint64 Word : Words)
+	{
+		Count += FMath::CountBits(Word);
+	}
+	return Count;
+}
+
+void FMazeCellSet::Reset()
+{
+	FMemory::Memzero(Words.GetData(), Words.Num() * sizeof(uint64));
+}
+
+FMazeBitboard::FMazeBitboard()
+	: Size(0, 0, 0)
+	, WordsPerRow(0)
+{
+}
+
+void FMazeBitboard::Build(const FMazeLayout& Layout)
+{
+	Size = Layout.Size;
+	WordsPerRow = FMath::DivideAndRoundUp(Size.Y, 64);
+	YPassages.Init(0, Size.X * WordsPerRow);
+	XPassages.Init(0, Size.X * WordsPerRow);
+
+	// Every passage once, from the cell with the lower coordinates: North is toward +Y, West toward +X
+	for (int32 Index = 0; Index < Layout.Num(); Index++)
+	{
+		const FIntVector Cell = Layout.ToCoordinates(Index);
+		const int32 Word = Cell.X * WordsPerRow + (Cell.Y >> 6);
+		const uint64 Bit = 1ull << (Cell.Y & 63);
+		if (Cell.Y + 1 < Size.Y && Layout.HasPassage(Cell, EMazeDirection::North))
+		{
+			YPassages[Word] |= Bit;
+		}
+		if (Cell.X + 1 < Size.X && Layout.HasPassage(Cell, EMazeDirection::West))
+		{
+			XPassages[Word] |= Bit;
+		}
+	}
+}
+
+void FMazeBitboard::FillRow(uint64* Row, int32 X) const
+{
+	const uint64* Passages = &YPassages[X * WordsPerRow];
+
+	// Toward +Y, the cells entered from the one below: Kogge-Stone fill, doubling the reach at every shift, the top bit carried to the next word
+	uint64 Carry = 0;
+	for (int32 w = 0; w < WordsPerRow; w++)
+	{
+		uint64 Enter = (Passages[w] << 1) | (w > 0 ? Passages[w - 1] >> 63 : 0);
+		uint64 Fill = Row[w] | (Carry & Enter & 1);
+		Fill |= Enter & (Fill << 1); Enter &= Enter << 1;
+		Fill |= Enter & (Fill << 2); Enter &= Enter << 2;
+		Fill |= Enter & (Fill << 4); Enter &= Enter << 4;
+		Fill |= Enter & (Fill << 8); Enter &= Enter << 8;
+		Fill |= Enter & (Fill << 16); Enter &= Enter << 16;
+		Fill |= Enter & (Fill << 32);
+		Carry = Fill >> 63;
+		Row[w] = Fill;
+	}
+
+	// Then toward -Y, the cells entered from the one above, the bottom bit carried to the previous word
+	Carry = 0;
+	for (int32 w = WordsPerRow - 1; w >= 0; w--)
+	{
+		uint64 Enter = Passages[w];
+		uint64 Fill = Row[w] | ((Carry & (Enter >> 63)) << 63);
+		Fill |= Enter & (Fill >> 1); Enter &= Enter >> 1;
+		Fill |= Enter & (Fill >> 2); Enter &= Enter >> 2;
+		Fill |= Enter & (Fill >> 4); Enter &= Enter >> 4;
+		Fill |= Enter & (Fill >> 8); Enter &= Enter >> 8;
+		Fill |= Enter & (Fill >> 16); Enter &= Enter >> 16;
+		Fill |= Enter & (Fill >> 32);
+		Carry = Fill & 1;
+		Row[w] = Fill;
+	}
+}
+
+void FMazeBitboard::Expand(FMazeCellSet& Cells) const
+{
+	// The words of the set are the ones of the passages from its first word
+	const int32 MinX = Cells.GetFirstRow();
+	const int32 MaxX = FMath::Min(MinX + Cells.GetRowCount(), Size.X) - 1;
+	const int32 MinWord = Cells.GetFirstWord();
+	const int32 MaxWord = FMath::Min(MinWord + Cells.GetWordsPerRow(), WordsPerRow) - 1;
+	if (MinX > MaxX || MinWord > MaxWord)
+	{
+		return;
+	}
+
+	// A step reads the neighbor rows as they were before it: the row below is kept aside before it is stepped, the row above is not stepped yet
+	TArray<uint64, TInlineAllocator<16>> RowBelow;
+	RowBelow.SetNumZeroed(MaxWord - MinWord + 1);
+	for (int32 X = MinX; X <= MaxX; X++)
+	{
+		uint64* Row = Cells.GetRow(X) - MinWord;
+		const uint64* RowAbove = X < MaxX ? Cells.GetRow(X + 1) - MinWord : nullptr;
+		const uint64* RowYPassages = &YPassages[X * WordsPerRow];
+		const uint64* RowXPassages = &XPassages[X * WordsPerRow];
+		const uint64* BelowXPassages = X > MinX ? &XPassages[(X - 1) * WordsPerRow] : nullptr;
+
+		uint64 PreviousWord = 0;
+		for (int32 w = MinWord; w <= MaxWord; w++)
+		{
+			const uint64 Word = Row[w];
+			const uint64 Up = ((Word & RowYPassages[w]) << 1) | (w > MinWord ? (PreviousWord & RowYPassages[w - 1]) >> 63 : 0);
+			const uint64 Down = ((Word >> 1) | (w < MaxWord ? Row[w + 1] << 63 : 0)) & RowYPassages[w];
+			const uint64 FromBelow = BelowXPassages ? RowBelow[w - MinWord] & BelowXPassages[w] : 0;
+			const uint64 FromAbove = RowAbove ? RowAbove[w] & RowXPassages[w] : 0;
+			RowBelow[w - MinWord] = Word;
+			Row[w] = Word | Up | Down | FromBelow | FromAbove;
+			PreviousWord = Word;
+		}
+	}
+}
+
+void FMazeBitboard::GetCellsWithin(FIntVector From, int32 MaxDistance, FMazeCellSet& OutCells) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeBitboardCellsWithin);
+
+	if (From.X < 0 || From.X >= Size.X || From.Y < 0 || From.Y >= Size.Y || MaxDistance < 0)
+	{
+		OutCells.Init(FIntVector::ZeroValue);
+		return;
+	}
+
+	// Only the rows and the columns MaxDistance cells around the cell can be reached
+	const FIntVector Min(FMath::Max(From.X - MaxDistance, 0), FMath::Max(From.Y - MaxDistance, 0), 0);
+	const FIntVector Max(FMath::Min(From.X + MaxDistance, Size.X - 1), FMath::Min(From.Y + MaxDistance, Size.Y - 1), 0);
+	OutCells.Init(Min, Max - Min + FIntVector(1, 1, 0));
+	OutCells.Add(From);
+	for (int32 Step = 0; Step < MaxDistance; Step++)
+	{
+		Expand(OutCells);
+	}
+}
+
+void FMazeBitboard::FloodFill(FMazeCellSet& Cells) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeBitboardFloodFill);
+
+	if (Cells.GetFirstRow() != 0 || Cells.GetFirstWord() != 0 || Cells.GetRowCount() != Size.X || Cells.GetWordsPerRow() != WordsPerRow)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Maze bitboard: the flood fill needs a set of the whole layout"));
+		return;
+	}
+
+	// The rows which gained cells are filled along their corridors, then their cells go through the passages to the rows next to them,
+	// which are filled in turn if they gained cells: a row is only filled again when it changes
+	TArray<int32> PendingRows;
+	TBitArray<> IsPending(false, Size.X);
+	for (int32 X = 0; X < Size.X; X++)
+	{
+		const uint64* Row = Cells.GetRow(X);
+		for (int32 w = 0; w < WordsPerRow; w++)
+		{
+			if (Row[w] != 0)
+			{
+				PendingRows.Add(X);
+				IsPending[X] = true;
+				break;
+			}
+		}
+	}
+
+	while (PendingRows.Num() > 0)
+	{
+		const int32 X = PendingRows.Pop(false);
+		IsPending[X] = false;
+
+		uint64* Row = Cells.GetRow(X);
+		FillRow(Row, X);
+
+		for (int32 Side = 0; Side < 2; Side++)
+		{
+			// The passages between X and X - 1 are the X passages of X - 1, the ones between X and X + 1 the X passages of X
+			const int32 OtherX = Side == 0 ? X - 1 : X + 1;
+			if (OtherX < 0 || OtherX >= Size.X)
+			{
+				continue;
+			}
+
+			uint64* OtherRow = Cells.GetRow(OtherX);
+			const uint64* Passages = &XPassages[FMath::Min(X, OtherX) * WordsPerRow];
+			bool IsAdded = false;
+			for (int32 w = 0; w < WordsPerRow; w++)
+			{
+				const uint64 Added = Row[w] & Passages[w] & ~OtherRow[w];
+				OtherRow[w] |= Added;
+				IsAdded |= Added != 0;
+			}
+
+			if (IsAdded && !IsPending[OtherX])
+			{
+				PendingRows.Add(OtherX);
+				IsPending[OtherX] = true;
+			}
+		}
+	}
+}
+
+bool FMazeBitboard::IsReachable(FIntVector From, FIntVector To) const
+{
+	if (From.X < 0 || From.X >= Size.X || From.Y < 0 || From.Y >= Size.Y || To.X < 0 || To.X >= Size.X || To.Y < 0 || To.Y >= Size.Y)
+	{
+		return false;
+	}
+
+	FMazeCellSet Cells;
+	Cells.Init(Size);
+	Cells.Add(From);
+	FloodFill(Cells);
+	return Cells.Contains(To);
+}
+
+void FMazeBitboard::GetVisibleCells(FIntVector From, FMazeCellSet& OutCells) const
+{
+	OutCells.Init(Size);
+	if (From.X < 0 || From.X >= Size.X || From.Y < 0 || From.Y >= Size.Y)
+	{
+		return;
+	}
+
+	// Along Y, the corridor run through the cell is a fill of its row
+	OutCells.Add(From);
+	FillRow(OutCells.GetRow(From.X), From.X);
+
+	// Along X, the run crosses a row per cell: one bit test each
+	const int32 Word = From.Y >> 6;
+	const uint64 Bit = 1ull << (From.Y & 63);
+	for (int32 X = From.X; X + 1 < Size.X && (XPassages[X * WordsPerRow + Word] & Bit); X++)
+	{
+		OutCells.Add(FIntVector(X + 1, From.Y, 0));
+	}
+	for (int32 X = From.X; X > 0 && (XPassages[(X - 1) * WordsPerRow + Word] & Bit); X--)
+	{
+		OutCells.Add(FIntVector(X - 1, From.Y, 0));
+	}
+}
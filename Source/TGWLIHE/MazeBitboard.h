@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeLayout.h"
+
+/**
+* Set of cells of a window of a layout, one bit per cell: a row of bits for every X, Y being the bit index in the row, 64 cells per word
+* The window starts on a word, so that its words line up with the ones of the bitboard; the whole layout by default
+*/
+class TGWLIHE_API FMazeCellSet
+{
+public:
+	FMazeCellSet();
+
+	// Empties the set, for the whole grid of the given size
+	void Init(FIntVector InSize) { Init(FIntVector::ZeroValue, InSize); }
+
+	// Empties the set, for the cells from Origin, of the given size, Origin.Y being rounded down to a word
+	void Init(FIntVector InOrigin, FIntVector InSize);
+
+	// Adds a cell of the window
+	void Add(FIntVector Cell)
+	{
+		checkSlow(IsInWindow(Cell));
+		Words[GetWordIndex(Cell)] |= 1ull << (Cell.Y & 63);
+	}
+
+	// Whether or not the cell is in the set, false out of the window
+	bool Contains(FIntVector Cell) const { return IsInWindow(Cell) && (Words[GetWordIndex(Cell)] & (1ull << (Cell.Y & 63))) != 0; }
+
+	// Number of cells in the set
+	int32 Num() const;
+
+	// Removes every cell, the window stays the same
+	void Reset();
+
+	bool operator==(const FMazeCellSet& Other) const { return Origin == Other.Origin && RowCount == Other.RowCount && Words == Other.Words; }
+
+	// Rows of the window, from the row of Origin.X
+	int32 GetFirstRow() const { return Origin.X; }
+	int32 GetRowCount() const { return RowCount; }
+
+	// Words of a row of the window, from the word of Origin.Y
+	int32 GetFirstWord() const { return Origin.Y >> 6; }
+	int32 GetWordsPerRow() const { return WordsPerRow; }
+
+	// Words of the row of the given X, in the window
+	uint64* GetRow(int32 X) { return &Words[(X - Origin.X) * WordsPerRow]; }
+	const uint64* GetRow(int32 X) const { return &Words[(X - Origin.X) * WordsPerRow]; }
+
+private:
+	bool IsInWindow(FIntVector Cell) const { return Cell.X >= Origin.X && Cell.X < Origin.X + RowCount && Cell.Y >= Origin.Y && Cell.Y < Origin.Y + WordsPerRow * 64; }
+
+	int32 GetWordIndex(FIntVector Cell) const { return (Cell.X - Origin.X) * WordsPerRow + ((Cell.Y - Origin.Y) >> 6); }
+
+	FIntVector Origin;
+	int32 RowCount;
+	int32 WordsPerRow;
+	TArray<uint64> Words;
+};
+
+/**
+* Passages of a layout packed as bits, for the queries over many cells at once: every operation works on 64 cells of a row per word
+* instead of one cell at a time. A fill along a row goes through a whole corridor in a few shifts, a step across rows is an AND of two rows
+*/
+class TGWLIHE_API FMazeBitboard
+{
+public:
+	FMazeBitboard();
+
+	// Packs the passages of the layout, the passages out of it are left out
+	void Build(const FMazeLayout& Layout);
+
+	FIntVector GetSize() const { return Size; }
+
+	// Adds the cells one step away from the cells of the set along the passages, within the window of the set
+	void Expand(FMazeCellSet& Cells) const;
+
+	// Gives the cells at most MaxDistance cells away from a cell along the passages, as FMazeLayout::GetCellsWithin without the distances
+	// The set only covers the cells MaxDistance away, so that its cost does not grow with the layout
+	void GetCellsWithin(FIntVector From, int32 MaxDistance, FMazeCellSet& OutCells) const;
+
+	// Adds every cell which can be reached from the cells of the set, a set of the whole layout
+	void FloodFill(FMazeCellSet& Cells) const;
+
+	// Whether or not a cell can be reached from the other one
+	bool IsReachable(FIntVector From, FIntVector To) const;
+
+	// Gives the cells seen from a cell, as FMazeLayout::IsInSight: the corridor runs through the cell along its row and its column
+	void GetVisibleCells(FIntVector From, FMazeCellSet& OutCells) const;
+
+private:
+	// Fills the cells of a row of a set of the whole layout along its corridors, both ways
+	void FillRow(uint64* Row, int32 X) const;
+
+	// Size of the layout
+	FIntVector Size;
+
+	// Words of a row
+	int32 WordsPerRow;
+
+	// Bit Y of row X set if there is a passage from (X, Y) to (X, Y + 1)
+	TArray<uint64> YPassages;
+
+	// Bit Y of row X set if there is a passage from (X, Y) to (X + 1, Y)
+	TArray<uint64> XPassages;
+};
@@ -4,13 +4,17 @@
 #include "Maze.h"
 #include "EngineUtils.h"
 #include "MazeCellEdge.h"
+#include "MazeStats.h"
 
 
 // Sets default values
 AMazeCell::AMazeCell()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// A cell never ticks, there can be thousands of them
 	PrimaryActorTick.bCanEverTick = false;
+
+	// Every edge at the "nullptr" value, set in the constructor so that the edges can be set before the cell begins to play
+	Edges.Init(nullptr, UMazeDirections::Count);
 }
 
 // Called when the game starts or when spawned
@@ -18,21 +22,14 @@ void AMazeCell::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// First, we initialize the size of the array
-	Edges.AddZeroed(UMazeDirections::Count);
-	// Then, we give every element the "nullptr" value
-	for (int i = 0; i < UMazeDirections::Count; i++)
-	{
-		Edges[i] = nullptr;
-	}
-
+	INC_DWORD_STAT(STAT_MazeCells);
 }
 
-// Called every frame
-void AMazeCell::Tick(float DeltaTime)
+void AMazeCell::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	DEC_DWORD_STAT(STAT_MazeCells);
 
+	Super::EndPlay(EndPlayReason);
 }
 
 void AMazeCell::SetCoordinates(FIntVector NewCoordinates)
@@ -90,7 +87,8 @@ TArray<AMazeCellEdge*> AMazeCell::GetPassageEdges()
 	TArray<AMazeCellEdge*> PassageEdges;
 	for (int i = 0; i < Edges.Num(); i++)
 	{
-		if (Edges[i]->GetType() == ECellEdgeType::Passage)
+		// The border cells of an unbounded maze region have no edge toward the regions spawning it
+		if (Edges[i] && Edges[i]->GetType() == ECellEdgeType::Passage)
 		{
 			PassageEdges.Add(Edges[i]);
 		}
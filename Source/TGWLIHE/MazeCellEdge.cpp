@@ -1,12 +1,13 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "MazeCellEdge.h"
+#include "MazeStats.h"
 
 
 // Sets default values
 AMazeCellEdge::AMazeCellEdge()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// An edge never ticks, there can be thousands of them
 	PrimaryActorTick.bCanEverTick = false;
 
 }
@@ -18,11 +19,19 @@ void AMazeCellEdge::BeginPlay()
 
 }
 
-// Called every frame
-void AMazeCellEdge::Tick(float DeltaTime)
+void AMazeCellEdge::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-
+	// Counted by AMaze when created
+	if (Type == ECellEdgeType::Wall)
+	{
+		DEC_DWORD_STAT(STAT_MazeWalls);
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_MazePassages);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AMazeCellEdge::Initialize(AMazeCell* Cell, AMazeCell* OtherCell, EMazeDirection Direction, ECellEdgeType Type)
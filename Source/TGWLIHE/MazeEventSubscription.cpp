@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeEventSubscription.h"
+#include "Maze.h"
+#include "AmazeingCharacter.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+// Subscriptions in place per event, only touched from the game thread
+static TMap<const void*, int32> SubscriptionCounts;
+
+int32 FMazeEventBindings::Num(const void* Event)
+{
+	const int32* Count = SubscriptionCounts.Find(Event);
+	return Count ? *Count : 0;
+}
+
+void FMazeEventBindings::Add(const void* Event)
+{
+	check(IsInGameThread());
+	SubscriptionCounts.FindOrAdd(Event)++;
+}
+
+void FMazeEventBindings::Remove(const void* Event)
+{
+	check(IsInGameThread());
+	int32* Count = SubscriptionCounts.Find(Event);
+	if (ensure(Count && *Count > 0) && --(*Count) == 0)
+	{
+		SubscriptionCounts.Remove(Event);
+	}
+}
+
+void FMazeEventBindings::LogAll(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	// The counts should stay the same from a level to the next, except for the AI Monsters which subscribe while they are alive
+	for (TActorIterator<AMaze> ActorItr(World); ActorItr; ++ActorItr)
+	{
+		AMaze* Maze = *ActorItr;
+		UE_LOG(LogTemp, Warning, TEXT("%s event bindings: TransitionFinished %d, DeathPresent %d, DeathArrival %d, MonsterKill %d, LocationReset %d"), *Maze->GetName(),
+			Num(&Maze->OnTransitionFinished()), Num(&Maze->OnDeathPresent()), Num(&Maze->OnDeathArrival()), Num(&Maze->OnMonsterKill()), Num(&Maze->OnLocationReset()));
+	}
+
+	for (TActorIterator<AAmazeingCharacter> ActorItr(World); ActorItr; ++ActorItr)
+	{
+		AAmazeingCharacter* Character = *ActorItr;
+		UE_LOG(LogTemp, Warning, TEXT("%s event bindings: EyesClosed %d, EyesOpened %d"), *Character->GetName(), Num(&Character->OnEyesClosed()), Num(&Character->OnEyesOpened()));
+	}
+}
+
+static FAutoConsoleCommandWithWorld MazeEventBindingsCommand(
+	TEXT("Maze.EventBindings"),
+	TEXT("Logs the number of bindings of every event of the maze and of the main character"),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&FMazeEventBindings::LogAll));
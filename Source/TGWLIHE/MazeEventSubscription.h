@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+class UWorld;
+
+/**
+* Number of live subscriptions to each event, maintained by TMazeEventSubscription, for debugging
+*/
+struct FMazeEventBindings
+{
+	// Number of subscriptions in place on the event
+	static int32 Num(const void* Event);
+
+	// Logs the number of subscriptions to every event of the maze and of the main character, "Maze.EventBindings" in the console
+	static void LogAll(UWorld* World);
+
+private:
+	template<typename EventType> friend class TMazeEventSubscription;
+
+	// Counts a subscription to the event
+	static void Add(const void* Event);
+
+	// Uncounts a subscription to the event
+	static void Remove(const void* Event);
+};
+
+/**
+* Binding of a UFUNCTION to an event of another object, removed when the subscription is reset or destroyed
+* The owner of the event is held weakly: if it is destroyed first, there is nothing left to remove
+*/
+template<typename EventType>
+class TMazeEventSubscription : public FNoncopyable
+{
+public:
+	TMazeEventSubscription()
+		: Event(nullptr)
+	{
+	}
+
+	~TMazeEventSubscription()
+	{
+		Reset();
+	}
+
+	// Binds the function of the listener to the event of its owner, after removing the previous binding if any
+	void Subscribe(UObject* InEventOwner, EventType& InEvent, UObject* Listener, FName FunctionName)
+	{
+		Reset();
+		EventOwner = InEventOwner;
+		Event = &InEvent;
+		Handle = InEvent.AddUFunction(Listener, FunctionName);
+		FMazeEventBindings::Add(Event);
+	}
+
+	// Removes the binding, if any
+	void Reset()
+	{
+		if (Event)
+		{
+			if (EventOwner.IsValid())
+			{
+				Event->Remove(Handle);
+			}
+			FMazeEventBindings::Remove(Event);
+		}
+		Event = nullptr;
+		EventOwner.Reset();
+		Handle.Reset();
+	}
+
+	// Whether or not the binding is in place
+	bool IsSubscribed() const { return Event != nullptr && EventOwner.IsValid(); }
+
+private:
+	// Object owning the event
+	TWeakObjectPtr<UObject> EventOwner;
+
+	// Event bound to
+	EventType* Event;
+
+	// Handle of the binding, to remove it
+	FDelegateHandle Handle;
+};
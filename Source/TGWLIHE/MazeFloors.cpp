@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeFloors.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Plan floors"), STAT_MazePlanFloors, STATGROUP_Maze);
+
+FMazeFloorPlan::FMazeFloorPlan()
+	: Size(0, 0, 0)
+	, Seed(0)
+	, StartY(0)
+	, EndY(0)
+{
+}
+
+void FMazeFloorPlan::Plan(int32 SizeX, int32 SizeY, int32 FloorCount, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimerValue, int32 RandomSeed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazePlanFloors);
+
+	FRandomStream Stream(RandomSeed);
+	Size = FIntVector(SizeX, SizeY, FloorCount);
+	Seed = RandomSeed;
+	Floors.Reset(FloorCount);
+	Stairs.Reset();
+
+	// Every floor is planned as a level, then only kept packed
+	TArray<FIntVector> ReservedCells;
+	for (int32 Floor = 0; Floor < FloorCount; Floor++)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(SizeX, SizeY, NumberOfMonsters, MonsterPathLength, DeathTimerValue, Stream.GetUnsignedInt());
+		Floors.AddDefaulted();
+		Layout.SaveSnapshot(Floors.Last().Snapshot);
+
+		if (Floor == 0)
+		{
+			StartY = Layout.StartY;
+			ReservedCells.Add(FIntVector(0, StartY, 0));
+		}
+		if (Floor == FloorCount - 1)
+		{
+			EndY = Layout.EndY;
+			ReservedCells.Add(FIntVector(SizeX - 1, EndY, Floor));
+		}
+	}
+
+	// The stairs between two floors are not placed on the start, the end, nor on the stairs of the floor below: a cell leads to one floor at most
+	for (int32 Floor = 0; Floor < FloorCount - 1; Floor++)
+	{
+		for (int32 i = 0; i < StairsPerFloor; i++)
+		{
+			bool IsPlaced = false;
+			for (int32 Try = 0; Try < SizeX * SizeY && !IsPlaced; Try++)
+			{
+				IsPlaced = TryPlaceStairs(FIntVector(Stream.RandRange(0, SizeX - 1), Stream.RandRange(0, SizeY - 1), Floor), ReservedCells);
+			}
+
+			// Unlucky draws on a crowded floor: the first free cell is taken, so that the floors stay linked whatever the seed
+			for (int32 Index = 0; Index < SizeX * SizeY && !IsPlaced; Index++)
+			{
+				IsPlaced = TryPlaceStairs(FIntVector(Index / SizeY, Index % SizeY, Floor), ReservedCells);
+			}
+			ensureMsgf(IsPlaced, TEXT("No room for the stairs between the floors %d and %d of a %dx%d maze"), Floor, Floor + 1, SizeX, SizeY);
+		}
+	}
+}
+
+bool FMazeFloorPlan::TryPlaceStairs(FIntVector Cell, TArray<FIntVector>& ReservedCells)
+{
+	FIntVector UpperCell = Cell + FIntVector(0, 0, 1);
+	if (ReservedCells.Contains(Cell) || ReservedCells.Contains(UpperCell))
+	{
+		return false;
+	}
+
+	Stairs.Add(Cell);
+	ReservedCells.Add(Cell);
+	ReservedCells.Add(UpperCell);
+	return true;
+}
+
+bool FMazeFloorPlan::UnpackFloor(int32 Floor, FMazeLayout& OutLayout) const
+{
+	return Floors.IsValidIndex(Floor) && OutLayout.LoadSnapshot(Floors[Floor].Snapshot);
+}
+
+void FMazeFloorPlan::GetStairs(int32 Floor, TArray<TPair<FIntVector, int32>>& OutStairs) const
+{
+	OutStairs.Reset();
+	for (const FIntVector& Lower : Stairs)
+	{
+		if (Lower.Z == Floor)
+		{
+			OutStairs.Add(TPair<FIntVector, int32>(FIntVector(Lower.X, Lower.Y, Floor), Floor + 1));
+		}
+		else if (Lower.Z == Floor - 1)
+		{
+			OutStairs.Add(TPair<FIntVector, int32>(FIntVector(Lower.X, Lower.Y, Floor), Floor - 1));
+		}
+	}
+}
+
+int32 FMazeFloorPlan::GetPackedSize() const
+{
+	int32 PackedSize = 0;
+	for (const FMazePackedFloor& Floor : Floors)
+	{
+		PackedSize += Floor.Snapshot.Num();
+	}
+	return PackedSize;
+}
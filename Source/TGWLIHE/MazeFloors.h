@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeLayout.h"
+#include "MazeFloors.generated.h"
+
+/**
+* A floor of a multi-floor maze, packed by FMazeLayout::SaveSnapshot while it is not materialized
+*/
+USTRUCT()
+struct TGWLIHE_API FMazePackedFloor
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+		TArray<uint8> Snapshot;
+};
+
+/**
+* Stacked floors of a maze, each one a perfect maze, linked by stairs between consecutive floors
+* The coordinates of a cell of a floor are its coordinates in the floor, with the floor index as Z
+*/
+USTRUCT()
+struct TGWLIHE_API FMazeFloorPlan
+{
+	GENERATED_BODY()
+
+public:
+	FMazeFloorPlan();
+
+	// Plans and packs every floor, each with its monsters, then places the stairs. The start is on the first floor, the end on the last one
+	void Plan(int32 SizeX, int32 SizeY, int32 FloorCount, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimerValue, int32 RandomSeed);
+
+	// Whether or not the floors have been planned
+	bool IsValid() const { return Floors.Num() > 0; }
+
+	// Number of floors
+	int32 Num() const { return Floors.Num(); }
+
+	// Unpacks the layout of a floor, returns false if there is no such floor
+	bool UnpackFloor(int32 Floor, FMazeLayout& OutLayout) const;
+
+	// Gives the stairs of a floor: their cell on this floor, and the floor they lead to
+	void GetStairs(int32 Floor, TArray<TPair<FIntVector, int32>>& OutStairs) const;
+
+	// Number of bytes of the packed floors
+	int32 GetPackedSize() const;
+
+private:
+	// Places stairs from the cell to the one above, unless one of them is reserved, then reserves both
+	bool TryPlaceStairs(FIntVector Cell, TArray<FIntVector>& ReservedCells);
+
+public:
+	// Size of every floor, Z is the number of floors
+	UPROPERTY()
+		FIntVector Size;
+
+	// Seed the floors were planned with
+	UPROPERTY()
+		int32 Seed;
+
+	// Y coordinate of the start cell, on the first column of the first floor
+	UPROPERTY()
+		int32 StartY;
+
+	// Y coordinate of the end cell, on the last column of the last floor
+	UPROPERTY()
+		int32 EndY;
+
+	// Packed layout of every floor
+	UPROPERTY()
+		TArray<FMazePackedFloor> Floors;
+
+	// Lower end of every stairs, Z being its floor: the upper end is the same cell of the floor above
+	UPROPERTY()
+		TArray<FIntVector> Stairs;
+
+	// Number of stairs between two consecutive floors
+	static const int32 StairsPerFloor = 2;
+};
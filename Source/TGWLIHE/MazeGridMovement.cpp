@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeGridMovement.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "MazeStats.h"
+#include "MazeTickCosts.h"
+
+DECLARE_CYCLE_STAT(TEXT("Grid movement"), STAT_MazeAIGridMovement, STATGROUP_MazeAI);
+
+// Sets default values for this component's properties
+UMazeGridMovementComponent::UMazeGridMovementComponent()
+{
+	// The patrol speed of the AI Monsters
+	MaxWalkSpeed = 50.0f;
+	CatchDistance = 100.0f;
+	CatchHeight = 200.0f;
+
+	Layout = nullptr;
+	GridTransform = FTransform::Identity;
+	PathIndex = 0;
+	PatrolHome = FIntVector::ZeroValue;
+	PatrolTarget = FIntVector::ZeroValue;
+	IsPatrolling = false;
+	ChaseTarget = nullptr;
+	ChaseTargetCell = FIntVector::ZeroValue;
+	IsChasePathFound = false;
+	IsTargetCaught = false;
+}
+
+void UMazeGridMovementComponent::SetGrid(const FMazeLayout& InLayout, const FTransform& InGridTransform)
+{
+	Layout = &InLayout;
+	GridTransform = InGridTransform;
+}
+
+void UMazeGridMovementComponent::Patrol(FIntVector Home, FIntVector Target)
+{
+	// Already walking this patrol, it goes on where it is
+	if (!ChaseTarget && Path.Num() > 0 && Home == PatrolHome && Target == PatrolTarget)
+	{
+		return;
+	}
+
+	ChaseTarget = nullptr;
+	PatrolHome = Home;
+	PatrolTarget = Target;
+
+	// A patrol of a single cell is only a walk back home
+	IsPatrolling = Home != Target;
+	SetPathTo(Home);
+}
+
+void UMazeGridMovementComponent::Chase(AActor* Target)
+{
+	if (Target == ChaseTarget && !IsTargetCaught)
+	{
+		return;
+	}
+
+	IsPatrolling = false;
+	ChaseTarget = Target;
+	IsTargetCaught = false;
+	ChaseTargetCell = GetCellAt(Target->GetActorLocation());
+	IsChasePathFound = SetPathTo(ChaseTargetCell);
+}
+
+void UMazeGridMovementComponent::StopMovementImmediately()
+{
+	Super::StopMovementImmediately();
+
+	Path.Reset();
+	PathIndex = 0;
+	IsPatrolling = false;
+	ChaseTarget = nullptr;
+}
+
+FIntVector UMazeGridMovementComponent::GetCellAt(FVector WorldLocation) const
+{
+	return Layout ? Layout->GetCellCoordinates(GridTransform.InverseTransformPosition(WorldLocation)) : FIntVector::ZeroValue;
+}
+
+FVector UMazeGridMovementComponent::GetCellWorldLocation(FIntVector Cell) const
+{
+	FVector CellLocation = Layout ? GridTransform.TransformPosition(Layout->GetCellRelativeLocation(Cell)) : FVector::ZeroVector;
+	if (UpdatedComponent)
+	{
+		CellLocation.Z = UpdatedComponent->GetComponentLocation().Z;
+	}
+	return CellLocation;
+}
+
+bool UMazeGridMovementComponent::SetPathTo(FIntVector Goal)
+{
+	// The path starts with the current cell: the agent first goes back to the center line of its corridor
+	PathIndex = 0;
+	if (!Layout || !UpdatedComponent || !Layout->FindPath(GetCellAt(UpdatedComponent->GetComponentLocation()), Goal, Path))
+	{
+		Path.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UMazeGridMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	MAZE_TICK_COST_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (ShouldSkipUpdate(DeltaTime) || !UpdatedComponent || !Layout || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIGridMovement);
+
+	// The path to the chased actor is only found again when it enters another cell
+	if (ChaseTarget)
+	{
+		FIntVector TargetCell = GetCellAt(ChaseTarget->GetActorLocation());
+		if (TargetCell != ChaseTargetCell)
+		{
+			ChaseTargetCell = TargetCell;
+			IsChasePathFound = SetPathTo(TargetCell);
+		}
+	}
+
+	// We walk the distance of the frame from cell center to cell center, turning at the centers only
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	FVector NewLocation = OldLocation;
+	float RemainingDistance = MaxWalkSpeed * DeltaTime;
+	while (RemainingDistance > 0.0f && PathIndex < Path.Num())
+	{
+		FVector Waypoint = GetCellWorldLocation(Path[PathIndex]);
+		float WaypointDistance = FVector::Dist(NewLocation, Waypoint);
+		if (WaypointDistance > RemainingDistance)
+		{
+			NewLocation += (Waypoint - NewLocation) * (RemainingDistance / WaypointDistance);
+			RemainingDistance = 0.0f;
+			break;
+		}
+
+		NewLocation = Waypoint;
+		RemainingDistance -= WaypointDistance;
+		PathIndex += 1;
+
+		// At the end of the patrol path, we turn back to the other end
+		if (PathIndex == Path.Num() && IsPatrolling)
+		{
+			FIntVector Goal = Path.Last() == PatrolHome ? PatrolTarget : PatrolHome;
+			PathIndex = 0;
+			Layout->FindPath(Path.Last(), Goal, Path);
+		}
+	}
+
+	// In the cell of the chased actor, the last steps go straight to it: only there, where no wall stands between them
+	const bool IsOnTargetFloor = ChaseTarget && FMath::Abs(ChaseTarget->GetActorLocation().Z - NewLocation.Z) < CatchHeight;
+	if (ChaseTarget && IsChasePathFound && IsOnTargetFloor && PathIndex >= Path.Num() && RemainingDistance > 0.0f && GetCellAt(NewLocation) == ChaseTargetCell)
+	{
+		FVector TargetLocation = ChaseTarget->GetActorLocation();
+		TargetLocation.Z = NewLocation.Z;
+		NewLocation += (TargetLocation - NewLocation).GetClampedToMaxSize(RemainingDistance);
+	}
+
+	// No sweep: the passages are the only places the path goes through, only the overlaps are updated
+	Velocity = (NewLocation - OldLocation) / DeltaTime;
+	if (!Velocity.IsNearlyZero())
+	{
+		UpdatedComponent->SetWorldLocationAndRotation(NewLocation, Velocity.ToOrientationRotator());
+	}
+	UpdateComponentVelocity();
+
+	if (ChaseTarget && !IsTargetCaught && IsOnTargetFloor && FVector::DistSquared2D(NewLocation, ChaseTarget->GetActorLocation()) < FMath::Square(CatchDistance))
+	{
+		IsTargetCaught = true;
+		TargetCaughtEvent.Broadcast();
+	}
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "MazeLayout.h"
+#include "MazeGridMovement.generated.h"
+
+// Declaration of event signature for the capture of the chased actor
+DECLARE_EVENT(UMazeGridMovementComponent, FTargetCaught)
+
+/**
+* Movement of a maze agent from cell center to cell center along the passages of the layout, instead of the full character movement:
+* no floor sweep, no step up, no physics, the agent stays at its height and only its overlaps are updated
+* It either patrols back and forth between two cells, or chases an actor along the shortest path to its cell
+*/
+UCLASS(ClassGroup = Movement, meta = (BlueprintSpawnableComponent))
+class TGWLIHE_API UMazeGridMovementComponent : public UPawnMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UMazeGridMovementComponent();
+
+	// Sets the layout the agent walks in, and the transform from the layout to the world (the maze actor, plus the floor if any)
+	void SetGrid(const FMazeLayout& InLayout, const FTransform& InGridTransform);
+
+	// Walks from the current cell to the home cell, then back and forth between the home and the target cells
+	void Patrol(FIntVector Home, FIntVector Target);
+
+	// Walks to the cell of the actor, following it from cell to cell, until it is caught
+	void Chase(AActor* Target);
+
+	// Stops at the current location, and stops patrolling or chasing
+	virtual void StopMovementImmediately() override;
+
+	// Cell of a world location, in the layout of the agent
+	FIntVector GetCellAt(FVector WorldLocation) const;
+
+	// World location of the center of a cell, at the height of the agent
+	FVector GetCellWorldLocation(FIntVector Cell) const;
+
+	// Called every frame, used here to move along the path
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Speed of the agent, the same as UCharacterMovementComponent::MaxWalkSpeed
+	virtual float GetMaxSpeed() const override { return MaxWalkSpeed; }
+
+	// Broadcast once when the chased actor is caught
+	FTargetCaught& OnTargetCaught() { return TargetCaughtEvent; }
+
+private:
+	// Finds the path from the current cell to the given one, returns false if there is none
+	bool SetPathTo(FIntVector Goal);
+
+public:
+	// Speed of the agent, set by its controller like the one of the character movement
+	UPROPERTY(EditAnywhere)
+		float MaxWalkSpeed;
+
+	// Distance to the chased actor, in the horizontal plane, below which it is caught
+	UPROPERTY(EditAnywhere)
+		float CatchDistance;
+
+	// Difference of height with the chased actor above which it is not caught, so that it is not caught from another floor
+	UPROPERTY(EditAnywhere)
+		float CatchHeight;
+
+private:
+	// Layout the agent walks in, owned by the maze
+	const FMazeLayout* Layout;
+
+	// From the layout to the world
+	FTransform GridTransform;
+
+	// Cells to walk through, the agent heads for PathIndex
+	TArray<FIntVector> Path;
+
+	// Index of the cell of the path the agent is heading for
+	int32 PathIndex;
+
+	// Ends of the patrol, walked back and forth
+	FIntVector PatrolHome;
+	FIntVector PatrolTarget;
+
+	// Whether or not the agent patrols, otherwise it chases or stands still
+	bool IsPatrolling;
+
+	// Actor chased, if any
+	UPROPERTY()
+		AActor* ChaseTarget;
+
+	// Cell of the chased actor when the path was found, so that the path is only found again when it changes
+	FIntVector ChaseTargetCell;
+
+	// Whether or not there is a path to the cell of the chased actor: otherwise it is out of the layout or out of reach, and the agent does not go straight to it
+	bool IsChasePathFound;
+
+	// Whether or not the chased actor has been caught, so that it is only caught once
+	bool IsTargetCaught;
+
+	// Event broadcast when the chased actor is caught
+	FTargetCaught TargetCaughtEvent;
+};
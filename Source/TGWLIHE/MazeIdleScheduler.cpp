@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeIdleScheduler.h"
+#include "HAL/PlatformTime.h"
+#include "MazeTelemetry.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Idle work"), STAT_MazeIdleWork, STATGROUP_Maze);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Idle tasks queued"), STAT_MazeIdleTasksQueued, STATGROUP_Maze);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Idle tasks run"), STAT_MazeIdleTasksRun, STATGROUP_Maze);
+
+FMazeIdleScheduler::FMazeIdleScheduler()
+	: OpenWindows(0)
+{
+}
+
+void FMazeIdleScheduler::Submit(const TCHAR* Name, EMazeIdlePriority::Type Priority, float EstimatedMs, TFunction<void()> Work)
+{
+	FIdleTask Task;
+	Task.Name = Name;
+	Task.Priority = Priority;
+	Task.EstimatedMs = FMath::Max(EstimatedMs, 0.0f);
+	Task.Work = MoveTemp(Work);
+
+	// Kept sorted, after the tasks of the same priority or higher, so that a frame only walks the queue from its start
+	int32 Index = Tasks.Num();
+	while (Index > 0 && Tasks[Index - 1].Priority < Task.Priority)
+	{
+		Index -= 1;
+	}
+	Tasks.Insert(MoveTemp(Task), Index);
+
+	SET_DWORD_STAT(STAT_MazeIdleTasksQueued, Tasks.Num());
+
+	if (WakeUp)
+	{
+		WakeUp();
+	}
+}
+
+void FMazeIdleScheduler::SetWindowOpen(uint8 Window, bool IsOpen)
+{
+	OpenWindows = IsOpen ? (OpenWindows | Window) : (OpenWindows & ~Window);
+
+	if (IsOpen && Tasks.Num() > 0 && WakeUp)
+	{
+		WakeUp();
+	}
+}
+
+int32 FMazeIdleScheduler::Tick(float FrameBudgetMs)
+{
+	if (!IsWindowOpen() || Tasks.Num() == 0)
+	{
+		return 0;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MazeIdleWork);
+	MAZE_TELEMETRY_SCOPE("Maze IdleWork");
+
+	// A task is run if its estimate fits in what is left of the budget, a task larger than the budget alone in its frame
+	// What a task really took is counted if it was longer than its estimate
+	float SpentMs = 0.0f;
+	int32 RunCount = 0;
+	for (int32 Index = 0; Index < Tasks.Num() && SpentMs < FrameBudgetMs; )
+	{
+		if (RunCount > 0 && SpentMs + Tasks[Index].EstimatedMs > FrameBudgetMs)
+		{
+			Index += 1;
+			continue;
+		}
+
+		FIdleTask Task = MoveTemp(Tasks[Index]);
+		Tasks.RemoveAt(Index);
+
+		const double StartTime = FPlatformTime::Seconds();
+		Task.Work();
+		const float TaskMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		if (TaskMs > Task.EstimatedMs * 2.0f && TaskMs > 1.0f)
+		{
+			UE_LOG(LogTemp, Log, TEXT("Maze idle work %s took %.2f ms, estimated %.2f ms"), Task.Name, TaskMs, Task.EstimatedMs);
+		}
+
+		SpentMs += FMath::Max(TaskMs, Task.EstimatedMs);
+		RunCount += 1;
+	}
+
+	INC_DWORD_STAT_BY(STAT_MazeIdleTasksRun, RunCount);
+	SET_DWORD_STAT(STAT_MazeIdleTasksQueued, Tasks.Num());
+	return RunCount;
+}
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+/**
+* Priorities of the idle work, the higher first
+*/
+namespace EMazeIdlePriority
+{
+	enum Type : uint8
+	{
+		Low,
+		Normal,
+		High
+	};
+}
+
+/**
+* Moments the player cannot see a hitch, one bit each: the idle work runs while any of them is open
+*/
+namespace EMazeIdleWindow
+{
+	enum Type : uint8
+	{
+		// The maze transition, from the generation of a level to the transition finished event
+		Transition = 1 << 0,
+		// The fade out of a level, until its fade in starts
+		FadeOut = 1 << 1,
+		// The fade out and fade in of a Monster kill
+		MonsterKill = 1 << 2
+	};
+}
+
+/**
+* Deferrable work submitted by the systems of the game, as the garbage collection or the prefetches, run only during the idle windows
+* Every frame of a window runs the work of the highest priority first, as much as its estimated costs fit in the frame budget
+*/
+class TGWLIHE_API FMazeIdleScheduler
+{
+public:
+	FMazeIdleScheduler();
+
+	// Queues work until an idle window, with its estimated cost in ms
+	void Submit(const TCHAR* Name, EMazeIdlePriority::Type Priority, float EstimatedMs, TFunction<void()> Work);
+
+	// Opens or closes an idle window, EMazeIdleWindow
+	void SetWindowOpen(uint8 Window, bool IsOpen);
+
+	// Whether or not the work can run now
+	bool IsWindowOpen() const { return OpenWindows != 0; }
+
+	// Runs the queued work which fits in the budget, if a window is open, returns the number of tasks run
+	int32 Tick(float FrameBudgetMs);
+
+	// Number of tasks waiting for a window
+	int32 Num() const { return Tasks.Num(); }
+
+	// Called when work may have to run: work submitted, or a window opened, so that the owner can tick again if it stopped
+	void SetWakeUp(TFunction<void()> InWakeUp) { WakeUp = MoveTemp(InWakeUp); }
+
+private:
+	struct FIdleTask
+	{
+		// Name of the work, for the logs
+		const TCHAR* Name;
+
+		// EMazeIdlePriority
+		uint8 Priority;
+
+		// Estimated cost, in ms
+		float EstimatedMs;
+
+		TFunction<void()> Work;
+	};
+
+	// Work waiting for a window, sorted by priority, the oldest first within a priority
+	TArray<FIdleTask> Tasks;
+
+	// Bits of the open windows, EMazeIdleWindow
+	uint8 OpenWindows;
+
+	// See SetWakeUp
+	TFunction<void()> WakeUp;
+};
@@ -0,0 +1,323 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeInputReplay.h"
+#include "Maze.h"
+#include "AmazeingCharacter.h"
+#include "MazeTickCosts.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/BufferArchive.h"
+#include "Serialization/MemoryReader.h"
+#include "HAL/PlatformMisc.h"
+
+const FName AMazeInputReplay::AxisNames[6] = { FName("MoveForward"), FName("MoveRight"), FName("Turn"), FName("TurnRate"), FName("LookUp"), FName("LookUpRate") };
+
+bool FMazeInputRecording::Save(const FString& Filename) const
+{
+	FBufferArchive Writer;
+
+	uint32 MagicValue = Magic;
+	uint32 VersionValue = Version;
+	float FixedDeltaTimeValue = FixedDeltaTime;
+	int32 SessionSeedValue = SessionSeed;
+	TArray<int32> LevelSeedsValue = LevelSeeds;
+	FVector EndLocationValue = EndLocation;
+	Writer << MagicValue << VersionValue << FixedDeltaTimeValue << SessionSeedValue << LevelSeedsValue << EndLocationValue;
+
+	int32 FrameCount = Frames.Num();
+	Writer << FrameCount;
+	for (FMazeInputFrame Frame : Frames)
+	{
+		Writer << Frame;
+	}
+
+	return FFileHelper::SaveArrayToFile(Writer, *Filename);
+}
+
+bool FMazeInputRecording::Load(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	uint32 MagicValue = 0;
+	uint32 VersionValue = 0;
+	Reader << MagicValue << VersionValue;
+	if (MagicValue != Magic || VersionValue != Version)
+	{
+		return false;
+	}
+
+	Reader << FixedDeltaTime << SessionSeed << LevelSeeds << EndLocation;
+
+	int32 FrameCount = 0;
+	Reader << FrameCount;
+	if (Reader.IsError() || FrameCount < 0 || FrameCount > Reader.TotalSize())
+	{
+		return false;
+	}
+	Frames.SetNum(FrameCount);
+	for (FMazeInputFrame& Frame : Frames)
+	{
+		Reader << Frame;
+	}
+
+	return !Reader.IsError() && FixedDeltaTime > 0.0f;
+}
+
+// Sets default values
+AMazeInputReplay::AMazeInputReplay()
+{
+	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	// The pause is recorded too, so the frames go on while the game is paused
+	PrimaryActorTick.bTickEvenWhenPaused = true;
+
+	FramesPerSecond = 60.0f;
+	EndLocationTolerance = 1.0f;
+
+	Maze = nullptr;
+	Character = nullptr;
+	IsReplayMode = false;
+	PendingActions = 0;
+	NextFrame = 0;
+	LevelCount = 0;
+	DivergedLevels = 0;
+}
+
+bool AMazeInputReplay::IsRequested()
+{
+	return IsRequested(FCommandLine::Get());
+}
+
+bool AMazeInputReplay::IsRequested(const TCHAR* CommandLine)
+{
+	// Either switch, alone or with the name of its recording
+	FString Name;
+	return FParse::Param(CommandLine, TEXT("MazeRecordInput")) || FParse::Value(CommandLine, TEXT("MazeRecordInput="), Name)
+		|| FParse::Param(CommandLine, TEXT("MazeReplay")) || FParse::Value(CommandLine, TEXT("MazeReplay="), Name);
+}
+
+FString AMazeInputReplay::GetRecordingFilename(const FString& Name)
+{
+	if (FPaths::FileExists(Name))
+	{
+		return Name;
+	}
+	return FPaths::ProfilingDir() / TEXT("MazeReplays") / FPaths::GetBaseFilename(Name) + TEXT(".mazeinput");
+}
+
+int32 AMazeInputReplay::Initialize(AMaze* InMaze, AAmazeingCharacter* InCharacter, int32 NewSessionSeed)
+{
+	Maze = InMaze;
+	Character = InCharacter;
+
+	FString ReplayName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("MazeReplay="), ReplayName))
+	{
+		Filename = GetRecordingFilename(ReplayName);
+		IsReplayMode = Recording.Load(Filename);
+		if (!IsReplayMode)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Maze replay: cannot load %s, nothing is replayed"), *Filename);
+			SetActorTickEnabled(false);
+			return NewSessionSeed;
+		}
+	}
+	else
+	{
+		FString RecordingName = FDateTime::Now().ToString();
+		FParse::Value(FCommandLine::Get(), TEXT("MazeRecordInput="), RecordingName);
+		Filename = GetRecordingFilename(RecordingName);
+
+		FParse::Value(FCommandLine::Get(), TEXT("ReplayFps="), FramesPerSecond);
+		Recording.FixedDeltaTime = 1.0f / FMath::Max(FramesPerSecond, 1.0f);
+		Recording.SessionSeed = NewSessionSeed;
+	}
+
+	// Every frame lasts the same, so that the same input gives the same movement
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Recording.FixedDeltaTime);
+	if (!IsReplayMode && !FApp::IsBenchmarking())
+	{
+		// The player plays in real time while recording, the frame rate is capped at the recorded one
+		GEngine->bUseFixedFrameRate = true;
+		GEngine->FixedFrameRate = 1.0f / Recording.FixedDeltaTime;
+	}
+
+	Maze->OnTransitionFinished().AddUFunction(this, FName("OnTransitionFinished"));
+
+	if (IsReplayMode)
+	{
+		// The recording replaces the player: its input has to reach the character before its movement
+		Character->DisableInput(nullptr);
+		Character->GetCharacterMovement()->PrimaryComponentTick.AddPrerequisite(this, PrimaryActorTick);
+		SetTickGroup(TG_PrePhysics);
+
+		UE_LOG(LogTemp, Warning, TEXT("Maze replay: %s, %d frames at %.0f fps, seed %d"), *Filename, Recording.Frames.Num(), 1.0f / Recording.FixedDeltaTime, Recording.SessionSeed);
+	}
+	else
+	{
+		// The input of the frame is complete once the player controller has processed it
+		BindRecordedInput();
+		SetTickGroup(TG_PostPhysics);
+
+		UE_LOG(LogTemp, Warning, TEXT("Maze input recording: %s at %.0f fps, seed %d"), *Filename, 1.0f / Recording.FixedDeltaTime, Recording.SessionSeed);
+	}
+
+	return Recording.SessionSeed;
+}
+
+void AMazeInputReplay::BindRecordedInput()
+{
+	EnableInput(UGameplayStatics::GetPlayerController(GetWorld(), 0));
+
+	for (const FName& AxisName : AxisNames)
+	{
+		InputComponent->BindAxis(AxisName).bConsumeInput = false;
+	}
+
+	InputComponent->BindAction("CloseEyes", IE_Pressed, this, &AMazeInputReplay::OnCloseEyesPressed).bConsumeInput = false;
+	InputComponent->BindAction("CloseEyes", IE_Released, this, &AMazeInputReplay::OnCloseEyesReleased).bConsumeInput = false;
+
+	FInputActionBinding& PauseBinding = InputComponent->BindAction("Pause", IE_Pressed, this, &AMazeInputReplay::OnPaused);
+	PauseBinding.bConsumeInput = false;
+	PauseBinding.bExecuteWhenPaused = true;
+}
+
+void AMazeInputReplay::OnCloseEyesPressed()
+{
+	PendingActions |= EMazeInputAction::CloseEyesPressed;
+}
+
+void AMazeInputReplay::OnCloseEyesReleased()
+{
+	PendingActions |= EMazeInputAction::CloseEyesReleased;
+}
+
+void AMazeInputReplay::OnPaused()
+{
+	PendingActions |= EMazeInputAction::Pause;
+}
+
+void AMazeInputReplay::Tick(float DeltaSeconds)
+{
+	MAZE_TICK_COST_SCOPE();
+
+	Super::Tick(DeltaSeconds);
+
+	if (IsReplayMode)
+	{
+		if (NextFrame < Recording.Frames.Num())
+		{
+			ReplayFrame(Recording.Frames[NextFrame]);
+			NextFrame += 1;
+		}
+		else
+		{
+			// The whole session has been replayed, the character has not moved since the last frame
+			float EndDistance = FVector::Dist(Character->GetActorLocation(), Recording.EndLocation);
+			if (EndDistance > EndLocationTolerance)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Maze replay: the character ended %.1f away from where it did in the recording"), EndDistance);
+			}
+			SetActorTickEnabled(false);
+			FPlatformMisc::RequestExit(false);
+		}
+		return;
+	}
+
+	// The axes are not processed while paused, they are recorded as 0
+	FMazeInputFrame Frame;
+	for (int32 i = 0; i < ARRAY_COUNT(AxisNames); i++)
+	{
+		Frame.Axes[i] = GetWorld()->IsPaused() ? 0.0f : InputComponent->GetAxisValue(AxisNames[i]);
+	}
+	Frame.Actions = PendingActions;
+	PendingActions = 0;
+	Recording.Frames.Add(Frame);
+
+	// Where the character is once this frame has been played
+	Recording.EndLocation = Character->GetActorLocation();
+}
+
+void AMazeInputReplay::ReplayFrame(const FMazeInputFrame& Frame)
+{
+	// Same calls as the bindings of AAmazeingCharacter::SetupPlayerInputComponent, actions first as the player controller does
+	if (Frame.Actions & EMazeInputAction::CloseEyesPressed)
+	{
+		Character->OnCloseEyesPressed();
+	}
+	if (Frame.Actions & EMazeInputAction::CloseEyesReleased)
+	{
+		Character->OnCloseEyesReleased();
+	}
+	if (Frame.Actions & EMazeInputAction::Pause)
+	{
+		Character->OnPaused();
+	}
+
+	if (GetWorld()->IsPaused())
+	{
+		return;
+	}
+
+	Character->MoveForward(Frame.Axes[0]);
+	Character->MoveRight(Frame.Axes[1]);
+	Character->AddControllerYawInput(Frame.Axes[2]);
+	Character->TurnAtRate(Frame.Axes[3]);
+	Character->AddControllerPitchInput(Frame.Axes[4]);
+	Character->LookUpAtRate(Frame.Axes[5]);
+}
+
+void AMazeInputReplay::OnTransitionFinished()
+{
+	int32 Seed = Maze->GetLayout().Seed;
+
+	if (!IsReplayMode)
+	{
+		Recording.LevelSeeds.Add(Seed);
+	}
+	else if (!Recording.LevelSeeds.IsValidIndex(LevelCount) || Recording.LevelSeeds[LevelCount] != Seed)
+	{
+		// The replay does not play the recorded levels anymore, its input does not match what is on screen
+		UE_LOG(LogTemp, Error, TEXT("Maze replay: level %d diverged, seed %d instead of %d"), LevelCount, Seed, Recording.LevelSeeds.IsValidIndex(LevelCount) ? Recording.LevelSeeds[LevelCount] : 0);
+		DivergedLevels += 1;
+	}
+
+	LevelCount += 1;
+}
+
+void AMazeInputReplay::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (IsReplayMode)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Maze replay finished: %d of %d frames, %d levels, %d diverged"), NextFrame, Recording.Frames.Num(), LevelCount, DivergedLevels);
+	}
+	else if (Recording.Frames.Num() > 0)
+	{
+		if (Recording.Save(Filename))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Maze input recording: %d frames, %d levels written to %s"), Recording.Frames.Num(), Recording.LevelSeeds.Num(), *Filename);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Maze input recording: cannot write %s"), *Filename);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
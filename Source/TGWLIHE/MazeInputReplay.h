@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "MazeInputReplay.generated.h"
+
+/**
+* Actions of the character, as flags of a recorded frame
+*/
+namespace EMazeInputAction
+{
+	enum Type : uint8
+	{
+		CloseEyesPressed = 1 << 0,
+		CloseEyesReleased = 1 << 1,
+		Pause = 1 << 2,
+	};
+}
+
+/**
+* Input of the character during one frame of fixed duration
+*/
+struct FMazeInputFrame
+{
+	// Axes, in the order of AMazeInputReplay::AxisNames
+	float Axes[6];
+
+	// Actions of this frame, EMazeInputAction flags
+	uint8 Actions;
+
+	FMazeInputFrame()
+		: Actions(0)
+	{
+		FMemory::Memzero(Axes);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FMazeInputFrame& Frame)
+	{
+		for (float& Axis : Frame.Axes)
+		{
+			Ar << Axis;
+		}
+		Ar << Frame.Actions;
+		return Ar;
+	}
+};
+
+/**
+* A recorded play session: the seed its levels were generated from, and the input of every frame
+*/
+struct FMazeInputRecording
+{
+	// Duration of every frame, in s
+	float FixedDeltaTime;
+
+	// Seed of the session, given to the game mode and the maze
+	int32 SessionSeed;
+
+	// Seed of every level played, to check that the replay generates the same ones
+	TArray<int32> LevelSeeds;
+
+	// Input of every frame
+	TArray<FMazeInputFrame> Frames;
+
+	// Location of the character on the last frame, to check that the replay ends at the same place
+	FVector EndLocation;
+
+	FMazeInputRecording()
+		: FixedDeltaTime(1.0f / 60.0f), SessionSeed(0), EndLocation(FVector::ZeroVector)
+	{
+	}
+
+	// Writes the recording, returns false if the file cannot be written
+	bool Save(const FString& Filename) const;
+
+	// Reads a recording, returns false if the file is missing or invalid
+	bool Load(const FString& Filename);
+
+	// Identifies a recording file
+	static const uint32 Magic = 0x52494D4D; // "MMIR"
+	static const uint32 Version = 1;
+};
+
+/**
+* Records the input of the player with a fixed time step, or replays a recording in place of the player
+* Spawned by the game mode, recording with -MazeRecordInput[=Name], replaying with -MazeReplay=Name, for instance headless:
+* UE4Editor TGWLIHE.uproject -game -nullrhi -nosound -unattended -benchmark -MazeReplay=Session
+* The recordings are in Saved/Profiling/MazeReplays. The replay plays the same levels with the same input on every build,
+* so that the level telemetry, the stats and the GC timings can be compared between builds, then quits at the end of the recording
+*/
+UCLASS(NotPlaceable)
+class TGWLIHE_API AMazeInputReplay : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AMazeInputReplay();
+
+	// Whether or not a recording or a replay has been asked for on the command line
+	static bool IsRequested();
+
+	// Same, on the given command line: -MazeRecordInput or -MazeReplay, with or without the name of the recording
+	static bool IsRequested(const TCHAR* CommandLine);
+
+	// Loads the recording or starts one, fixes the time step, and returns the seed of the session: the recorded one when replaying
+	int32 Initialize(class AMaze* InMaze, class AAmazeingCharacter* InCharacter, int32 NewSessionSeed);
+
+	// Whether or not the character is driven by a recording
+	bool IsReplaying() const { return IsReplayMode; }
+
+protected:
+	// Called every frame, used here to record or replay the input of the frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	// Writes the recording, or checks that the replay ended where the recording did
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// Binds the input of the player without consuming it, the character still receives it
+	void BindRecordedInput();
+
+	// Actions of the player, while recording
+	void OnCloseEyesPressed();
+	void OnCloseEyesReleased();
+	void OnPaused();
+
+	// Gives the input of a recorded frame to the character
+	void ReplayFrame(const FMazeInputFrame& Frame);
+
+	// A level has been generated: its seed is recorded, or compared with the recorded one
+	UFUNCTION()
+		void OnTransitionFinished();
+
+	// Path of a recording from the name given on the command line
+	static FString GetRecordingFilename(const FString& Name);
+
+public:
+	// Names of the recorded axes, as bound by the character
+	static const FName AxisNames[6];
+
+	// Frame rate of the recordings, overridden by -ReplayFps=
+	UPROPERTY(EditAnywhere)
+		float FramesPerSecond;
+
+	// Distance between the end locations of the recording and of the replay above which the replay is reported as diverging
+	UPROPERTY(EditAnywhere)
+		float EndLocationTolerance;
+
+private:
+	UPROPERTY()
+		class AMaze* Maze;
+
+	UPROPERTY()
+		class AAmazeingCharacter* Character;
+
+	// Whether or not the recording is replayed, otherwise it is being recorded
+	bool IsReplayMode;
+
+	// Recording being taken or replayed
+	FMazeInputRecording Recording;
+
+	// File of the recording
+	FString Filename;
+
+	// Actions of the frame being recorded
+	uint8 PendingActions;
+
+	// Index of the next frame to replay
+	int32 NextFrame;
+
+	// Number of levels generated since the start
+	int32 LevelCount;
+
+	// Number of levels whose seed differs from the recorded one
+	int32 DivergedLevels;
+};
@@ -0,0 +1,784 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeLayout.h"
+#include "MazeDirections.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "MazeStats.h"
+#include "Misc/Crc.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Plan layout"), STAT_MazePlan, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("DoNextGenerationStep"), STAT_MazeDoNextGenerationStep, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Carve tiles"), STAT_MazeCarveTiles, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Plan AI path"), STAT_MazePlanAIPath, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Save snapshot"), STAT_MazeSaveSnapshot, STATGROUP_Maze);
+DECLARE_CYCLE_STAT(TEXT("Load snapshot"), STAT_MazeLoadSnapshot, STATGROUP_Maze);
+
+FMazeLayout::FMazeLayout()
+	: Size(0, 0, 0)
+	, Seed(0)
+	, StartY(0)
+	, EndY(0)
+	, MonsterNumber(0)
+	, AIPathLength(0)
+	, DeathTimer(0)
+{
+}
+
+void FMazeLayout::Plan(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimerValue, int32 RandomSeed, bool PlaceStartEndFarthest)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazePlan);
+
+	FRandomStream Stream(RandomSeed);
+
+	// We update all the layout values with the new ones
+	Size = FIntVector(SizeX, SizeY, 0);
+	Seed = RandomSeed;
+	MonsterNumber = NumberOfMonsters;
+	AIPathLength = MonsterPathLength;
+	DeathTimer = DeathTimerValue;
+	BorderMasks.Reset();
+
+	// Then, we carve the maze, by tiles on every core when it is larger than a tile
+	if (Size.X > TileSize || Size.Y > TileSize)
+	{
+		CarveTiles(Stream);
+	}
+	else
+	{
+		Carve(Stream);
+	}
+
+	// Then, we define the random coordinates for the start & end - And remove them from possible placements for the AI
+	TArray<FBool2DArray> IsCellUsed;
+	IsCellUsed.AddZeroed(Size.X);
+	for (int i = 0; i < Size.X; i++)
+	{
+		IsCellUsed[i].Init(false, Size.Y);
+	}
+
+	StartY = Stream.RandRange(0, Size.Y - 1);
+	EndY = Stream.RandRange(0, Size.Y - 1);
+
+	// The random rows are drawn anyway, so that the patrols are drawn from the same stream either way
+	if (PlaceStartEndFarthest)
+	{
+		PlaceStartEndFarthestApart();
+	}
+
+	IsCellUsed[0].Array2ndDimension[StartY] = true;
+	IsCellUsed[Size.X - 1].Array2ndDimension[EndY] = true;
+
+	// Finally, we plan the patrol of every monster
+	Patrols.Reset(MonsterNumber);
+	for (int i = 0; i < MonsterNumber; i++)
+	{
+		Patrols.Add(CreateAIPath(Stream, IsCellUsed));
+	}
+}
+
+void FMazeLayout::PlanRegion(int32 RegionSize, FIntVector Region, int32 WorldSeed, int32 BorderOpenings)
+{
+	// Inside, a region is an ordinary maze, without monster nor Death
+	Plan(RegionSize, RegionSize, 0, 0, 0, (int32)HashRegion(Region, WorldSeed, 0));
+
+	// Each border is shared with a neighbor region, which opens it at the same positions as it hashes the same border
+	// Both regions being perfect mazes, every cell of one can reach every cell of the other
+	BorderMasks.Init(0, Num());
+	OpenRegionBorder(HashRegion(Region, WorldSeed, 1), EMazeDirection::West, BorderOpenings);
+	OpenRegionBorder(HashRegion(Region - FIntVector(1, 0, 0), WorldSeed, 1), EMazeDirection::East, BorderOpenings);
+	OpenRegionBorder(HashRegion(Region, WorldSeed, 2), EMazeDirection::North, BorderOpenings);
+	OpenRegionBorder(HashRegion(Region - FIntVector(0, 1, 0), WorldSeed, 2), EMazeDirection::South, BorderOpenings);
+}
+
+uint32 FMazeLayout::HashRegion(FIntVector Region, int32 WorldSeed, uint32 Salt)
+{
+	// Same on every platform, so that a world seed always gives the same maze
+	int32 Key[4] = { Region.X, Region.Y, WorldSeed, (int32)Salt };
+	return FCrc::MemCrc32(Key, sizeof(Key));
+}
+
+void FMazeLayout::OpenRegionBorder(uint32 BorderHash, EMazeDirection Direction, int32 Openings)
+{
+	FRandomStream Stream(BorderHash);
+	FIntVector Step = UMazeDirections::ToIntVector(Direction);
+
+	for (int32 i = 0; i < Openings; i++)
+	{
+		// Position along the border, the cell is on the first or last row or column depending on the direction
+		int32 Position = Stream.RandRange(0, (Step.X != 0 ? Size.Y : Size.X) - 1);
+		FIntVector Coordinates;
+		if (Step.X != 0)
+		{
+			Coordinates = FIntVector(Step.X > 0 ? Size.X - 1 : 0, Position, 0);
+		}
+		else
+		{
+			Coordinates = FIntVector(Position, Step.Y > 0 ? Size.Y - 1 : 0, 0);
+		}
+		BorderMasks[ToIndex(Coordinates)] |= 1 << (uint8)Direction;
+	}
+}
+
+bool FMazeLayout::ContainsCoordinates(FIntVector Coordinates) const
+{
+	return Coordinates.X >= 0 && Coordinates.X < Size.X && Coordinates.Y >= 0 && Coordinates.Y < Size.Y;
+}
+
+bool FMazeLayout::HasPassage(FIntVector Coordinates, EMazeDirection Direction) const
+{
+	return (PassageMasks[ToIndex(Coordinates)] & (1 << (uint8)Direction)) != 0;
+}
+
+bool FMazeLayout::HasBorderOpening(FIntVector Coordinates, EMazeDirection Direction) const
+{
+	return BorderMasks.Num() > 0 && (BorderMasks[ToIndex(Coordinates)] & (1 << (uint8)Direction)) != 0;
+}
+
+FVector FMazeLayout::GetCellRelativeLocation(FIntVector Coordinates) const
+{
+	return FVector(CellSpacing * (Coordinates.X - Size.X * 0.5f + 0.5f), CellSpacing * (Coordinates.Y - Size.Y * 0.5f + 0.5f), 0.0f);
+}
+
+FIntVector FMazeLayout::GetCellCoordinates(FVector RelativeLocation) const
+{
+	return FIntVector(FMath::RoundToInt(RelativeLocation.X / CellSpacing + Size.X * 0.5f - 0.5f), FMath::RoundToInt(RelativeLocation.Y / CellSpacing + Size.Y * 0.5f - 0.5f), 0);
+}
+
+FIntVector FMazeLayout::RandomCoordinates(FRandomStream& Stream) const
+{
+	return FIntVector(Stream.RandRange(0, Size.X - 1), Stream.RandRange(0, Size.Y - 1), 0);
+}
+
+void FMazeLayout::Carve(FRandomStream& Stream)
+{
+	// No passage at first, and no edge initialized
+	PassageMasks.Init(0, Num());
+	TArray<uint8> InitializedEdges;
+	InitializedEdges.Init(0, Num());
+
+	TArray<FIntVector> ActiveCells;
+	DoFirstGenerationStep(ActiveCells, InitializedEdges, Stream);
+
+	while (ActiveCells.Num() > 0)
+	{
+		DoNextGenerationStep(ActiveCells, InitializedEdges, Stream);
+	}
+}
+
+void FMazeLayout::CarveTiles(FRandomStream& Stream, bool IsSingleThreaded)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeCarveTiles);
+
+	PassageMasks.Init(0, Num());
+	const FIntVector TileCount(FMath::DivideAndRoundUp(Size.X, (int32)TileSize), FMath::DivideAndRoundUp(Size.Y, (int32)TileSize), 0);
+	const uint32 TilesSeed = Stream.GetUnsignedInt();
+
+	// Every tile is a perfect maze of its own, carved from its own seed in a layout of its own: a worker only writes the cells of its tile
+	ParallelFor(TileCount.X * TileCount.Y, [this, &TileCount, TilesSeed](int32 TileIndex)
+	{
+		const FIntVector TileOrigin(TileIndex / TileCount.Y * TileSize, TileIndex % TileCount.Y * TileSize, 0);
+		FMazeLayout Tile;
+		Tile.Size = FIntVector(FMath::Min((int32)TileSize, Size.X - TileOrigin.X), FMath::Min((int32)TileSize, Size.Y - TileOrigin.Y), 0);
+		FRandomStream TileStream((int32)HashCombine(TilesSeed, (uint32)TileIndex));
+		Tile.Carve(TileStream);
+
+		// The layouts are X major: a column of the tile is a run of cells of the maze
+		for (int32 X = 0; X < Tile.Size.X; X++)
+		{
+			FMemory::Memcpy(&PassageMasks[ToIndex(TileOrigin + FIntVector(X, 0, 0))], &Tile.PassageMasks[Tile.ToIndex(FIntVector(X, 0, 0))], Tile.Size.Y);
+		}
+	}, IsSingleThreaded);
+
+	// The tiles are then joined along a perfect maze of tiles: two tiles with a passage between them get one through their border, at a random row or column
+	// Every tile being a tree, and the tiles being joined as a tree, the whole maze is one
+	FMazeLayout TileTree;
+	TileTree.Size = TileCount;
+	TileTree.Carve(Stream);
+	for (int32 TileIndex = 0; TileIndex < TileTree.Num(); TileIndex++)
+	{
+		const FIntVector TileCoordinates = TileTree.ToCoordinates(TileIndex);
+		const FIntVector TileOrigin = TileCoordinates * TileSize;
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			// Each border once, from the tile before it
+			const FIntVector Step = UMazeDirections::ToIntVector((EMazeDirection)i);
+			if (Step.X < 0 || Step.Y < 0 || !TileTree.HasPassage(TileCoordinates, (EMazeDirection)i))
+			{
+				continue;
+			}
+
+			FIntVector Coordinates;
+			if (Step.X > 0)
+			{
+				Coordinates = FIntVector(TileOrigin.X + TileSize - 1, TileOrigin.Y + Stream.RandRange(0, FMath::Min((int32)TileSize, Size.Y - TileOrigin.Y) - 1), 0);
+			}
+			else
+			{
+				Coordinates = FIntVector(TileOrigin.X + Stream.RandRange(0, FMath::Min((int32)TileSize, Size.X - TileOrigin.X) - 1), TileOrigin.Y + TileSize - 1, 0);
+			}
+			OpenPassage(Coordinates, (EMazeDirection)i);
+		}
+	}
+}
+
+void FMazeLayout::OpenPassage(FIntVector Coordinates, EMazeDirection Direction)
+{
+	PassageMasks[ToIndex(Coordinates)] |= 1 << (uint8)Direction;
+	PassageMasks[ToIndex(Coordinates + UMazeDirections::ToIntVector(Direction))] |= 1 << (uint8)UMazeDirections::GetOppositeDirection(Direction);
+}
+
+void FMazeLayout::DoFirstGenerationStep(TArray<FIntVector>& ActiveCells, TArray<uint8>& InitializedEdges, FRandomStream& Stream)
+{
+	ActiveCells.Add(RandomCoordinates(Stream));
+}
+
+void FMazeLayout::DoNextGenerationStep(TArray<FIntVector>& ActiveCells, TArray<uint8>& InitializedEdges, FRandomStream& Stream)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeDoNextGenerationStep);
+
+	int32 CurrentIndex = ActiveCells.Num() - 1;
+	FIntVector CurrentCell = ActiveCells[CurrentIndex];
+	uint8 InitializedMask = InitializedEdges[ToIndex(CurrentCell)];
+
+	// Every edge of the cell is known: backtrack
+	if (InitializedMask == (1 << UMazeDirections::Count) - 1)
+	{
+		ActiveCells.RemoveAt(CurrentIndex);
+		return;
+	}
+
+	EMazeDirection Direction = RandomUninitializedDirection(InitializedMask, Stream);
+	FIntVector Coordinates = CurrentCell + UMazeDirections::ToIntVector(Direction);
+
+	if (ContainsCoordinates(Coordinates))
+	{
+		// A cell is created as soon as one of its edges is, so a neighbor without any edge has not been visited yet
+		if (InitializedEdges[ToIndex(Coordinates)] == 0)
+		{
+			SetEdge(CurrentCell, Direction, ECellEdgeType::Passage, InitializedEdges);
+			ActiveCells.Add(Coordinates);
+		}
+		else
+		{
+			SetEdge(CurrentCell, Direction, ECellEdgeType::Wall, InitializedEdges);
+		}
+	}
+	else
+	{
+		SetEdge(CurrentCell, Direction, ECellEdgeType::Wall, InitializedEdges);
+	}
+}
+
+void FMazeLayout::SetEdge(FIntVector Coordinates, EMazeDirection Direction, ECellEdgeType Type, TArray<uint8>& InitializedEdges)
+{
+	const uint8 Bit = 1 << (uint8)Direction;
+	const int32 Index = ToIndex(Coordinates);
+	InitializedEdges[Index] |= Bit;
+	if (Type == ECellEdgeType::Passage)
+	{
+		PassageMasks[Index] |= Bit;
+	}
+
+	// The same edge, seen from the other cell
+	FIntVector OtherCoordinates = Coordinates + UMazeDirections::ToIntVector(Direction);
+	if (ContainsCoordinates(OtherCoordinates))
+	{
+		const uint8 OtherBit = 1 << (uint8)UMazeDirections::GetOppositeDirection(Direction);
+		const int32 OtherIndex = ToIndex(OtherCoordinates);
+		InitializedEdges[OtherIndex] |= OtherBit;
+		if (Type == ECellEdgeType::Passage)
+		{
+			PassageMasks[OtherIndex] |= OtherBit;
+		}
+	}
+}
+
+EMazeDirection FMazeLayout::RandomUninitializedDirection(uint8 InitializedMask, FRandomStream& Stream) const
+{
+	// We determine a random number of skips to do
+	int32 Skips = Stream.RandRange(0, UMazeDirections::Count - FMath::CountBits(InitializedMask) - 1);
+
+	// Then, we loop through the directions. When we find an uninitialized edge, we take the associated direction when there's finally no skip left.
+	for (uint8 i = 0; i < UMazeDirections::Count; i++)
+	{
+		if (!(InitializedMask & (1 << i)))
+		{
+			if (Skips == 0)
+			{
+				return (EMazeDirection)i;
+			}
+			Skips -= 1;
+		}
+	}
+
+	// We should not attain this return in a nominal case
+	UE_LOG(LogTemp, Warning, TEXT("Bug: Direction aleatoire definie par defaut (Nord) masque: %d"), InitializedMask);
+	return EMazeDirection::North;
+}
+
+FMazePatrol FMazeLayout::CreateAIPath(FRandomStream& Stream, TArray<FBool2DArray>& IsCellUsed) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazePlanAIPath);
+
+	FMazePatrol Patrol;
+
+	// First, we list the cells that are not used : one of them will be the "home" location of the AI
+	TArray<FIntVector> FreeCells;
+	for (int i = 0; i < Size.X; i++)
+	{
+		for (int j = 0; j < Size.Y; j++)
+		{
+			if (!IsCellUsed[i][j])
+			{
+				FreeCells.Add(FIntVector(i, j, 0));
+			}
+		}
+	}
+
+	// If every cell is already used (too many monsters for this size), the monster shares a random cell
+	FIntVector Home = FreeCells.Num() > 0 ? FreeCells[Stream.RandRange(0, FreeCells.Num() - 1)] : RandomCoordinates(Stream);
+	IsCellUsed[Home.X].Array2ndDimension[Home.Y] = true; // The cell is now used
+	Patrol.Home = Home;
+
+	// Then, we determine a path of AIPathLength length
+	FIntVector Last = Home;
+	Patrol.Length = 1;
+	while (Patrol.Length < AIPathLength)
+	{
+		// Get a random available cell, use it if any is available, otherwise keep the path as it is
+		FIntVector NextCell;
+		if (RandomUsableNeighborCell(Last, Stream, IsCellUsed, NextCell))
+		{
+			Last = NextCell;
+			Patrol.Length += 1;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// The last cell is the "target" location of the patrol
+	Patrol.Target = Last;
+
+	return Patrol;
+}
+
+bool FMazeLayout::RandomUsableNeighborCell(FIntVector Coordinates, FRandomStream& Stream, TArray<FBool2DArray>& IsCellUsed, FIntVector& OutNeighbor) const
+{
+	// We keep only the passages leading to a cell which is not used yet
+	FIntVector ValidNeighbors[UMazeDirections::Count];
+	int32 ValidNeighborCount = 0;
+	for (uint8 i = 0; i < UMazeDirections::Count; i++)
+	{
+		if (HasPassage(Coordinates, (EMazeDirection)i))
+		{
+			FIntVector Neighbor = Coordinates + UMazeDirections::ToIntVector((EMazeDirection)i);
+			if (!IsCellUsed[Neighbor.X][Neighbor.Y])
+			{
+				ValidNeighbors[ValidNeighborCount++] = Neighbor;
+			}
+		}
+	}
+
+	if (ValidNeighborCount == 0)
+	{
+		return false;
+	}
+
+	// Then, we return a randomly selected one
+	OutNeighbor = ValidNeighbors[Stream.RandRange(0, ValidNeighborCount - 1)];
+	IsCellUsed[OutNeighbor.X].Array2ndDimension[OutNeighbor.Y] = true;
+	return true;
+}
+
+void FMazeLayout::ComputeDistances(FIntVector From, TArray<int32>& OutDistances) const
+{
+	OutDistances.Init(-1, Num());
+	if (!ContainsCoordinates(From))
+	{
+		return;
+	}
+
+	// Breadth first search along the passages
+	TArray<int32> Queue;
+	Queue.Reserve(Num());
+	Queue.Add(ToIndex(From));
+	OutDistances[ToIndex(From)] = 0;
+	for (int32 Head = 0; Head < Queue.Num(); Head++)
+	{
+		FIntVector Coordinates = ToCoordinates(Queue[Head]);
+		int32 Distance = OutDistances[Queue[Head]];
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			if (HasPassage(Coordinates, (EMazeDirection)i))
+			{
+				FIntVector Neighbor = Coordinates + UMazeDirections::ToIntVector((EMazeDirection)i);
+				if (ContainsCoordinates(Neighbor) && OutDistances[ToIndex(Neighbor)] < 0)
+				{
+					OutDistances[ToIndex(Neighbor)] = Distance + 1;
+					Queue.Add(ToIndex(Neighbor));
+				}
+			}
+		}
+	}
+}
+
+void FMazeLayout::GetCellsWithin(FIntVector From, int32 MaxDistance, TArray<TPair<FIntVector, int32>>& OutCells) const
+{
+	OutCells.Reset();
+	if (!ContainsCoordinates(From) || MaxDistance < 0)
+	{
+		return;
+	}
+
+	// Breadth first search along the passages, stopped at MaxDistance. The maze is perfect: a cell is only reached from the one it was entered from,
+	// so remembering where each cell was entered from is enough, and the cost only depends on the number of cells within reach
+	TArray<EMazeDirection> EnteredFrom;
+	OutCells.Add(TPair<FIntVector, int32>(From, 0));
+	EnteredFrom.Add(EMazeDirection::North);
+	for (int32 Head = 0; Head < OutCells.Num(); Head++)
+	{
+		const FIntVector Coordinates = OutCells[Head].Key;
+		const int32 Distance = OutCells[Head].Value;
+		if (Distance == MaxDistance)
+		{
+			continue;
+		}
+
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			EMazeDirection Direction = (EMazeDirection)i;
+			if ((Head == 0 || Direction != EnteredFrom[Head]) && HasPassage(Coordinates, Direction))
+			{
+				FIntVector Neighbor = Coordinates + UMazeDirections::ToIntVector(Direction);
+				if (ContainsCoordinates(Neighbor))
+				{
+					OutCells.Add(TPair<FIntVector, int32>(Neighbor, Distance + 1));
+					EnteredFrom.Add(UMazeDirections::GetOppositeDirection(Direction));
+				}
+			}
+		}
+	}
+}
+
+bool FMazeLayout::FindPath(FIntVector From, FIntVector To, TArray<FIntVector>& OutPath) const
+{
+	OutPath.Reset();
+	if (!ContainsCoordinates(From) || !ContainsCoordinates(To))
+	{
+		return false;
+	}
+
+	// Distances from the destination, so that the path is found by always going to the closer neighbor
+	TArray<int32> Distances;
+	ComputeDistances(To, Distances);
+	if (Distances[ToIndex(From)] < 0)
+	{
+		return false;
+	}
+
+	FIntVector Current = From;
+	OutPath.Add(Current);
+	while (Current != To)
+	{
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			FIntVector Neighbor = Current + UMazeDirections::ToIntVector((EMazeDirection)i);
+			if (HasPassage(Current, (EMazeDirection)i) && ContainsCoordinates(Neighbor) && Distances[ToIndex(Neighbor)] == Distances[ToIndex(Current)] - 1)
+			{
+				Current = Neighbor;
+				break;
+			}
+		}
+		OutPath.Add(Current);
+	}
+	return true;
+}
+
+bool FMazeLayout::IsInSight(FIntVector From, FIntVector To) const
+{
+	if (!ContainsCoordinates(From) || !ContainsCoordinates(To) || (From.X != To.X && From.Y != To.Y))
+	{
+		return false;
+	}
+
+	// Straight along the corridor, every edge crossed has to be a passage
+	EMazeDirection Direction = From.X != To.X ? (To.X > From.X ? EMazeDirection::West : EMazeDirection::East) : (To.Y > From.Y ? EMazeDirection::North : EMazeDirection::South);
+	for (FIntVector Cell = From; Cell != To; Cell += UMazeDirections::ToIntVector(Direction))
+	{
+		if (!HasPassage(Cell, Direction))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FMazeLayout::PlaceStartEndFarthestApart()
+{
+	TArray<int32> Distances;
+	ComputeDistances(FIntVector(0, StartY, 0), Distances);
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		if (Distances[ToIndex(FIntVector(Size.X - 1, Y, 0))] > Distances[ToIndex(FIntVector(Size.X - 1, EndY, 0))])
+		{
+			EndY = Y;
+		}
+	}
+
+	ComputeDistances(FIntVector(Size.X - 1, EndY, 0), Distances);
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		if (Distances[ToIndex(FIntVector(0, Y, 0))] > Distances[ToIndex(FIntVector(0, StartY, 0))])
+		{
+			StartY = Y;
+		}
+	}
+}
+
+int32 FMazeLayout::GetSolutionLength() const
+{
+	TArray<int32> Distances;
+	ComputeDistances(FIntVector(0, StartY, 0), Distances);
+	int32 Distance = Distances[ToIndex(FIntVector(Size.X - 1, EndY, 0))];
+	return Distance < 0 ? -1 : Distance + 1;
+}
+
+int32 FMazeLayout::CountDeadEnds() const
+{
+	int32 DeadEnds = 0;
+	for (uint8 Mask : PassageMasks)
+	{
+		if (FMath::CountBits(Mask) == 1)
+		{
+			DeadEnds += 1;
+		}
+	}
+	return DeadEnds;
+}
+
+bool FMazeLayout::Validate() const
+{
+	if (!IsValid() || PassageMasks.Num() != Num())
+	{
+		return false;
+	}
+
+	// A perfect maze is a spanning tree of the grid: Num() - 1 passages, every one of them seen from both of its cells
+	int32 PassageCount = 0;
+	for (int32 Index = 0; Index < Num(); Index++)
+	{
+		FIntVector Coordinates = ToCoordinates(Index);
+		for (uint8 i = 0; i < UMazeDirections::Count; i++)
+		{
+			EMazeDirection Direction = (EMazeDirection)i;
+			if (HasPassage(Coordinates, Direction))
+			{
+				FIntVector Neighbor = Coordinates + UMazeDirections::ToIntVector(Direction);
+				if (!ContainsCoordinates(Neighbor) || !HasPassage(Neighbor, UMazeDirections::GetOppositeDirection(Direction)))
+				{
+					return false;
+				}
+				PassageCount += 1;
+			}
+		}
+	}
+	if (PassageCount != 2 * (Num() - 1))
+	{
+		return false;
+	}
+
+	// With that many passages, it is a tree if and only if every cell is reachable
+	TArray<int32> Distances;
+	ComputeDistances(FIntVector(0, 0, 0), Distances);
+	for (int32 Distance : Distances)
+	{
+		if (Distance < 0)
+		{
+			return false;
+		}
+	}
+
+	// Start and end on opposite columns, patrols inside the maze
+	if (StartY < 0 || StartY >= Size.Y || EndY < 0 || EndY >= Size.Y || Patrols.Num() != MonsterNumber)
+	{
+		return false;
+	}
+	for (const FMazePatrol& Patrol : Patrols)
+	{
+		if (!ContainsCoordinates(Patrol.Home) || !ContainsCoordinates(Patrol.Target) || Patrol.Length < 1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FMazeLayout::SaveSnapshot(TArray<uint8>& OutSnapshot) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeSaveSnapshot);
+
+	FBitWriter Writer(0, true);
+
+	// Header
+	uint32 Version = SnapshotVersion;
+	Writer.SerializeInt(Version, SnapshotVersion + 1);
+	int32 SeedValue = Seed;
+	Writer << SeedValue;
+	uint32 SizeX = Size.X;
+	uint32 SizeY = Size.Y;
+	Writer.SerializeInt(SizeX, SnapshotMaxSize + 1);
+	Writer.SerializeInt(SizeY, SnapshotMaxSize + 1);
+	uint32 Start = StartY;
+	uint32 End = EndY;
+	Writer.SerializeInt(Start, SizeY);
+	Writer.SerializeInt(End, SizeY);
+	uint32 Monsters = MonsterNumber;
+	uint32 PathLength = AIPathLength;
+	uint32 Death = DeathTimer;
+	Writer.SerializeIntPacked(Monsters);
+	Writer.SerializeIntPacked(PathLength);
+	Writer.SerializeIntPacked(Death);
+
+	// Topology: one bit per inner edge, only towards North and West as the other directions are the same edges seen from the neighbor
+	for (int i = 0; i < Size.X; i++)
+	{
+		for (int j = 0; j < Size.Y; j++)
+		{
+			FIntVector Coordinates(i, j, 0);
+			if (j + 1 < Size.Y)
+			{
+				Writer.WriteBit(HasPassage(Coordinates, EMazeDirection::North) ? 1 : 0);
+			}
+			if (i + 1 < Size.X)
+			{
+				Writer.WriteBit(HasPassage(Coordinates, EMazeDirection::West) ? 1 : 0);
+			}
+		}
+	}
+
+	// AI Monster patrols
+	for (const FMazePatrol& Patrol : Patrols)
+	{
+		uint32 HomeX = Patrol.Home.X;
+		uint32 HomeY = Patrol.Home.Y;
+		uint32 TargetX = Patrol.Target.X;
+		uint32 TargetY = Patrol.Target.Y;
+		uint32 Length = Patrol.Length;
+		Writer.SerializeInt(HomeX, SizeX);
+		Writer.SerializeInt(HomeY, SizeY);
+		Writer.SerializeInt(TargetX, SizeX);
+		Writer.SerializeInt(TargetY, SizeY);
+		Writer.SerializeIntPacked(Length);
+	}
+
+	OutSnapshot = *Writer.GetBuffer();
+}
+
+bool FMazeLayout::LoadSnapshot(const TArray<uint8>& Snapshot)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeLoadSnapshot);
+
+	if (Snapshot.Num() == 0)
+	{
+		return false;
+	}
+
+	FBitReader Reader(const_cast<uint8*>(Snapshot.GetData()), Snapshot.Num() * 8);
+
+	// Header
+	uint32 Version = 0;
+	Reader.SerializeInt(Version, SnapshotVersion + 1);
+	if (Version != SnapshotVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error: maze snapshot version %d, expected %d"), Version, SnapshotVersion);
+		return false;
+	}
+	int32 SeedValue = 0;
+	Reader << SeedValue;
+	uint32 SizeX = 0;
+	uint32 SizeY = 0;
+	Reader.SerializeInt(SizeX, SnapshotMaxSize + 1);
+	Reader.SerializeInt(SizeY, SnapshotMaxSize + 1);
+	if (Reader.IsError() || SizeX == 0 || SizeY == 0)
+	{
+		return false;
+	}
+	uint32 Start = 0;
+	uint32 End = 0;
+	Reader.SerializeInt(Start, SizeY);
+	Reader.SerializeInt(End, SizeY);
+	uint32 Monsters = 0;
+	uint32 PathLength = 0;
+	uint32 Death = 0;
+	Reader.SerializeIntPacked(Monsters);
+	Reader.SerializeIntPacked(PathLength);
+	Reader.SerializeIntPacked(Death);
+
+	Size = FIntVector(SizeX, SizeY, 0);
+	Seed = SeedValue;
+	StartY = Start;
+	EndY = End;
+	MonsterNumber = Monsters;
+	AIPathLength = PathLength;
+	DeathTimer = Death;
+
+	// Topology, each passage is set on both of its cells
+	PassageMasks.Init(0, Num());
+	BorderMasks.Reset();
+	const uint8 NorthBit = 1 << (uint8)EMazeDirection::North;
+	const uint8 SouthBit = 1 << (uint8)EMazeDirection::South;
+	const uint8 WestBit = 1 << (uint8)EMazeDirection::West;
+	const uint8 EastBit = 1 << (uint8)EMazeDirection::East;
+	for (int i = 0; i < Size.X; i++)
+	{
+		for (int j = 0; j < Size.Y; j++)
+		{
+			if (j + 1 < Size.Y && Reader.ReadBit())
+			{
+				PassageMasks[ToIndex(FIntVector(i, j, 0))] |= NorthBit;
+				PassageMasks[ToIndex(FIntVector(i, j + 1, 0))] |= SouthBit;
+			}
+			if (i + 1 < Size.X && Reader.ReadBit())
+			{
+				PassageMasks[ToIndex(FIntVector(i, j, 0))] |= WestBit;
+				PassageMasks[ToIndex(FIntVector(i + 1, j, 0))] |= EastBit;
+			}
+		}
+	}
+
+	// AI Monster patrols
+	Patrols.Reset(MonsterNumber);
+	for (int i = 0; i < MonsterNumber; i++)
+	{
+		uint32 HomeX = 0;
+		uint32 HomeY = 0;
+		uint32 TargetX = 0;
+		uint32 TargetY = 0;
+		uint32 Length = 0;
+		Reader.SerializeInt(HomeX, SizeX);
+		Reader.SerializeInt(HomeY, SizeY);
+		Reader.SerializeInt(TargetX, SizeX);
+		Reader.SerializeInt(TargetY, SizeY);
+		Reader.SerializeIntPacked(Length);
+
+		FMazePatrol Patrol;
+		Patrol.Home = FIntVector(HomeX, HomeY, 0);
+		Patrol.Target = FIntVector(TargetX, TargetY, 0);
+		Patrol.Length = Length;
+		Patrols.Add(Patrol);
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error: maze snapshot is truncated"));
+		Size = FIntVector(0, 0, 0);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeCell2DArray.h"
+#include "Bool2DArray.h"
+class AActor;
+#include "MazeLayout.generated.h"
+
+/**
+* Patrol of an AI Monster, stored as cell coordinates
+*/
+USTRUCT()
+struct TGWLIHE_API FMazePatrol
+{
+	GENERATED_BODY()
+
+public:
+	// Cell where the AI Monster starts and comes back to
+	UPROPERTY()
+		FIntVector Home;
+
+	// Last cell of the patrol path
+	UPROPERTY()
+		FIntVector Target;
+
+	// Number of cells included in the patrol path
+	UPROPERTY()
+		int32 Length;
+};
+
+/**
+* Topology of a maze level, without any spawned actor: passages, start, end and AI Monster patrols
+* Planning a layout is cheap, so that a level can be prepared long before it is materialized
+*/
+USTRUCT()
+struct TGWLIHE_API FMazeLayout
+{
+	GENERATED_BODY()
+
+public:
+	FMazeLayout();
+
+	// Carves the maze with the backtrack algorithm, then places the start, the end and the AI Monster patrols
+	// The start and the end are on random rows, or the farthest apart along the passages if PlaceStartEndFarthest, the rest of the layout being the same
+	void Plan(int32 SizeX, int32 SizeY, int32 NumberOfMonsters, int32 MonsterPathLength, int32 DeathTimerValue, int32 RandomSeed, bool PlaceStartEndFarthest = false);
+
+	// Plans a region of an unbounded maze, carved from a hash of its coordinates and of the world seed, then opened toward its four neighbor regions
+	void PlanRegion(int32 RegionSize, FIntVector Region, int32 WorldSeed, int32 BorderOpenings);
+
+	// Hash of a region and of the world seed, the salt telling apart the hashes of the same region
+	static uint32 HashRegion(FIntVector Region, int32 WorldSeed, uint32 Salt);
+
+	// Whether or not the layout has been planned
+	bool IsValid() const { return Size.X > 0 && Size.Y > 0; }
+
+	// Number of cells of the layout
+	int32 Num() const { return Size.X * Size.Y; }
+
+	// Verifies whether or not the coordinates are inside the maze
+	bool ContainsCoordinates(FIntVector Coordinates) const;
+
+	// Index of the cell in the flat arrays, X major
+	int32 ToIndex(FIntVector Coordinates) const { return Coordinates.X * Size.Y + Coordinates.Y; }
+
+	// Coordinates of the cell at the given flat index
+	FIntVector ToCoordinates(int32 Index) const { return FIntVector(Index / Size.Y, Index % Size.Y, 0); }
+
+	// Whether or not there is a passage from the cell in the given direction
+	bool HasPassage(FIntVector Coordinates, EMazeDirection Direction) const;
+
+	// Whether or not a region is opened toward its neighbor region, from a cell of its border in the given direction
+	bool HasBorderOpening(FIntVector Coordinates, EMazeDirection Direction) const;
+
+	// Location of the cell relative to the maze actor
+	FVector GetCellRelativeLocation(FIntVector Coordinates) const;
+
+	// Coordinates of the cell containing the location relative to the maze actor, not necessarily inside the maze
+	FIntVector GetCellCoordinates(FVector RelativeLocation) const;
+
+	// Returns random coordinates
+	FIntVector RandomCoordinates(FRandomStream& Stream) const;
+
+	// Carves the whole maze with the backtrack algorithm, on the calling thread
+	void Carve(FRandomStream& Stream);
+
+	// Carves the maze by tiles of TileSize cells, each on a worker thread, then joins the tiles into a single perfect maze
+	void CarveTiles(FRandomStream& Stream, bool IsSingleThreaded = false);
+
+	// Initializes the maze generation by adding a cell to the active cells list
+	void DoFirstGenerationStep(TArray<FIntVector>& ActiveCells, TArray<uint8>& InitializedEdges, FRandomStream& Stream);
+
+	// Carves the next maze cell following a backtrack algorithm
+	void DoNextGenerationStep(TArray<FIntVector>& ActiveCells, TArray<uint8>& InitializedEdges, FRandomStream& Stream);
+
+	// Gives the home and target cells of the patrol path for an AI Monster, and marks the cells of the path as used
+	FMazePatrol CreateAIPath(FRandomStream& Stream, TArray<FBool2DArray>& IsCellUsed) const;
+
+	// Computes the distance, in cells along the passages, from the given cell to every cell (-1 if not reachable)
+	void ComputeDistances(FIntVector From, TArray<int32>& OutDistances) const;
+
+	// Gives the cells at most MaxDistance cells away from a cell along the passages, with their distance, without visiting the others
+	void GetCellsWithin(FIntVector From, int32 MaxDistance, TArray<TPair<FIntVector, int32>>& OutCells) const;
+
+	// Gives the cells along the passages from a cell to another, both included, returns false if there is no path
+	bool FindPath(FIntVector From, FIntVector To, TArray<FIntVector>& OutPath) const;
+
+	// Whether or not a cell can be seen from another one: both on the same row or column, without a wall between them
+	bool IsInSight(FIntVector From, FIntVector To) const;
+
+	// Number of cells of the path from the start to the end, the start and the end included
+	int32 GetSolutionLength() const;
+
+	// Number of cells with only one passage
+	int32 CountDeadEnds() const;
+
+	// Verifies that the layout is a perfect maze (every cell reachable, no loop) and that its start, end and patrols are inside it
+	bool Validate() const;
+
+	// Packs the layout in a few bits per cell, enough to restore it later without carving nor planning again
+	void SaveSnapshot(TArray<uint8>& OutSnapshot) const;
+
+	// Restores a layout packed by SaveSnapshot, returns false if the snapshot is invalid
+	bool LoadSnapshot(const TArray<uint8>& Snapshot);
+
+public:
+	// Distance between the centers of two adjacent cells
+	static const int32 CellSpacing = 500;
+
+	// Version of the snapshot format, to increment whenever SaveSnapshot changes
+	static const uint32 SnapshotVersion = 1;
+
+	// Largest size along an axis that a snapshot can hold
+	static const uint32 SnapshotMaxSize = 1 << 12;
+
+	// Size of the tiles a maze larger than one is carved by, one tile per task
+	static const int32 TileSize = 64;
+
+	// Size Vector, Z-axis is not used
+	UPROPERTY()
+		FIntVector Size;
+
+	// Seed used to plan this layout, planning again with the same seed and parameters gives the same layout
+	UPROPERTY()
+		int32 Seed;
+
+	// Y coordinate of the start cell, always on the first column
+	UPROPERTY()
+		int32 StartY;
+
+	// Y coordinate of the end cell, always on the last column
+	UPROPERTY()
+		int32 EndY;
+
+	// Number of AI Monsters
+	UPROPERTY()
+		int32 MonsterNumber;
+
+	// Number of cells the AI Monsters should include in their patrol
+	UPROPERTY()
+		int32 AIPathLength;
+
+	// Time before Death arrives, 0 if there is no Death in this level
+	UPROPERTY()
+		int32 DeathTimer;
+
+	// One mask per cell, bit i set if there is a passage in the direction i
+	UPROPERTY()
+		TArray<uint8> PassageMasks;
+
+	// For a region, one mask per cell, bit i set if the region is opened toward its neighbor in the direction i: empty otherwise
+	// Apart from the passages, so that every passage leads to a cell of the layout
+	UPROPERTY()
+		TArray<uint8> BorderMasks;
+
+	// Patrol of each AI Monster
+	UPROPERTY()
+		TArray<FMazePatrol> Patrols;
+
+private:
+	// Moves the end to the cell of the last column the farthest from the start, then the start to the cell of the first column the farthest from this end
+	// Two walks of the distances: the pair is not always the farthest one, but the solution is never shorter than with the random rows
+	void PlaceStartEndFarthestApart();
+
+	// Opens the border of a region in the given direction, in BorderMasks, at positions given by the hash of the border
+	void OpenRegionBorder(uint32 BorderHash, EMazeDirection Direction, int32 Openings);
+
+	// Opens a passage between the cell and its neighbor in the given direction, both inside the layout
+	void OpenPassage(FIntVector Coordinates, EMazeDirection Direction);
+
+	// Opens a passage, or closes the edge with a wall, between the cell and its neighbor in the given direction
+	void SetEdge(FIntVector Coordinates, EMazeDirection Direction, ECellEdgeType Type, TArray<uint8>& InitializedEdges);
+
+	// Gives an unbiased random uninitialized direction of the cell
+	EMazeDirection RandomUninitializedDirection(uint8 InitializedMask, FRandomStream& Stream) const;
+
+	// Picks a random cell which has a passage with the cell in parameter and is not yet used for the AI, returns false if there is none
+	bool RandomUsableNeighborCell(FIntVector Coordinates, FRandomStream& Stream, TArray<FBool2DArray>& IsCellUsed, FIntVector& OutNeighbor) const;
+};
+
+/**
+* A maze level being materialized: its layout and the actors spawned for it so far
+*/
+USTRUCT()
+struct TGWLIHE_API FMazeLevelBuffer
+{
+	GENERATED_BODY()
+
+public:
+	// Topology of the level
+	UPROPERTY()
+		FMazeLayout Layout;
+
+	// 2D array storing the cells spawned so far
+	UPROPERTY()
+		TArray<FMazeCell2DArray> Cells;
+
+	// Every actor spawned for this level (cells, walls, passages), used to reveal or tear down the level
+	UPROPERTY()
+		TArray<AActor*> Actors;
+
+	// Number of cells already spawned, in the flat index order of the layout
+	UPROPERTY()
+		int32 MaterializedCellCount;
+
+	// Whether or not the spawned actors are hidden and without collision
+	UPROPERTY()
+		bool IsHidden;
+
+	// Whether or not the level is a region of an unbounded maze, whose borders are stitched to the neighbor regions
+	UPROPERTY()
+		bool IsRegion;
+
+	// Location of the level relative to the maze actor, added to the locations of its cells: a region of an unbounded maze, or a floor
+	UPROPERTY()
+		FVector LevelOffset;
+
+	FMazeLevelBuffer()
+		: MaterializedCellCount(0)
+		, IsHidden(false)
+		, IsRegion(false)
+		, LevelOffset(FVector::ZeroVector)
+	{
+	}
+
+	// Whether or not every cell of the layout has been spawned
+	bool IsFullyMaterialized() const { return Layout.IsValid() && MaterializedCellCount >= Layout.Num(); }
+};
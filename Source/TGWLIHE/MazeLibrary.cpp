@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeLibrary.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "Serialization/Archive.h"
+
+FMazeLibrary::FMazeLibrary()
+	: Header(nullptr)
+	, Index(nullptr)
+{
+}
+
+FMazeLibrary::~FMazeLibrary()
+{
+	// The region has to be unmapped before the file is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	FileHandle.Reset();
+}
+
+bool FMazeLibrary::Open(const FString& Filename)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	// Preferably, we map the whole file: pages are only loaded when an entry is used
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	const uint8* Data = nullptr;
+	int64 DataSize = 0;
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		DataSize = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		// Otherwise, we only read the header and the index, the snapshots are read when used
+		MappedFile.Reset();
+		FileHandle.Reset(PlatformFile.OpenRead(*Filename));
+		if (!FileHandle.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Error: maze library %s not found"), *Filename);
+			return false;
+		}
+
+		FMazeLibraryHeader FileHeader;
+		if (!FileHandle->Read((uint8*)&FileHeader, sizeof(FileHeader)) || FileHeader.Magic != Magic || FileHeader.Version != Version)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Error: %s is not a maze library"), *Filename);
+			FileHandle.Reset();
+			return false;
+		}
+
+		// The entry count is checked against the file size before allocating the index, so that a corrupted header cannot make us allocate gigabytes
+		const int64 IndexSize = sizeof(FMazeLibraryHeader) + (int64)FileHeader.EntryCount * sizeof(FMazeLibraryIndexEntry);
+		if (IndexSize > FileHandle->Size())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Error: maze library %s is truncated"), *Filename);
+			FileHandle.Reset();
+			return false;
+		}
+
+		IndexData.SetNumUninitialized(IndexSize);
+		FMemory::Memcpy(IndexData.GetData(), &FileHeader, sizeof(FileHeader));
+		if (!FileHandle->Read(IndexData.GetData() + sizeof(FileHeader), IndexData.Num() - sizeof(FileHeader)))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Error: cannot read the index of the maze library %s"), *Filename);
+			FileHandle.Reset();
+			IndexData.Empty();
+			return false;
+		}
+		Data = IndexData.GetData();
+		DataSize = FileHandle->Size();
+	}
+
+	// The header and the index are used in place, without parsing
+	const FMazeLibraryHeader* FileHeader = (const FMazeLibraryHeader*)Data;
+	if (DataSize < (int64)sizeof(FMazeLibraryHeader) || FileHeader->Magic != Magic || FileHeader->Version != Version
+		|| DataSize < (int64)sizeof(FMazeLibraryHeader) + (int64)FileHeader->EntryCount * sizeof(FMazeLibraryIndexEntry))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error: maze library %s is invalid"), *Filename);
+		MappedRegion.Reset();
+		MappedFile.Reset();
+		FileHandle.Reset();
+		IndexData.Empty();
+		return false;
+	}
+
+	Header = FileHeader;
+	Index = (const FMazeLibraryIndexEntry*)(Data + sizeof(FMazeLibraryHeader));
+
+	// By default, every maze can be picked
+	Filter(0, MAX_int32);
+
+	UE_LOG(LogTemp, Warning, TEXT("Maze library %s opened: %d mazes, %s"), *Filename, Num(), MappedRegion.IsValid() ? TEXT("mapped") : TEXT("not mapped"));
+	return true;
+}
+
+int32 FMazeLibrary::Num() const
+{
+	return Header ? Header->EntryCount : 0;
+}
+
+const FMazeLibraryIndexEntry& FMazeLibrary::GetEntry(int32 EntryIndex) const
+{
+	check(EntryIndex >= 0 && EntryIndex < Num());
+	return Index[EntryIndex];
+}
+
+void FMazeLibrary::Filter(int32 MinSolutionLength, int32 MaxSolutionLength)
+{
+	// Only the index is read here
+	Candidates.Reset();
+	for (int32 i = 0; i < Num(); i++)
+	{
+		if (Index[i].SolutionLength >= MinSolutionLength && Index[i].SolutionLength <= MaxSolutionLength)
+		{
+			Candidates.Add(i);
+		}
+	}
+}
+
+int32 FMazeLibrary::PickEntry(FRandomStream& Stream) const
+{
+	if (Candidates.Num() == 0)
+	{
+		return -1;
+	}
+	return Candidates[Stream.RandRange(0, Candidates.Num() - 1)];
+}
+
+bool FMazeLibrary::LoadLayout(int32 EntryIndex, FMazeLayout& OutLayout) const
+{
+	if (EntryIndex < 0 || EntryIndex >= Num())
+	{
+		return false;
+	}
+
+	const FMazeLibraryIndexEntry& Entry = Index[EntryIndex];
+	TArray<uint8> Snapshot;
+	Snapshot.SetNumUninitialized(Entry.Size);
+
+	if (MappedRegion.IsValid())
+	{
+		if ((int64)Entry.Offset + Entry.Size > MappedRegion->GetMappedSize())
+		{
+			return false;
+		}
+		FMemory::Memcpy(Snapshot.GetData(), MappedRegion->GetMappedPtr() + Entry.Offset, Entry.Size);
+	}
+	else if (!FileHandle.IsValid() || !FileHandle->Seek(Entry.Offset) || !FileHandle->Read(Snapshot.GetData(), Entry.Size))
+	{
+		return false;
+	}
+
+	return OutLayout.LoadSnapshot(Snapshot);
+}
+
+bool FMazeLibrary::Write(const FString& Filename, const TArray<FMazeLayout>& Layouts)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Error: cannot write the maze library %s"), *Filename);
+		return false;
+	}
+
+	// First, the snapshots, to know where each of them will be
+	TArray<FMazeLibraryIndexEntry> Entries;
+	TArray<uint8> Snapshots;
+	uint32 SnapshotsOffset = sizeof(FMazeLibraryHeader) + Layouts.Num() * sizeof(FMazeLibraryIndexEntry);
+	for (const FMazeLayout& Layout : Layouts)
+	{
+		TArray<uint8> Snapshot;
+		Layout.SaveSnapshot(Snapshot);
+
+		FMazeLibraryIndexEntry Entry;
+		Entry.Offset = SnapshotsOffset + Snapshots.Num();
+		Entry.Size = Snapshot.Num();
+		Entry.SizeX = Layout.Size.X;
+		Entry.SizeY = Layout.Size.Y;
+		Entry.SolutionLength = Layout.GetSolutionLength();
+		Entry.DeadEnds = Layout.CountDeadEnds();
+		Entries.Add(Entry);
+		Snapshots.Append(Snapshot);
+	}
+
+	// Then, the file: header, index, snapshots
+	FMazeLibraryHeader FileHeader;
+	FileHeader.Magic = Magic;
+	FileHeader.Version = Version;
+	FileHeader.EntryCount = Layouts.Num();
+	FileHeader.Reserved = 0;
+	Writer->Serialize(&FileHeader, sizeof(FileHeader));
+	Writer->Serialize(Entries.GetData(), Entries.Num() * sizeof(FMazeLibraryIndexEntry));
+	Writer->Serialize(Snapshots.GetData(), Snapshots.Num());
+
+	return Writer->Close();
+}
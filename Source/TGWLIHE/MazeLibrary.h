@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeLayout.h"
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+* Header of a maze library file, followed by the fixed-size index, then by the maze snapshots
+*/
+struct FMazeLibraryHeader
+{
+	// Identifies a maze library file
+	uint32 Magic;
+
+	// Version of the file format
+	uint32 Version;
+
+	// Number of mazes in the library
+	uint32 EntryCount;
+
+	// Padding, so that the index is aligned
+	uint32 Reserved;
+};
+
+/**
+* Entry of the library index: where the snapshot of a maze is, and its difficulty metrics to filter mazes without reading them
+*/
+struct FMazeLibraryIndexEntry
+{
+	// Offset of the snapshot from the beginning of the file
+	uint32 Offset;
+
+	// Size of the snapshot in bytes
+	uint32 Size;
+
+	// Size of the maze
+	uint16 SizeX;
+	uint16 SizeY;
+
+	// Number of cells from the start to the end
+	uint16 SolutionLength;
+
+	// Number of cells with only one passage
+	uint16 DeadEnds;
+};
+
+static_assert(sizeof(FMazeLibraryHeader) == 16, "The maze library header is read straight from the file");
+static_assert(sizeof(FMazeLibraryIndexEntry) == 16, "The maze library index is read straight from the file");
+
+/**
+* Library of pregenerated mazes, baked offline by the BakeMazeLibrary commandlet
+* The file is memory-mapped: opening it reads nothing, and picking a maze only touches its index entry and its snapshot
+*/
+class TGWLIHE_API FMazeLibrary
+{
+public:
+	FMazeLibrary();
+	~FMazeLibrary();
+
+	// Maps the library file, returns false if it is missing or invalid
+	bool Open(const FString& Filename);
+
+	// Whether or not a library is open
+	bool IsOpen() const { return Header != nullptr; }
+
+	// Number of mazes in the library
+	int32 Num() const;
+
+	// Index entry of the maze
+	const FMazeLibraryIndexEntry& GetEntry(int32 Index) const;
+
+	// Keeps only the mazes whose solution length is within the range, for PickEntry
+	void Filter(int32 MinSolutionLength, int32 MaxSolutionLength);
+
+	// Returns a random maze among the filtered ones, -1 if there is none
+	int32 PickEntry(FRandomStream& Stream) const;
+
+	// Restores the layout of the maze, returns false if the snapshot is invalid
+	bool LoadLayout(int32 Index, FMazeLayout& OutLayout) const;
+
+	// Writes a library file from layouts, used by the commandlet
+	static bool Write(const FString& Filename, const TArray<FMazeLayout>& Layouts);
+
+public:
+	// Identifies a maze library file
+	static const uint32 Magic = 0x424C5A4D; // "MZLB"
+
+	// Version of the file format
+	static const uint32 Version = 1;
+
+private:
+	// Mapped file, nullptr if the platform cannot map files
+	TUniquePtr<IMappedFileHandle> MappedFile;
+
+	// Whole file mapped in memory
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Used instead of the mapping where it is not supported: the index is read once, the snapshots on demand
+	TUniquePtr<IFileHandle> FileHandle;
+
+	// Copy of the header and index when the file is not mapped
+	TArray<uint8> IndexData;
+
+	// Header, in the mapped file or in IndexData
+	const FMazeLibraryHeader* Header;
+
+	// Index, in the mapped file or in IndexData
+	const FMazeLibraryIndexEntry* Index;
+
+	// Mazes kept by the filter
+	TArray<int32> Candidates;
+};
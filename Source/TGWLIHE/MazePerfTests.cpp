@@ -0,0 +1,375 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Performance budgets of the maze generation, runnable headless, for instance on Linux:
+// UE4Editor TGWLIHE.uproject -game -nullrhi -nosound -unattended -ExecCmds="Automation RunTests TGWLIHE.Perf; Quit"
+
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectHash.h"
+#include "Engine/Level.h"
+#include "Maze.h"
+#include "MazeLayout.h"
+#include "MazeBitboard.h"
+#include "MazeGridMovement.h"
+#include "AICharacter.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MazePerfTests
+{
+	/**
+	* Budgets of a level size: they are several times what a development build takes, so that only real regressions fail
+	*/
+	struct FLevelBudget
+	{
+		int32 SizeX;
+		int32 SizeY;
+		int32 NumberOfMonsters;
+		int32 MonsterPathLength;
+
+		// Planning the layout: carving, start, end and patrols
+		double PlanMs;
+
+		// Spawning every cell, wall and passage of the level
+		double SpawnMs;
+
+		// Destroying them and collecting the garbage
+		double TeardownMs;
+	};
+
+	// Every scripted level size, then the largest endless one
+	static const FLevelBudget Budgets[] =
+	{
+		{ 4, 4, 0, 0, 1.0, 50.0, 100.0 },
+		{ 7, 7, 0, 0, 1.0, 100.0, 100.0 },
+		{ 20, 1, 1, 10, 1.0, 100.0, 100.0 },
+		{ 8, 8, 2, 15, 1.0, 150.0, 150.0 },
+		{ 10, 10, 5, 15, 2.0, 200.0, 200.0 },
+		{ 15, 15, 8, 20, 4.0, 400.0, 300.0 },
+		{ 30, 30, 30, 30, 15.0, 1500.0, 800.0 }
+	};
+
+	// Number of objects in the level of the test world, actors and their components: only the test spawns there, unlike the process memory
+	static int32 GetLevelObjectCount(UWorld* World)
+	{
+		TArray<UObject*> Objects;
+		GetObjectsWithOuter(World->PersistentLevel, Objects, true);
+		return Objects.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeGenerationPerfTest, "TGWLIHE.Perf.Maze.GenerateAndTeardown", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMazeGenerationPerfTest::RunTest(const FString& Parameters)
+{
+	// A world of its own, which does not begin play: only the maze actors are spawned in it, the blueprints are loaded here instead of streamed
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MazePerfTestWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	AMaze* Maze = World->SpawnActor<AMaze>(AMaze::StaticClass());
+	if (!TestNotNull(TEXT("Maze spawned"), Maze) || !TestNotNull(TEXT("Cell blueprint"), Maze->CellBlueprint.LoadSynchronous()) || !TestNotNull(TEXT("Wall blueprint"), Maze->WallBlueprint.LoadSynchronous()) || !TestNotNull(TEXT("Passage blueprint"), Maze->PassageBlueprint.LoadSynchronous()))
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	// The level is spawned visible, as when it is generated during the transition
+	Maze->MaterializeNextLevel = false;
+
+	// A first level, so that the allocators, the blueprints and their meshes are already warm when the level is timed
+	FMazeLayout WarmUpLayout;
+	WarmUpLayout.Plan(4, 4, 0, 0, 0, 0);
+	Maze->PrepareNextLevel(WarmUpLayout);
+	Maze->CompleteNextLevel();
+	Maze->DiscardNextLevel();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	for (const MazePerfTests::FLevelBudget& Budget : MazePerfTests::Budgets)
+	{
+		const FString Context = FString::Printf(TEXT("%dx%d"), Budget.SizeX, Budget.SizeY);
+		const int32 ObjectsBefore = MazePerfTests::GetLevelObjectCount(World);
+
+		double StartTime = FPlatformTime::Seconds();
+		FMazeLayout Layout;
+		Layout.Plan(Budget.SizeX, Budget.SizeY, Budget.NumberOfMonsters, Budget.MonsterPathLength, 0, Budget.SizeX * 31 + Budget.SizeY);
+		const double PlanMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		StartTime = FPlatformTime::Seconds();
+		Maze->PrepareNextLevel(Layout);
+		Maze->CompleteNextLevel();
+		const double SpawnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		const int32 SpawnedObjects = MazePerfTests::GetLevelObjectCount(World) - ObjectsBefore;
+
+		StartTime = FPlatformTime::Seconds();
+		Maze->DiscardNextLevel();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		const double TeardownMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		const int32 RetainedObjects = MazePerfTests::GetLevelObjectCount(World) - ObjectsBefore;
+
+		AddInfo(FString::Printf(TEXT("Maze %s: plan %.3f ms, spawn %.2f ms of %d objects, teardown %.2f ms, %d objects retained"), *Context, PlanMs, SpawnMs, SpawnedObjects, TeardownMs, RetainedObjects));
+		TestTrue(FString::Printf(TEXT("Plan %s within %.1f ms (took %.3f ms)"), *Context, Budget.PlanMs, PlanMs), PlanMs <= Budget.PlanMs);
+		TestTrue(FString::Printf(TEXT("Spawn %s within %.1f ms (took %.2f ms)"), *Context, Budget.SpawnMs, SpawnMs), SpawnMs <= Budget.SpawnMs);
+		TestTrue(FString::Printf(TEXT("Teardown %s within %.1f ms (took %.2f ms)"), *Context, Budget.TeardownMs, TeardownMs), TeardownMs <= Budget.TeardownMs);
+		TestEqual(FString::Printf(TEXT("Objects retained after %s"), *Context), RetainedObjects, 0);
+	}
+
+	Maze->Destroy();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeSnapshotPerfTest, "TGWLIHE.Perf.Maze.Snapshot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMazeSnapshotPerfTest::RunTest(const FString& Parameters)
+{
+	// Saving and restoring the largest level, as done at each level start and each Death retry
+	static const int32 Iterations = 100;
+	static const double BudgetMs = 1.0;
+
+	FMazeLayout Layout;
+	Layout.Plan(30, 30, 30, 30, 240, 0);
+
+	TArray<uint8> Snapshot;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; i++)
+	{
+		Layout.SaveSnapshot(Snapshot);
+	}
+	const double SaveMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+	FMazeLayout Restored;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Iterations; i++)
+	{
+		Restored.LoadSnapshot(Snapshot);
+	}
+	const double LoadMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+	AddInfo(FString::Printf(TEXT("30x30 snapshot: %d bytes, save %.4f ms, load %.4f ms"), Snapshot.Num(), SaveMs, LoadMs));
+	TestTrue(FString::Printf(TEXT("Snapshot save within %.1f ms (took %.4f ms)"), BudgetMs, SaveMs), SaveMs <= BudgetMs);
+	TestTrue(FString::Printf(TEXT("Snapshot load within %.1f ms (took %.4f ms)"), BudgetMs, LoadMs), LoadMs <= BudgetMs);
+	TestTrue(TEXT("30x30 snapshot within 1 KB"), Snapshot.Num() <= 1024);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeTilesPerfTest, "TGWLIHE.Perf.Maze.Tiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMazeTilesPerfTest::RunTest(const FString& Parameters)
+{
+	// A maze of a million cells, carved by the backtracker alone, then by tiles on a single thread, then by tiles on every core
+	static const int32 Size = 1024;
+
+	FMazeLayout Layout;
+	Layout.Size = FIntVector(Size, Size, 0);
+	double CarveMs[3];
+	for (int32 Mode = 0; Mode < 3; Mode++)
+	{
+		FRandomStream Stream(0);
+		const double StartTime = FPlatformTime::Seconds();
+		if (Mode == 0)
+		{
+			Layout.Carve(Stream);
+		}
+		else
+		{
+			Layout.CarveTiles(Stream, Mode == 1);
+		}
+		CarveMs[Mode] = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		TestTrue(FString::Printf(TEXT("Perfect maze (mode %d)"), Mode), Layout.Validate());
+	}
+
+	const int32 WorkerCount = FTaskGraphInterface::Get().GetNumWorkerThreads();
+	AddInfo(FString::Printf(TEXT("%dx%d carve: backtracker %.1f ms, tiles on one thread %.1f ms, tiles on %d workers %.1f ms (x%.2f)"),
+		Size, Size, CarveMs[0], CarveMs[1], WorkerCount, CarveMs[2], CarveMs[1] / FMath::Max(CarveMs[2], 0.001)));
+
+	// The tiles only pay off with several cores, and only by some margin with the join and the scheduling
+	if (WorkerCount >= 2)
+	{
+		TestTrue(FString::Printf(TEXT("Tiles faster on %d workers (%.1f ms) than on one thread (%.1f ms)"), WorkerCount, CarveMs[2], CarveMs[1]), CarveMs[2] < CarveMs[1] * 0.9);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeBitboardPerfTest, "TGWLIHE.Perf.Maze.Bitboard", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMazeBitboardPerfTest::RunTest(const FString& Parameters)
+{
+	// The grid queries on packed bits against the breadth first searches of the layout, on a large grid and on the largest level
+	static const FIntPoint Sizes[] = { FIntPoint(30, 30), FIntPoint(256, 256), FIntPoint(1024, 1024) };
+	static const int32 QueryCount = 1000;
+	static const int32 HearingRadius = 8;
+
+	for (const FIntPoint& Size : Sizes)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(Size.X, Size.Y, 0, 0, 0, 0);
+		FMazeBitboard Bitboard;
+		Bitboard.Build(Layout);
+		const FIntVector Start(0, Layout.StartY, 0);
+
+		// Everything reachable from the start
+		double StartTime = FPlatformTime::Seconds();
+		TArray<int32> Distances;
+		Layout.ComputeDistances(Start, Distances);
+		const double ScalarFillMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		StartTime = FPlatformTime::Seconds();
+		FMazeCellSet Reached;
+		Reached.Init(Layout.Size);
+		Reached.Add(Start);
+		Bitboard.FloodFill(Reached);
+		const double BitboardFillMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		TestEqual(FString::Printf(TEXT("Same cells reached (%dx%d)"), Size.X, Size.Y), Reached.Num(), Layout.Num());
+
+		// The cells a footstep is heard in, from random cells
+		FRandomStream Stream(0);
+		TArray<FIntVector> From;
+		for (int32 i = 0; i < QueryCount; i++)
+		{
+			From.Add(Layout.RandomCoordinates(Stream));
+		}
+
+		int32 ScalarCount = 0;
+		StartTime = FPlatformTime::Seconds();
+		TArray<TPair<FIntVector, int32>> ScalarWithin;
+		for (const FIntVector& Cell : From)
+		{
+			Layout.GetCellsWithin(Cell, HearingRadius, ScalarWithin);
+			ScalarCount += ScalarWithin.Num();
+		}
+		const double ScalarWithinUs = (FPlatformTime::Seconds() - StartTime) * 1000000.0 / QueryCount;
+
+		int32 BitboardCount = 0;
+		StartTime = FPlatformTime::Seconds();
+		FMazeCellSet Within;
+		for (const FIntVector& Cell : From)
+		{
+			Bitboard.GetCellsWithin(Cell, HearingRadius, Within);
+			BitboardCount += Within.Num();
+		}
+		const double BitboardWithinUs = (FPlatformTime::Seconds() - StartTime) * 1000000.0 / QueryCount;
+		TestEqual(FString::Printf(TEXT("Same cells within %d (%dx%d)"), HearingRadius, Size.X, Size.Y), BitboardCount, ScalarCount);
+
+		AddInfo(FString::Printf(TEXT("%dx%d: flood fill %.3f ms (scalar %.3f ms), cells within %d %.2f us (scalar %.2f us)"),
+			Size.X, Size.Y, BitboardFillMs, ScalarFillMs, HearingRadius, BitboardWithinUs, ScalarWithinUs));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeAIMovementPerfTest, "TGWLIHE.Perf.AI.Movement", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FMazeAIMovementPerfTest::RunTest(const FString& Parameters)
+{
+	// Hundreds of monsters walking their patrols in the largest level, with the character movement, then with the grid movement
+	static const int32 AgentCount = 300;
+	static const int32 FrameCount = 120;
+	static const float DeltaTime = 1.0f / 60.0f;
+	static const double GridBudgetUs = 10.0;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MazeAIMovementPerfTestWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	// Only a floor under the whole maze: the walls do not change the cost of the grid movement, which never sweeps
+	FMazeLayout Layout;
+	Layout.Plan(30, 30, 30, 30, 0, 0);
+	AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(FVector(0.0f, 0.0f, -50.0f), FRotator::ZeroRotator);
+	Floor->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+	Floor->SetActorScale3D(FVector(Layout.Size.X * FMazeLayout::CellSpacing / 100.0f, Layout.Size.Y * FMazeLayout::CellSpacing / 100.0f, 1.0f));
+
+	double MovementUs[2] = { 0.0, 0.0 };
+	for (int32 Mode = 0; Mode < 2; Mode++)
+	{
+		const bool IsGrid = Mode == 1;
+
+		// Every agent walks one of the patrols of the layout, toward its target
+		TArray<AAICharacter*> Agents;
+		TArray<TArray<FIntVector>> Paths;
+		for (int32 i = 0; i < AgentCount; i++)
+		{
+			const FMazePatrol& Patrol = Layout.Patrols[i % Layout.Patrols.Num()];
+			AAICharacter* Agent = World->SpawnActor<AAICharacter>(Layout.GetCellRelativeLocation(Patrol.Home) + FVector(0.0f, 0.0f, 100.0f), FRotator::ZeroRotator);
+			if (IsGrid)
+			{
+				Agent->EnableGridMovement();
+				Agent->GetGridMovement()->SetGrid(Layout, FTransform::Identity);
+				Agent->GetGridMovement()->Patrol(Patrol.Home, Patrol.Target);
+			}
+			else
+			{
+				Agent->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+				Agent->GetCharacterMovement()->MaxWalkSpeed = 50.0f;
+			}
+			Agents.Add(Agent);
+			Paths.AddDefaulted();
+			Layout.FindPath(Patrol.Home, Patrol.Target, Paths.Last());
+		}
+
+		double TotalSeconds = 0.0;
+		float TotalDistance = 0.0f;
+		for (int32 Frame = 0; Frame < FrameCount; Frame++)
+		{
+			for (int32 i = 0; i < AgentCount; i++)
+			{
+				AAICharacter* Agent = Agents[i];
+				UPawnMovementComponent* Movement = Agent->GetMovementComponent();
+				const FVector OldLocation = Agent->GetActorLocation();
+
+				// The character movement is given the direction of the next cell, as the path following would
+				if (!IsGrid)
+				{
+					TArray<FIntVector>& Path = Paths[i];
+					while (Path.Num() > 1 && FVector::Dist2D(OldLocation, Layout.GetCellRelativeLocation(Path[0])) < 25.0f)
+					{
+						Path.RemoveAt(0);
+					}
+					Agent->AddMovementInput((Layout.GetCellRelativeLocation(Path[0]) - OldLocation).GetSafeNormal2D());
+				}
+
+				const double StartTime = FPlatformTime::Seconds();
+				Movement->TickComponent(DeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+				TotalSeconds += FPlatformTime::Seconds() - StartTime;
+				TotalDistance += FVector::Dist2D(OldLocation, Agent->GetActorLocation());
+			}
+		}
+		MovementUs[Mode] = TotalSeconds * 1000000.0 / (AgentCount * FrameCount);
+
+		const TCHAR* ModeName = IsGrid ? TEXT("grid movement") : TEXT("character movement");
+		AddInfo(FString::Printf(TEXT("%d agents with the %s: %.2f us per agent per frame, %.0f walked on average"), AgentCount, ModeName, MovementUs[Mode], TotalDistance / AgentCount));
+		TestTrue(FString::Printf(TEXT("Agents walk with the %s"), ModeName), TotalDistance > 0.0f);
+
+		for (AAICharacter* Agent : Agents)
+		{
+			Agent->Destroy();
+		}
+	}
+
+	TestTrue(FString::Printf(TEXT("Grid movement within %.1f us per agent (took %.2f us)"), GridBudgetUs, MovementUs[1]), MovementUs[1] <= GridBudgetUs);
+	TestTrue(FString::Printf(TEXT("Grid movement cheaper than the character movement (%.2f us against %.2f us)"), MovementUs[1], MovementUs[0]), MovementUs[1] < MovementUs[0]);
+
+	Floor->Destroy();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
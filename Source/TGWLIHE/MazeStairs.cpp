@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeStairs.h"
+#include "Components/BoxComponent.h"
+#include "AmazeingCharacter.h"
+#include "Maze.h"
+
+// Sets default values
+AMazeStairs::AMazeStairs()
+{
+	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = false;
+
+	// A third of a cell, in its middle, so that the walls are never touched
+	Trigger = CreateDefaultSubobject<UBoxComponent>(TEXT("Trigger"));
+	Trigger->InitBoxExtent(FVector(80.0f, 80.0f, 100.0f));
+	Trigger->SetCollisionProfileName(TEXT("Trigger"));
+	RootComponent = Trigger;
+
+	// We register the events
+	OnActorBeginOverlap.AddDynamic(this, &AMazeStairs::OnOverlapBegin);
+	OnActorEndOverlap.AddDynamic(this, &AMazeStairs::OnOverlapEnd);
+
+	Maze = nullptr;
+	DestinationFloor = 0;
+	IsArmed = true;
+}
+
+void AMazeStairs::Initialize(AMaze* InMaze, FIntVector InCoordinates, int32 InDestinationFloor)
+{
+	Maze = InMaze;
+	Coordinates = InCoordinates;
+	DestinationFloor = InDestinationFloor;
+}
+
+void AMazeStairs::OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor)
+{
+	if (IsArmed && Maze && Cast<AAmazeingCharacter>(OtherActor))
+	{
+		Maze->TakeStairs(this);
+	}
+}
+
+void AMazeStairs::OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor)
+{
+	if (Cast<AAmazeingCharacter>(OtherActor))
+	{
+		IsArmed = true;
+	}
+}
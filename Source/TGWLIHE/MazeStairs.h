@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "MazeStairs.generated.h"
+
+/**
+* End of the stairs between two floors of a multi-floor maze: the player stepping in is taken to the other end, on the other floor
+*/
+UCLASS(NotPlaceable)
+class TGWLIHE_API AMazeStairs : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	AMazeStairs();
+
+	// Sets the cell of the stairs, Z being its floor, and the floor it leads to
+	void Initialize(class AMaze* InMaze, FIntVector InCoordinates, int32 InDestinationFloor);
+
+	// The player arrives on these stairs: they are not taken again until the player has stepped out
+	void Disarm() { IsArmed = false; }
+
+	// Overlap functions
+	UFUNCTION()
+		void OnOverlapBegin(class AActor* OverlappedActor, class AActor* OtherActor);
+
+	UFUNCTION()
+		void OnOverlapEnd(class AActor* OverlappedActor, class AActor* OtherActor);
+
+public:
+	// Cell of the stairs, Z being its floor
+	UPROPERTY(VisibleAnywhere)
+		FIntVector Coordinates;
+
+	// Floor the stairs lead to
+	UPROPERTY(VisibleAnywhere)
+		int32 DestinationFloor;
+
+private:
+	// Volume stepped in by the player
+	UPROPERTY(VisibleAnywhere)
+		class UBoxComponent* Trigger;
+
+	UPROPERTY()
+		class AMaze* Maze;
+
+	// Whether or not the player stepping in takes the stairs
+	bool IsArmed;
+};
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeStats.h"
+
+DEFINE_STAT(STAT_MazeCells);
+DEFINE_STAT(STAT_MazeWalls);
+DEFINE_STAT(STAT_MazePassages);
+DEFINE_STAT(STAT_MazeNextLevelActors);
+DEFINE_STAT(STAT_MazeMonsters);
@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// "stat Maze": maze generation, transitions and gameplay
+DECLARE_STATS_GROUP(TEXT("Maze"), STATGROUP_Maze, STATCAT_Advanced);
+
+// "stat MazeAI": AI Monsters and Death
+DECLARE_STATS_GROUP(TEXT("MazeAI"), STATGROUP_MazeAI, STATCAT_Advanced);
+
+// Live actors of the maze
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cells"), STAT_MazeCells, STATGROUP_Maze, TGWLIHE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Walls"), STAT_MazeWalls, STATGROUP_Maze, TGWLIHE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Passages"), STAT_MazePassages, STATGROUP_Maze, TGWLIHE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Next level actors (hidden)"), STAT_MazeNextLevelActors, STATGROUP_Maze, TGWLIHE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("AI characters (Monsters and Death)"), STAT_MazeMonsters, STATGROUP_MazeAI, TGWLIHE_API);
@@ -0,0 +1,390 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeTelemetry.h"
+#include "Maze.h"
+#include "EndTriggerVolume.h"
+#include "Engine/World.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectArray.h"
+#include "UObject/UObjectGlobals.h"
+#include "Serialization/JsonWriter.h"
+
+TMap<const TCHAR*, uint64> FMazeLevelRecorder::FrameScopeCycles;
+
+// Time spent in the nested scopes of each open scope, to get the exclusive time of a scope
+static TArray<uint64> OpenScopeChildCycles;
+
+FMazeTelemetryScope::FMazeTelemetryScope(const TCHAR* InName)
+	: Name(IsInGameThread() ? InName : nullptr)
+	, StartCycles(0)
+{
+	if (Name)
+	{
+		OpenScopeChildCycles.Add(0);
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+FMazeTelemetryScope::~FMazeTelemetryScope()
+{
+	if (Name)
+	{
+		uint64 Cycles = FPlatformTime::Cycles64() - StartCycles;
+		uint64 ChildCycles = OpenScopeChildCycles.Pop(false);
+		FMazeLevelRecorder::AddScopeCycles(Name, Cycles - ChildCycles);
+
+		// The whole scope is a child of the one it is nested in
+		if (OpenScopeChildCycles.Num() > 0)
+		{
+			OpenScopeChildCycles.Last() += Cycles;
+		}
+	}
+}
+
+FMazeLevelRecorder::FMazeLevelRecorder()
+	: HitchThresholdMs(50.0f)
+	, LevelIndex(-1)
+	, IsLastLevel(false)
+	, IsRetry(false)
+	, IsPlaying(false)
+	, LevelStartTime(0.0)
+	, PlayStartTime(0.0)
+	, LastFrameTime(0.0)
+	, HitchCount(0)
+	, GarbageCollectionCount(0)
+	, GarbageCollectionTotalMs(0.0f)
+	, GarbageCollectionMaxMs(0.0f)
+	, GarbageCollectionStartTime(0.0)
+	, StartActorCount(0)
+	, StartObjectCount(0)
+	, PeakActorCount(0)
+	, PeakObjectCount(0)
+	, MonsterKills(0)
+{
+}
+
+FMazeLevelRecorder::~FMazeLevelRecorder()
+{
+	Stop();
+}
+
+void FMazeLevelRecorder::Start(AMaze* InMaze, float InHitchThresholdMs)
+{
+	Stop();
+	if (InMaze == nullptr)
+	{
+		return;
+	}
+
+	Maze = InMaze;
+	HitchThresholdMs = InHitchThresholdMs;
+
+	// Level lifecycle
+	TransitionFinishedHandle = InMaze->OnTransitionFinished().AddRaw(this, &FMazeLevelRecorder::OnTransitionFinished);
+	MonsterKillHandle = InMaze->OnMonsterKill().AddRaw(this, &FMazeLevelRecorder::OnMonsterKill);
+	if (InMaze->EndTriggerVolume)
+	{
+		FadeOutHandle = InMaze->EndTriggerVolume->OnFadeOutLaunched().AddRaw(this, &FMazeLevelRecorder::OnFadeOutLaunched);
+	}
+
+	// Frames and garbage collections
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FMazeLevelRecorder::OnEndFrame);
+	PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FMazeLevelRecorder::OnPreGarbageCollect);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FMazeLevelRecorder::OnPostGarbageCollect);
+
+	ResetLevel();
+}
+
+void FMazeLevelRecorder::Stop()
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	// The level has not been finished, but what has been played is still worth knowing
+	if (PlayFrameTimes.Count > 0)
+	{
+		WriteLevel(TEXT("Aborted"), false);
+	}
+
+	// The maze may already be destroyed when the world is torn down
+	if (AMaze* RecordedMaze = Maze.Get())
+	{
+		RecordedMaze->OnTransitionFinished().Remove(TransitionFinishedHandle);
+		RecordedMaze->OnMonsterKill().Remove(MonsterKillHandle);
+		if (RecordedMaze->EndTriggerVolume)
+		{
+			RecordedMaze->EndTriggerVolume->OnFadeOutLaunched().Remove(FadeOutHandle);
+		}
+	}
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	EndFrameHandle.Reset();
+	Maze.Reset();
+}
+
+void FMazeLevelRecorder::SetLevel(int32 StateIndex, bool InIsLastLevel, bool InIsRetry, const FMazeLayout& Layout)
+{
+	LevelIndex = StateIndex;
+	IsLastLevel = InIsLastLevel;
+	IsRetry = InIsRetry;
+	LevelLayout = InIsLastLevel ? FMazeLayout() : Layout;
+}
+
+void FMazeLevelRecorder::AddScopeCycles(const TCHAR* Name, uint64 Cycles)
+{
+	FrameScopeCycles.FindOrAdd(Name) += Cycles;
+}
+
+void FMazeLevelRecorder::ResetLevel()
+{
+	IsPlaying = false;
+	LevelStartTime = FPlatformTime::Seconds();
+	PlayStartTime = LevelStartTime;
+	LastFrameTime = LevelStartTime;
+	PlayFrameTimes.Reset();
+	TransitionFrameTimes.Reset();
+	Hitches.Reset();
+	HitchCount = 0;
+	GarbageCollectionCount = 0;
+	GarbageCollectionTotalMs = 0.0f;
+	GarbageCollectionMaxMs = 0.0f;
+	MonsterKills = 0;
+
+	StartActorCount = GetActorCount();
+	StartObjectCount = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	PeakActorCount = StartActorCount;
+	PeakObjectCount = StartObjectCount;
+}
+
+void FMazeLevelRecorder::OnTransitionFinished()
+{
+	IsPlaying = true;
+	PlayStartTime = FPlatformTime::Seconds();
+}
+
+void FMazeLevelRecorder::OnFadeOutLaunched(bool IsDeathKill)
+{
+	WriteLevel(IsDeathKill ? TEXT("DeathKill") : TEXT("Completed"), true);
+
+	// The frames from now on belong to the transition of the next level
+	ResetLevel();
+}
+
+void FMazeLevelRecorder::OnMonsterKill()
+{
+	MonsterKills += 1;
+}
+
+void FMazeLevelRecorder::OnEndFrame()
+{
+	double Now = FPlatformTime::Seconds();
+	float FrameMs = (float)((Now - LastFrameTime) * 1000.0);
+	LastFrameTime = Now;
+
+	(IsPlaying ? PlayFrameTimes : TransitionFrameTimes).Add(FrameMs);
+
+	// Only the worst hitches are kept, slowest first
+	if (FrameMs >= HitchThresholdMs)
+	{
+		HitchCount += 1;
+	}
+	if (FrameMs >= HitchThresholdMs && (Hitches.Num() < MaxHitches || FrameMs > Hitches.Last().FrameMs))
+	{
+		// The hitch is attributed to the scope which took the most time during the frame
+		FMazeHitch Hitch;
+		Hitch.FrameMs = FrameMs;
+		Hitch.LevelTime = (float)(Now - LevelStartTime);
+		Hitch.IsInTransition = !IsPlaying;
+		Hitch.Scope = TEXT("Untracked");
+		Hitch.ScopeMs = 0.0f;
+		for (const TPair<const TCHAR*, uint64>& Scope : FrameScopeCycles)
+		{
+			float ScopeMs = (float)(FPlatformTime::ToMilliseconds64(Scope.Value));
+			if (ScopeMs > Hitch.ScopeMs)
+			{
+				Hitch.Scope = Scope.Key;
+				Hitch.ScopeMs = ScopeMs;
+			}
+		}
+		if (Hitches.Num() == MaxHitches)
+		{
+			Hitches.Pop(false);
+		}
+		int32 Index = 0;
+		while (Index < Hitches.Num() && Hitches[Index].FrameMs >= FrameMs)
+		{
+			Index++;
+		}
+		Hitches.Insert(Hitch, Index);
+	}
+	FrameScopeCycles.Reset();
+
+	// The counts are cheap, but only needed now and then
+	if ((PlayFrameTimes.Count + TransitionFrameTimes.Count) % 60 == 0)
+	{
+		PeakActorCount = FMath::Max(PeakActorCount, GetActorCount());
+		PeakObjectCount = FMath::Max(PeakObjectCount, GUObjectArray.GetObjectArrayNumMinusAvailable());
+	}
+}
+
+void FMazeLevelRecorder::OnPreGarbageCollect()
+{
+	GarbageCollectionStartTime = FPlatformTime::Seconds();
+}
+
+void FMazeLevelRecorder::OnPostGarbageCollect()
+{
+	double GarbageCollectionSeconds = FPlatformTime::Seconds() - GarbageCollectionStartTime;
+	GarbageCollectionCount += 1;
+	GarbageCollectionTotalMs += (float)(GarbageCollectionSeconds * 1000.0);
+	GarbageCollectionMaxMs = FMath::Max(GarbageCollectionMaxMs, (float)(GarbageCollectionSeconds * 1000.0));
+
+	// The collection happens outside of any telemetry scope, it is attributed to itself
+	AddScopeCycles(TEXT("GarbageCollection"), (uint64)(GarbageCollectionSeconds / FPlatformTime::GetSecondsPerCycle64()));
+}
+
+int32 FMazeLevelRecorder::GetActorCount() const
+{
+	UWorld* World = Maze.IsValid() ? Maze->GetWorld() : nullptr;
+	return World ? World->GetActorCount() : 0;
+}
+
+void FMazeFrameTimes::Reset()
+{
+	FMemory::Memzero(Buckets, sizeof(Buckets));
+	Count = 0;
+	TotalMs = 0.0;
+	MaxMs = 0.0f;
+}
+
+void FMazeFrameTimes::Add(float FrameMs)
+{
+	Buckets[FMath::Clamp(FMath::FloorToInt(FrameMs * BucketsPerMs), 0, BucketCount - 1)] += 1;
+	Count += 1;
+	TotalMs += FrameMs;
+	MaxMs = FMath::Max(MaxMs, FrameMs);
+}
+
+float FMazeFrameTimes::GetPercentileMs(int32 Percentile) const
+{
+	// Same rank as in the sorted frames: the bucket holding it
+	const uint32 Rank = (uint32)((Count - 1) * (int64)Percentile / 100);
+	uint32 Below = 0;
+	for (int32 Bucket = 0; Bucket < BucketCount - 1; Bucket++)
+	{
+		Below += Buckets[Bucket];
+		if (Below > Rank)
+		{
+			return FMath::Min((float)(Bucket + 1) / BucketsPerMs, MaxMs);
+		}
+	}
+	return MaxMs;
+}
+
+// Writes the percentiles of the frame times as an object of the JSON file
+static void WriteFrameTimes(TSharedRef<TJsonWriter<>>& Writer, const TCHAR* Identifier, const FMazeFrameTimes& FrameTimes)
+{
+	Writer->WriteObjectStart(Identifier);
+	Writer->WriteValue(TEXT("Frames"), FrameTimes.Count);
+	if (FrameTimes.Count > 0)
+	{
+		Writer->WriteValue(TEXT("AverageMs"), (float)(FrameTimes.TotalMs / FrameTimes.Count));
+		Writer->WriteValue(TEXT("P50Ms"), FrameTimes.GetPercentileMs(50));
+		Writer->WriteValue(TEXT("P90Ms"), FrameTimes.GetPercentileMs(90));
+		Writer->WriteValue(TEXT("P95Ms"), FrameTimes.GetPercentileMs(95));
+		Writer->WriteValue(TEXT("P99Ms"), FrameTimes.GetPercentileMs(99));
+		Writer->WriteValue(TEXT("MaxMs"), FrameTimes.MaxMs);
+	}
+	Writer->WriteObjectEnd();
+}
+
+void FMazeLevelRecorder::WriteLevel(const TCHAR* Outcome, bool IsDeferred)
+{
+	double Now = FPlatformTime::Seconds();
+	int32 EndActorCount = GetActorCount();
+	int32 EndObjectCount = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	Writer->WriteObjectStart();
+
+	// Level parameters
+	Writer->WriteValue(TEXT("LevelIndex"), LevelIndex);
+	Writer->WriteValue(TEXT("IsLastLevel"), IsLastLevel);
+	Writer->WriteValue(TEXT("IsRetry"), IsRetry);
+	Writer->WriteValue(TEXT("Outcome"), FString(Outcome));
+	Writer->WriteValue(TEXT("SizeX"), LevelLayout.Size.X);
+	Writer->WriteValue(TEXT("SizeY"), LevelLayout.Size.Y);
+	Writer->WriteValue(TEXT("Monsters"), LevelLayout.MonsterNumber);
+	Writer->WriteValue(TEXT("MonsterPathLength"), LevelLayout.AIPathLength);
+	Writer->WriteValue(TEXT("DeathTimer"), LevelLayout.DeathTimer);
+	Writer->WriteValue(TEXT("Seed"), LevelLayout.Seed);
+	Writer->WriteValue(TEXT("MonsterKills"), MonsterKills);
+	Writer->WriteValue(TEXT("TransitionSeconds"), (float)(PlayStartTime - LevelStartTime));
+	Writer->WriteValue(TEXT("PlaySeconds"), (float)(IsPlaying ? Now - PlayStartTime : 0.0));
+
+	// Frame times
+	WriteFrameTimes(Writer, TEXT("PlayFrameTimes"), PlayFrameTimes);
+	WriteFrameTimes(Writer, TEXT("TransitionFrameTimes"), TransitionFrameTimes);
+
+	// Hitches
+	Writer->WriteValue(TEXT("HitchThresholdMs"), HitchThresholdMs);
+	Writer->WriteValue(TEXT("HitchCount"), HitchCount);
+	Writer->WriteArrayStart(TEXT("WorstHitches"));
+	for (const FMazeHitch& Hitch : Hitches)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("FrameMs"), Hitch.FrameMs);
+		Writer->WriteValue(TEXT("LevelTime"), Hitch.LevelTime);
+		Writer->WriteValue(TEXT("IsInTransition"), Hitch.IsInTransition);
+		Writer->WriteValue(TEXT("Scope"), FString(Hitch.Scope));
+		Writer->WriteValue(TEXT("ScopeMs"), Hitch.ScopeMs);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	// Garbage collections
+	Writer->WriteValue(TEXT("GarbageCollections"), GarbageCollectionCount);
+	Writer->WriteValue(TEXT("GarbageCollectionTotalMs"), GarbageCollectionTotalMs);
+	Writer->WriteValue(TEXT("GarbageCollectionMaxMs"), GarbageCollectionMaxMs);
+
+	// Actor and object counts
+	Writer->WriteValue(TEXT("StartActors"), StartActorCount);
+	Writer->WriteValue(TEXT("PeakActors"), FMath::Max(PeakActorCount, EndActorCount));
+	Writer->WriteValue(TEXT("EndActors"), EndActorCount);
+	Writer->WriteValue(TEXT("StartObjects"), StartObjectCount);
+	Writer->WriteValue(TEXT("PeakObjects"), FMath::Max(PeakObjectCount, EndObjectCount));
+	Writer->WriteValue(TEXT("EndObjects"), EndObjectCount);
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	// One file per level, named so that they sort by time
+	FString Filename = FPaths::ProfilingDir() / TEXT("MazeLevels") / FString::Printf(TEXT("%s_Level%02d.json"), *FDateTime::Now().ToString(), LevelIndex);
+	auto SaveLevel = [Json, Filename]()
+	{
+		if (!FFileHelper::SaveStringToFile(Json, *Filename))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Error: cannot write the level telemetry %s"), *Filename);
+		}
+	};
+
+	// The file is written while the transition hides the hitch, unless the game is being torn down
+	AMaze* RecordedMaze = Maze.Get();
+	if (IsDeferred && RecordedMaze)
+	{
+		RecordedMaze->GetIdleScheduler().Submit(TEXT("Level telemetry"), EMazeIdlePriority::Low, 2.0f, SaveLevel);
+	}
+	else
+	{
+		SaveLevel();
+	}
+}
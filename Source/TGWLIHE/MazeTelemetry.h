@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MazeLayout.h"
+class AMaze;
+class UWorld;
+
+/**
+* Times a scope of the game thread for the level telemetry, so that a hitch can be attributed to what was running
+* Unlike the cycle stats, it is also compiled in the builds without stats, as the ones of the kiosk installs
+*/
+class TGWLIHE_API FMazeTelemetryScope
+{
+public:
+	FMazeTelemetryScope(const TCHAR* InName);
+	~FMazeTelemetryScope();
+
+private:
+	// Name of the scope, nullptr if not on the game thread
+	const TCHAR* Name;
+
+	// When the scope was entered
+	uint64 StartCycles;
+};
+
+#define MAZE_TELEMETRY_SCOPE(Name) FMazeTelemetryScope PREPROCESSOR_JOIN(MazeTelemetryScope, __LINE__)(TEXT(Name))
+
+/**
+* A frame slower than the hitch threshold, with the scope that took most of it
+*/
+struct FMazeHitch
+{
+	// Duration of the frame, in ms
+	float FrameMs;
+
+	// Time since the level was generated, in s
+	float LevelTime;
+
+	// Whether or not it happened during the transition, before the player could move
+	bool IsInTransition;
+
+	// Telemetry scope which took the most time in this frame, "Untracked" if none
+	const TCHAR* Scope;
+
+	// Time taken by this scope in this frame, in ms
+	float ScopeMs;
+};
+
+/**
+* Frame times of a level, counted in fixed buckets: a level left running for days takes no more memory than a short one
+*/
+struct FMazeFrameTimes
+{
+	FMazeFrameTimes() { Reset(); }
+
+	// Forgets every frame
+	void Reset();
+
+	// Counts a frame
+	void Add(float FrameMs);
+
+	// Upper bound of the bucket holding the given percentile of the frames, in ms, at most the slowest frame
+	float GetPercentileMs(int32 Percentile) const;
+
+	// Buckets of half a ms, the last one holding every frame slower than the others
+	static const int32 BucketsPerMs = 2;
+	static const int32 BucketCount = 200;
+
+	// Number of frames counted in each bucket
+	uint32 Buckets[BucketCount];
+
+	// Number of frames, their total and the slowest one, in ms
+	int32 Count;
+	double TotalMs;
+	float MaxMs;
+};
+
+/**
+* Records the frame times, hitches, actor and object counts and garbage collections of every level, and writes them to Saved/Profiling/MazeLevels
+* A level goes from its generation to the end trigger fade out: its transition ends with the maze transition finished event
+*/
+class TGWLIHE_API FMazeLevelRecorder
+{
+public:
+	FMazeLevelRecorder();
+	~FMazeLevelRecorder();
+
+	// Starts recording the levels of the maze
+	void Start(AMaze* InMaze, float InHitchThresholdMs);
+
+	// Writes the level being played, if any, then stops recording
+	void Stop();
+
+	// Whether or not the levels are recorded
+	bool IsRecording() const { return EndFrameHandle.IsValid(); }
+
+	// Sets the level generated for the record being taken
+	void SetLevel(int32 StateIndex, bool IsLastLevel, bool IsRetry, const FMazeLayout& Layout);
+
+	// Adds the time spent in a scope during the current frame, called by FMazeTelemetryScope
+	static void AddScopeCycles(const TCHAR* Name, uint64 Cycles);
+
+private:
+	// The transition is over, the player plays the level
+	void OnTransitionFinished();
+
+	// The player touched the end trigger, or was killed by Death: the level is over
+	void OnFadeOutLaunched(bool IsDeathKill);
+
+	// The player has been touched by a Monster
+	void OnMonsterKill();
+
+	// Samples the frame time, keeps it as a hitch if above the threshold
+	void OnEndFrame();
+
+	// Garbage collection pauses
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	// Starts the record of the next level
+	void ResetLevel();
+
+	// Writes the record of the current level to a JSON file, right away or during the next idle window of the maze
+	void WriteLevel(const TCHAR* Outcome, bool IsDeferred);
+
+	// Number of actors in the world of the maze
+	int32 GetActorCount() const;
+
+private:
+	// Maximum number of hitches written per level, the worst ones
+	static const int32 MaxHitches = 10;
+
+	// Time spent in each telemetry scope during the current frame, exclusive of the nested scopes
+	static TMap<const TCHAR*, uint64> FrameScopeCycles;
+
+	// Maze whose levels are recorded
+	TWeakObjectPtr<AMaze> Maze;
+
+	// Frames slower than that are hitches
+	float HitchThresholdMs;
+
+	// Level being recorded
+	int32 LevelIndex;
+	bool IsLastLevel;
+	bool IsRetry;
+	FMazeLayout LevelLayout;
+
+	// Whether or not the transition of the level is over
+	bool IsPlaying;
+
+	// When the level was generated, and when its transition finished
+	double LevelStartTime;
+	double PlayStartTime;
+
+	// End of the previous frame
+	double LastFrameTime;
+
+	// Duration of the frames of the level, played or in transition
+	FMazeFrameTimes PlayFrameTimes;
+	FMazeFrameTimes TransitionFrameTimes;
+
+	// Worst frames above the hitch threshold, the slowest first, and the number of them
+	TArray<FMazeHitch> Hitches;
+	int32 HitchCount;
+
+	// Garbage collection pauses during the level: their number, their total and the longest one, in ms
+	int32 GarbageCollectionCount;
+	float GarbageCollectionTotalMs;
+	float GarbageCollectionMaxMs;
+	double GarbageCollectionStartTime;
+
+	// Actor and object counts when the level started, and the highest ones seen
+	int32 StartActorCount;
+	int32 StartObjectCount;
+	int32 PeakActorCount;
+	int32 PeakObjectCount;
+
+	// Number of times the player was touched by a Monster
+	int32 MonsterKills;
+
+	// Subscriptions to remove when the recording stops
+	FDelegateHandle TransitionFinishedHandle;
+	FDelegateHandle FadeOutHandle;
+	FDelegateHandle MonsterKillHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PreGarbageCollectHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+};
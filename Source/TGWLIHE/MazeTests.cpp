@@ -0,0 +1,791 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Automation tests of the maze generation, runnable headless, for instance on Linux:
+// UE4Editor TGWLIHE.uproject -game -nullrhi -nosound -unattended -ExecCmds="Automation RunTests TGWLIHE; Quit"
+
+#include "Misc/AutomationTest.h"
+#include "MazeLayout.h"
+#include "MazeFloors.h"
+#include "MazeDirections.h"
+#include "AmazeingGameMode.h"
+#include "Maze.h"
+#include "MazeActorRegistry.h"
+#include "MazeIdleScheduler.h"
+#include "MazeAnalytics.h"
+#include "MazeBitboard.h"
+#include "AIMonsterController.h"
+#include "MazeInputReplay.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace MazeTests
+{
+	// Sizes of the scripted levels, plus the extreme ones
+	static const FIntPoint Sizes[] = { FIntPoint(1, 1), FIntPoint(4, 4), FIntPoint(7, 7), FIntPoint(20, 1), FIntPoint(1, 20), FIntPoint(8, 8), FIntPoint(10, 10), FIntPoint(15, 15), FIntPoint(30, 30) };
+
+	// Number of random seeds tried for each size
+	static const int32 SeedCount = 32;
+
+	// Cells of the patrol, from its home to its target, following the passages. Empty if the target cannot be reached
+	static TArray<FIntVector> GetPatrolCells(const FMazeLayout& Layout, const FMazePatrol& Patrol)
+	{
+		TArray<FIntVector> PatrolCells;
+		TArray<int32> Distances;
+		Layout.ComputeDistances(Patrol.Home, Distances);
+		if (!Layout.ContainsCoordinates(Patrol.Target) || Distances[Layout.ToIndex(Patrol.Target)] < 0)
+		{
+			return PatrolCells;
+		}
+
+		// We walk back from the target, always to the neighbor closer to the home
+		FIntVector Current = Patrol.Target;
+		PatrolCells.Add(Current);
+		while (Distances[Layout.ToIndex(Current)] > 0)
+		{
+			for (uint8 i = 0; i < UMazeDirections::Count; i++)
+			{
+				FIntVector Neighbor = Current + UMazeDirections::ToIntVector((EMazeDirection)i);
+				if (Layout.HasPassage(Current, (EMazeDirection)i) && Distances[Layout.ToIndex(Neighbor)] == Distances[Layout.ToIndex(Current)] - 1)
+				{
+					Current = Neighbor;
+					break;
+				}
+			}
+			PatrolCells.Add(Current);
+		}
+		return PatrolCells;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutValidityTest, "TGWLIHE.Maze.Layout.Validity", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutValidityTest::RunTest(const FString& Parameters)
+{
+	for (const FIntPoint& Size : MazeTests::Sizes)
+	{
+		for (int32 Seed = 0; Seed < MazeTests::SeedCount; Seed++)
+		{
+			FMazeLayout Layout;
+			Layout.Plan(Size.X, Size.Y, 0, 0, 0, Seed);
+			const FString Context = FString::Printf(TEXT("%dx%d seed %d"), Size.X, Size.Y, Seed);
+
+			// Validate checks the spanning tree: every cell reachable, Num() - 1 passages seen from both sides
+			TestTrue(FString::Printf(TEXT("Perfect maze (%s)"), *Context), Layout.Validate());
+
+			// The start is on the first column and the end on the last one, so the solution crosses every column
+			TestTrue(FString::Printf(TEXT("Start inside the first column (%s)"), *Context), Layout.ContainsCoordinates(FIntVector(0, Layout.StartY, 0)));
+			TestTrue(FString::Printf(TEXT("End inside the last column (%s)"), *Context), Layout.ContainsCoordinates(FIntVector(Size.X - 1, Layout.EndY, 0)));
+			TestTrue(FString::Printf(TEXT("Solution crosses every column (%s)"), *Context), Layout.GetSolutionLength() >= Size.X);
+
+			// The same seed always gives the same maze
+			FMazeLayout SameLayout;
+			SameLayout.Plan(Size.X, Size.Y, 0, 0, 0, Seed);
+			TestTrue(FString::Printf(TEXT("Deterministic (%s)"), *Context), SameLayout.PassageMasks == Layout.PassageMasks && SameLayout.StartY == Layout.StartY && SameLayout.EndY == Layout.EndY);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutTilesTest, "TGWLIHE.Maze.Layout.Tiles", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutTilesTest::RunTest(const FString& Parameters)
+{
+	// Larger than a tile along one axis or both, with partial tiles on the last row and column
+	const int32 TileSize = FMazeLayout::TileSize;
+	const FIntPoint Sizes[] = { FIntPoint(TileSize + 1, 3), FIntPoint(2, TileSize * 2), FIntPoint(TileSize * 3 + 5, TileSize * 2 + 1) };
+
+	for (const FIntPoint& Size : Sizes)
+	{
+		for (int32 Seed = 0; Seed < 4; Seed++)
+		{
+			FMazeLayout Layout;
+			Layout.Plan(Size.X, Size.Y, 5, 15, 0, Seed);
+			const FString Context = FString::Printf(TEXT("%dx%d seed %d"), Size.X, Size.Y, Seed);
+
+			// The tiles and the passages between them form a single spanning tree
+			TestTrue(FString::Printf(TEXT("Perfect maze (%s)"), *Context), Layout.Validate());
+
+			// The seed of every tile is drawn before the workers start: the same maze whatever the number of threads
+			FMazeLayout SingleThreaded;
+			SingleThreaded.Size = Layout.Size;
+			FRandomStream Stream(Seed);
+			SingleThreaded.CarveTiles(Stream, true);
+			TestTrue(FString::Printf(TEXT("Same maze on a single thread (%s)"), *Context), SingleThreaded.PassageMasks == Layout.PassageMasks);
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutAIPathTest, "TGWLIHE.Maze.Layout.AIPath", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutAIPathTest::RunTest(const FString& Parameters)
+{
+	// Monster count and path length of the scripted levels, then of the endless ones at their largest
+	static const FIntPoint MonsterSettings[] = { FIntPoint(1, 10), FIntPoint(2, 15), FIntPoint(5, 15), FIntPoint(8, 20), FIntPoint(30, 30) };
+
+	for (const FIntPoint& Size : MazeTests::Sizes)
+	{
+		for (const FIntPoint& Settings : MonsterSettings)
+		{
+			for (int32 Seed = 0; Seed < MazeTests::SeedCount; Seed++)
+			{
+				FMazeLayout Layout;
+				Layout.Plan(Size.X, Size.Y, Settings.X, Settings.Y, 0, Seed);
+				const FString Context = FString::Printf(TEXT("%dx%d, %d monsters, path %d, seed %d"), Size.X, Size.Y, Settings.X, Settings.Y, Seed);
+
+				if (!TestEqual(FString::Printf(TEXT("One patrol per monster (%s)"), *Context), Layout.Patrols.Num(), Settings.X))
+				{
+					continue;
+				}
+
+				// The patrols only share cells, or the start and end cells, when the maze is too small for all of them
+				const bool IsLargeEnough = Layout.Num() >= 2 + Settings.X * Settings.Y;
+				TSet<FIntVector> UsedCells;
+				UsedCells.Add(FIntVector(0, Layout.StartY, 0));
+				UsedCells.Add(FIntVector(Size.X - 1, Layout.EndY, 0));
+
+				for (const FMazePatrol& Patrol : Layout.Patrols)
+				{
+					TestTrue(FString::Printf(TEXT("Patrol length within the path length (%s)"), *Context), Patrol.Length >= 1 && Patrol.Length <= FMath::Max(Settings.Y, 1));
+
+					// The patrol follows the passages, without going through a cell twice
+					TArray<FIntVector> PatrolCells = MazeTests::GetPatrolCells(Layout, Patrol);
+					if (!TestEqual(FString::Printf(TEXT("Target reached from home along the passages in Length cells (%s)"), *Context), PatrolCells.Num(), Patrol.Length))
+					{
+						continue;
+					}
+
+					if (IsLargeEnough)
+					{
+						for (const FIntVector& Cell : PatrolCells)
+						{
+							TestFalse(FString::Printf(TEXT("Patrol cell (%d, %d) not used by the start, the end or another patrol (%s)"), Cell.X, Cell.Y, *Context), UsedCells.Contains(Cell));
+							UsedCells.Add(Cell);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutSightTest, "TGWLIHE.Maze.Layout.Sight", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutSightTest::RunTest(const FString& Parameters)
+{
+	for (int32 Seed = 0; Seed < MazeTests::SeedCount; Seed++)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(8, 8, 0, 0, 0, Seed);
+		const FString Context = FString::Printf(TEXT("seed %d"), Seed);
+
+		for (int32 X = 0; X < Layout.Size.X; X++)
+		{
+			for (int32 Y = 0; Y < Layout.Size.Y; Y++)
+			{
+				FIntVector Cell(X, Y, 0);
+				TestTrue(FString::Printf(TEXT("(%d, %d) sees itself (%s)"), X, Y, *Context), Layout.IsInSight(Cell, Cell));
+				TestFalse(FString::Printf(TEXT("(%d, %d) does not see diagonally (%s)"), X, Y, *Context), Layout.IsInSight(Cell, Cell + FIntVector(1, 1, 0)));
+
+				// Along a row or a column, a cell is seen as far as the passages go, and from both ends
+				for (int32 OtherX = 0; OtherX < Layout.Size.X; OtherX++)
+				{
+					FIntVector Other(OtherX, Y, 0);
+					bool IsOpen = true;
+					for (int32 i = FMath::Min(X, OtherX); i < FMath::Max(X, OtherX); i++)
+					{
+						IsOpen &= Layout.HasPassage(FIntVector(i, Y, 0), EMazeDirection::West);
+					}
+					TestEqual(FString::Printf(TEXT("(%d, %d) sees (%d, %d) (%s)"), X, Y, OtherX, Y, *Context), Layout.IsInSight(Cell, Other), IsOpen);
+					TestEqual(FString::Printf(TEXT("(%d, %d) seen from (%d, %d) (%s)"), X, Y, OtherX, Y, *Context), Layout.IsInSight(Other, Cell), IsOpen);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutNoiseTest, "TGWLIHE.Maze.Layout.Noise", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutNoiseTest::RunTest(const FString& Parameters)
+{
+	// The cells a noise reaches are exactly the ones within its radius along the passages, each one once
+	for (int32 Seed = 0; Seed < MazeTests::SeedCount; Seed++)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(15, 15, 0, 0, 0, Seed);
+		FIntVector From(Seed % 15, (Seed * 7) % 15, 0);
+		TArray<int32> Distances;
+		Layout.ComputeDistances(From, Distances);
+
+		for (int32 Radius = 0; Radius <= 6; Radius++)
+		{
+			const FString Context = FString::Printf(TEXT("seed %d, radius %d"), Seed, Radius);
+			TArray<TPair<FIntVector, int32>> Cells;
+			Layout.GetCellsWithin(From, Radius, Cells);
+
+			int32 ExpectedCount = 0;
+			for (int32 Distance : Distances)
+			{
+				ExpectedCount += Distance >= 0 && Distance <= Radius ? 1 : 0;
+			}
+			TestEqual(FString::Printf(TEXT("Cells within reach (%s)"), *Context), Cells.Num(), ExpectedCount);
+
+			TSet<FIntVector> Reached;
+			for (const TPair<FIntVector, int32>& Cell : Cells)
+			{
+				TestEqual(FString::Printf(TEXT("Distance of (%d, %d) (%s)"), Cell.Key.X, Cell.Key.Y, *Context), Cell.Value, Distances[Layout.ToIndex(Cell.Key)]);
+				TestFalse(FString::Printf(TEXT("(%d, %d) reached once (%s)"), Cell.Key.X, Cell.Key.Y, *Context), Reached.Contains(Cell.Key));
+				Reached.Add(Cell.Key);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutSnapshotTest, "TGWLIHE.Maze.Layout.Snapshot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutSnapshotTest::RunTest(const FString& Parameters)
+{
+	for (const FIntPoint& Size : MazeTests::Sizes)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(Size.X, Size.Y, 5, 15, 100, Size.X * 31 + Size.Y);
+
+		TArray<uint8> Snapshot;
+		Layout.SaveSnapshot(Snapshot);
+
+		// A retried level has to be exactly the same as the original one
+		FMazeLayout Restored;
+		const FString Context = FString::Printf(TEXT("%dx%d"), Size.X, Size.Y);
+		if (!TestTrue(FString::Printf(TEXT("Snapshot loaded (%s)"), *Context), Restored.LoadSnapshot(Snapshot)))
+		{
+			continue;
+		}
+		TestTrue(FString::Printf(TEXT("Same size (%s)"), *Context), Restored.Size == Layout.Size);
+		TestEqual(FString::Printf(TEXT("Same start (%s)"), *Context), Restored.StartY, Layout.StartY);
+		TestEqual(FString::Printf(TEXT("Same end (%s)"), *Context), Restored.EndY, Layout.EndY);
+		TestEqual(FString::Printf(TEXT("Same Death timer (%s)"), *Context), Restored.DeathTimer, Layout.DeathTimer);
+		TestTrue(FString::Printf(TEXT("Same passages (%s)"), *Context), Restored.PassageMasks == Layout.PassageMasks);
+		TestEqual(FString::Printf(TEXT("Same patrol count (%s)"), *Context), Restored.Patrols.Num(), Layout.Patrols.Num());
+		for (int32 i = 0; i < FMath::Min(Restored.Patrols.Num(), Layout.Patrols.Num()); i++)
+		{
+			TestTrue(FString::Printf(TEXT("Same patrol %d (%s)"), i, *Context), Restored.Patrols[i].Home == Layout.Patrols[i].Home && Restored.Patrols[i].Target == Layout.Patrols[i].Target && Restored.Patrols[i].Length == Layout.Patrols[i].Length);
+		}
+
+		// A truncated snapshot is refused
+		Snapshot.SetNum(Snapshot.Num() / 2);
+		TestFalse(FString::Printf(TEXT("Truncated snapshot refused (%s)"), *Context), Restored.LoadSnapshot(Snapshot));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeLayoutRegionTest, "TGWLIHE.Maze.Layout.Regions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeLayoutRegionTest::RunTest(const FString& Parameters)
+{
+	const int32 RegionSize = 8;
+	const int32 BorderOpenings = 2;
+
+	for (int32 WorldSeed = 0; WorldSeed < MazeTests::SeedCount; WorldSeed++)
+	{
+		for (int32 X = -2; X <= 2; X++)
+		{
+			for (int32 Y = -2; Y <= 2; Y++)
+			{
+				FIntVector Region(X, Y, 0);
+				const FString Context = FString::Printf(TEXT("region (%d, %d) seed %d"), X, Y, WorldSeed);
+
+				FMazeLayout Layout;
+				Layout.PlanRegion(RegionSize, Region, WorldSeed, BorderOpenings);
+
+				// A region is generated again identical when the player comes back
+				FMazeLayout SameLayout;
+				SameLayout.PlanRegion(RegionSize, Region, WorldSeed, BorderOpenings);
+				TestTrue(FString::Printf(TEXT("Deterministic (%s)"), *Context), SameLayout.PassageMasks == Layout.PassageMasks && SameLayout.BorderMasks == Layout.BorderMasks);
+
+				// The openings of the border lead out of the region, they are not passages of its layout
+				TestTrue(FString::Printf(TEXT("Valid (%s)"), *Context), Layout.Validate());
+
+				// Every cell of the region can be reached from any other one
+				TArray<int32> Distances;
+				Layout.ComputeDistances(FIntVector(0, 0, 0), Distances);
+				TestFalse(FString::Printf(TEXT("Connected (%s)"), *Context), Distances.Contains(-1));
+
+				// The borders toward +X and +Y are opened, at the same places, from both sides
+				FMazeLayout WestLayout;
+				WestLayout.PlanRegion(RegionSize, Region + FIntVector(1, 0, 0), WorldSeed, BorderOpenings);
+				FMazeLayout NorthLayout;
+				NorthLayout.PlanRegion(RegionSize, Region + FIntVector(0, 1, 0), WorldSeed, BorderOpenings);
+
+				int32 WestOpenings = 0;
+				int32 NorthOpenings = 0;
+				for (int32 i = 0; i < RegionSize; i++)
+				{
+					bool IsWestOpen = Layout.HasBorderOpening(FIntVector(RegionSize - 1, i, 0), EMazeDirection::West);
+					TestEqual(FString::Printf(TEXT("West border stitched at %d (%s)"), i, *Context), IsWestOpen, WestLayout.HasBorderOpening(FIntVector(0, i, 0), EMazeDirection::East));
+					WestOpenings += IsWestOpen ? 1 : 0;
+
+					bool IsNorthOpen = Layout.HasBorderOpening(FIntVector(i, RegionSize - 1, 0), EMazeDirection::North);
+					TestEqual(FString::Printf(TEXT("North border stitched at %d (%s)"), i, *Context), IsNorthOpen, NorthLayout.HasBorderOpening(FIntVector(i, 0, 0), EMazeDirection::South));
+					NorthOpenings += IsNorthOpen ? 1 : 0;
+				}
+				TestTrue(FString::Printf(TEXT("West border opened (%s)"), *Context), WestOpenings > 0);
+				TestTrue(FString::Printf(TEXT("North border opened (%s)"), *Context), NorthOpenings > 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeFloorPlanTest, "TGWLIHE.Maze.Layout.Floors", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeFloorPlanTest::RunTest(const FString& Parameters)
+{
+	const int32 FloorCount = 4;
+	for (int32 Seed = 0; Seed < 20; Seed++)
+	{
+		FString Context = FString::Printf(TEXT("seed %d"), Seed);
+		FMazeFloorPlan Plan;
+		Plan.Plan(6, 5, FloorCount, 2, 8, 0, Seed);
+		TestEqual(FString::Printf(TEXT("Floor count (%s)"), *Context), Plan.Num(), FloorCount);
+
+		// Every floor unpacks into a perfect maze
+		for (int32 Floor = 0; Floor < FloorCount; Floor++)
+		{
+			FMazeLayout Layout;
+			TestTrue(FString::Printf(TEXT("Floor %d unpacks (%s)"), Floor, *Context), Plan.UnpackFloor(Floor, Layout));
+			TestTrue(FString::Printf(TEXT("Floor %d is a perfect maze (%s)"), Floor, *Context), Layout.Validate());
+		}
+		FMazeLayout Missing;
+		TestFalse(FString::Printf(TEXT("No floor above the last one (%s)"), *Context), Plan.UnpackFloor(FloorCount, Missing));
+
+		// Every floor but the last one goes up, every floor but the first one goes down, and the stairs never land on the start or the end
+		for (int32 Floor = 0; Floor < FloorCount; Floor++)
+		{
+			TArray<TPair<FIntVector, int32>> Stairs;
+			Plan.GetStairs(Floor, Stairs);
+			int32 Up = 0;
+			int32 Down = 0;
+			for (const TPair<FIntVector, int32>& OneStairs : Stairs)
+			{
+				TestEqual(FString::Printf(TEXT("Stairs on floor %d (%s)"), Floor, *Context), OneStairs.Key.Z, Floor);
+				TestTrue(FString::Printf(TEXT("Stairs not on the start (%s)"), *Context), OneStairs.Key != FIntVector(0, Plan.StartY, 0));
+				TestTrue(FString::Printf(TEXT("Stairs not on the end (%s)"), *Context), OneStairs.Key != FIntVector(5, Plan.EndY, FloorCount - 1));
+				Up += OneStairs.Value == Floor + 1 ? 1 : 0;
+				Down += OneStairs.Value == Floor - 1 ? 1 : 0;
+			}
+			TestEqual(FString::Printf(TEXT("Stairs up from floor %d (%s)"), Floor, *Context), Up, Floor < FloorCount - 1 ? FMazeFloorPlan::StairsPerFloor : 0);
+			TestEqual(FString::Printf(TEXT("Stairs down from floor %d (%s)"), Floor, *Context), Down, Floor > 0 ? FMazeFloorPlan::StairsPerFloor : 0);
+		}
+	}
+
+	// On floors so small that the random draws keep failing, the stairs still link every floor, and every floor is reached from the first one
+	for (int32 Seed = 0; Seed < 20; Seed++)
+	{
+		FString Context = FString::Printf(TEXT("2x2, seed %d"), Seed);
+		FMazeFloorPlan Plan;
+		Plan.Plan(2, 2, FloorCount, 0, 0, 0, Seed);
+		TestEqual(FString::Printf(TEXT("Stairs count (%s)"), *Context), Plan.Stairs.Num(), (FloorCount - 1) * FMazeFloorPlan::StairsPerFloor);
+
+		TArray<bool> IsReached;
+		IsReached.Init(false, FloorCount);
+		IsReached[0] = true;
+		TArray<int32> Queue;
+		Queue.Add(0);
+		for (int32 i = 0; i < Queue.Num(); i++)
+		{
+			TArray<TPair<FIntVector, int32>> Stairs;
+			Plan.GetStairs(Queue[i], Stairs);
+			for (const TPair<FIntVector, int32>& OneStairs : Stairs)
+			{
+				if (!IsReached[OneStairs.Value])
+				{
+					IsReached[OneStairs.Value] = true;
+					Queue.Add(OneStairs.Value);
+				}
+			}
+		}
+		TestEqual(FString::Printf(TEXT("Every floor reached (%s)"), *Context), Queue.Num(), FloorCount);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAmazeingLevelTableTest, "TGWLIHE.GameMode.LevelTable", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FAmazeingLevelTableTest::RunTest(const FString& Parameters)
+{
+	// The class default object has no maze library open, so the endless levels are random
+	const AAmazeingGameMode* GameMode = GetDefault<AAmazeingGameMode>();
+	FRandomStream Stream(0);
+
+	// The scripted levels, in the order GenerateMaze plays them
+	const FMazeLevelParameters Expected[] =
+	{
+		FMazeLevelParameters(4, 4, 0, 0),
+		FMazeLevelParameters(7, 7, 0, 0),
+		FMazeLevelParameters(20, 1, 1, 10),
+		FMazeLevelParameters(8, 8, 2, 15),
+		FMazeLevelParameters(10, 10, 5, 15, 100),
+		FMazeLevelParameters(15, 15, 8, 20, 300)
+	};
+	TestEqual(TEXT("Scripted levels before the last one"), (int32)ARRAY_COUNT(Expected), AAmazeingGameMode::GetLastLevelIndex());
+
+	for (int32 Index = 0; Index < ARRAY_COUNT(Expected); Index++)
+	{
+		FMazeLevelParameters Parameters = GameMode->GetLevelParameters(Index, Stream);
+		TestEqual(FString::Printf(TEXT("Level %d SizeX"), Index), Parameters.SizeX, Expected[Index].SizeX);
+		TestEqual(FString::Printf(TEXT("Level %d SizeY"), Index), Parameters.SizeY, Expected[Index].SizeY);
+		TestEqual(FString::Printf(TEXT("Level %d monsters"), Index), Parameters.NumberOfMonsters, Expected[Index].NumberOfMonsters);
+		TestEqual(FString::Printf(TEXT("Level %d monster path length"), Index), Parameters.MonsterPathLength, Expected[Index].MonsterPathLength);
+		TestEqual(FString::Printf(TEXT("Level %d Death timer"), Index), Parameters.DeathTimer, Expected[Index].DeathTimer);
+		TestFalse(FString::Printf(TEXT("Level %d is not the last level"), Index), Parameters.IsLastLevel);
+	}
+
+	TestTrue(TEXT("Last level"), GameMode->GetLevelParameters(AAmazeingGameMode::GetLastLevelIndex(), Stream).IsLastLevel);
+
+	// Endless levels: random, but never larger than 30x30
+	for (int32 i = 0; i < 100; i++)
+	{
+		FMazeLevelParameters Parameters = GameMode->GetLevelParameters(AAmazeingGameMode::GetLastLevelIndex() + 1 + i, Stream);
+		TestFalse(TEXT("Endless level is not the last level"), Parameters.IsLastLevel);
+		TestTrue(TEXT("Endless level size within 10 to 30"), Parameters.SizeX >= 10 && Parameters.SizeX <= 30 && Parameters.SizeY >= 10 && Parameters.SizeY <= 30);
+		TestTrue(TEXT("Endless level monsters within 10 to 30"), Parameters.NumberOfMonsters >= 10 && Parameters.NumberOfMonsters <= 30);
+		TestTrue(TEXT("Endless level path length within 10 to 30"), Parameters.MonsterPathLength >= 10 && Parameters.MonsterPathLength <= 30);
+		TestTrue(TEXT("Endless level Death timer within 60 to 240"), Parameters.DeathTimer >= 60 && Parameters.DeathTimer <= 240);
+		TestEqual(TEXT("Endless level flat unless configured otherwise, so that it keeps Death"), Parameters.Floors, 1);
+	}
+
+	// The random levels only depend on the stream, so that a session can be replayed from its seed
+	FRandomStream Replayed(0);
+	FRandomStream Original(0);
+	for (int32 i = 0; i < 10; i++)
+	{
+		FMazeLevelParameters Played = GameMode->GetLevelParameters(AAmazeingGameMode::GetLastLevelIndex() + 1, Original);
+		FMazeLevelParameters Parameters = GameMode->GetLevelParameters(AAmazeingGameMode::GetLastLevelIndex() + 1, Replayed);
+		TestTrue(FString::Printf(TEXT("Endless level %d replayed"), i), Parameters.SizeX == Played.SizeX && Parameters.SizeY == Played.SizeY && Parameters.NumberOfMonsters == Played.NumberOfMonsters && Parameters.DeathTimer == Played.DeathTimer);
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeActorRegistryTest, "TGWLIHE.Maze.ActorRegistry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeActorRegistryTest::RunTest(const FString& Parameters)
+{
+	// A world of its own, which does not begin play: the actors are registered here instead
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MazeRegistryTestWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	TestNull(TEXT("No maze in an empty world"), FMazeActorRegistry::Get<AMaze>(World));
+
+	// Not registered yet: found among the actors
+	AMaze* Maze = World->SpawnActor<AMaze>(AMaze::StaticClass());
+	TestTrue(TEXT("Maze found before it registers"), FMazeActorRegistry::Get<AMaze>(World) == Maze);
+
+	// The registered one is given, even with another one in the world
+	AMaze* OtherMaze = World->SpawnActor<AMaze>(AMaze::StaticClass());
+	FMazeActorRegistry::Register(OtherMaze);
+	TestTrue(TEXT("Registered maze"), FMazeActorRegistry::Get<AMaze>(Maze) == OtherMaze);
+
+	// Once destroyed, the remaining one is found again
+	OtherMaze->Destroy();
+	TestTrue(TEXT("Maze found again once the registered one is destroyed"), FMazeActorRegistry::Get<AMaze>(World) == Maze);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeIdleSchedulerTest, "TGWLIHE.Maze.IdleScheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeIdleSchedulerTest::RunTest(const FString& Parameters)
+{
+	FMazeIdleScheduler Scheduler;
+	TArray<FString> Runs;
+	Scheduler.Submit(TEXT("Low"), EMazeIdlePriority::Low, 1.0f, [&Runs]() { Runs.Add(TEXT("Low")); });
+	Scheduler.Submit(TEXT("First high"), EMazeIdlePriority::High, 3.0f, [&Runs]() { Runs.Add(TEXT("First high")); });
+	Scheduler.Submit(TEXT("Second high"), EMazeIdlePriority::High, 3.0f, [&Runs]() { Runs.Add(TEXT("Second high")); });
+	Scheduler.Submit(TEXT("Large"), EMazeIdlePriority::Normal, 10.0f, [&Runs]() { Runs.Add(TEXT("Large")); });
+
+	// Nothing runs out of the windows
+	TestEqual(TEXT("No work without a window"), Scheduler.Tick(4.0f), 0);
+
+	// The first high priority task fills most of the budget, only the low one still fits after it
+	Scheduler.SetWindowOpen(EMazeIdleWindow::Transition, true);
+	TestEqual(TEXT("First frame"), Scheduler.Tick(4.0f), 2);
+	TestTrue(TEXT("Highest priority first"), Runs.Num() == 2 && Runs[0] == TEXT("First high") && Runs[1] == TEXT("Low"));
+
+	// A window stays open as long as one of its sources is
+	Scheduler.SetWindowOpen(EMazeIdleWindow::FadeOut, true);
+	Scheduler.SetWindowOpen(EMazeIdleWindow::Transition, false);
+	TestTrue(TEXT("Fade out window still open"), Scheduler.IsWindowOpen());
+
+	// Then the second high priority one, and the task larger than the budget alone in its frame
+	TestEqual(TEXT("Second frame"), Scheduler.Tick(4.0f), 1);
+	TestEqual(TEXT("Third frame"), Scheduler.Tick(4.0f), 1);
+	TestTrue(TEXT("Submission order within a priority"), Runs.Num() == 4 && Runs[2] == TEXT("Second high") && Runs[3] == TEXT("Large"));
+	TestEqual(TEXT("Queue empty"), Scheduler.Num(), 0);
+
+	Scheduler.SetWindowOpen(EMazeIdleWindow::FadeOut, false);
+	TestFalse(TEXT("Every window closed"), Scheduler.IsWindowOpen());
+
+	// The owner stops ticking without work, it is woken up by new work, and by a window opening on queued work only
+	int32 WakeUpCount = 0;
+	Scheduler.SetWakeUp([&WakeUpCount]() { WakeUpCount += 1; });
+	Scheduler.SetWindowOpen(EMazeIdleWindow::Transition, true);
+	TestEqual(TEXT("No wake up for an empty queue"), WakeUpCount, 0);
+	Scheduler.SetWindowOpen(EMazeIdleWindow::Transition, false);
+	Scheduler.Submit(TEXT("Deferred"), EMazeIdlePriority::Normal, 1.0f, []() {});
+	TestEqual(TEXT("Wake up on submit"), WakeUpCount, 1);
+	Scheduler.SetWindowOpen(EMazeIdleWindow::MonsterKill, true);
+	TestEqual(TEXT("Wake up on window opened"), WakeUpCount, 2);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeAnalyticsTest, "TGWLIHE.Maze.Analytics", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeAnalyticsTest::RunTest(const FString& Parameters)
+{
+	// A single row is one corridor from a dead end to the other
+	FMazeLayout Row;
+	Row.Plan(20, 1, 0, 0, 0, 0);
+	FMazeAnalysis RowAnalysis;
+	RowAnalysis.Analyze(Row);
+	TestEqual(TEXT("Row solution"), RowAnalysis.SolutionLength, 20);
+	TestEqual(TEXT("Row dead ends"), RowAnalysis.DeadEnds, 2);
+	TestEqual(TEXT("Row corridor"), RowAnalysis.AverageCorridorLength, 19.0f);
+	TestEqual(TEXT("Row branching"), RowAnalysis.BranchingFactor, 1.0f);
+
+	for (int32 Seed = 0; Seed < MazeTests::SeedCount; Seed++)
+	{
+		FMazeLayout Layout;
+		Layout.Plan(15, 15, 5, 15, 0, Seed);
+		FMazeAnalysis Analysis;
+		Analysis.Analyze(Layout);
+		const FString Context = FString::Printf(TEXT("seed %d"), Seed);
+
+		TestEqual(FString::Printf(TEXT("Solution length (%s)"), *Context), Analysis.SolutionLength, Layout.GetSolutionLength());
+		TestEqual(FString::Printf(TEXT("Dead ends (%s)"), *Context), Analysis.DeadEnds, Layout.CountDeadEnds());
+
+		// The farthest cell, and the cells of the patrols, as the slower queries of the layout find them
+		TArray<int32> Distances;
+		Layout.ComputeDistances(FIntVector(0, Layout.StartY, 0), Distances);
+		TestEqual(FString::Printf(TEXT("Farthest distance (%s)"), *Context), Analysis.FarthestDistance, FMath::Max(Distances));
+		TestEqual(FString::Printf(TEXT("Farthest cell (%s)"), *Context), Distances[Layout.ToIndex(Analysis.FarthestCell)], Analysis.FarthestDistance);
+
+		TSet<FIntVector> PatrolCells;
+		for (const FMazePatrol& Patrol : Layout.Patrols)
+		{
+			TArray<FIntVector> Path;
+			Layout.FindPath(Patrol.Home, Patrol.Target, Path);
+			PatrolCells.Append(Path);
+		}
+		TestEqual(FString::Printf(TEXT("Patrol coverage (%s)"), *Context), Analysis.PatrolCoverage, (float)PatrolCells.Num() / Layout.Num());
+
+		// The same maze with its start and end the farthest apart
+		FMazeLayout Farthest;
+		Farthest.Plan(15, 15, 5, 15, 0, Seed, true);
+		TestTrue(FString::Printf(TEXT("Same passages (%s)"), *Context), Farthest.PassageMasks == Layout.PassageMasks);
+		TestTrue(FString::Printf(TEXT("Longer solution (%s)"), *Context), Farthest.GetSolutionLength() >= Layout.GetSolutionLength());
+		TestTrue(FString::Printf(TEXT("Valid (%s)"), *Context), Farthest.Validate());
+	}
+
+	// The histograms do not depend on how the mazes are spread over the threads
+	FMazeBatchSettings Settings;
+	Settings.SizeX = 8;
+	Settings.SizeY = 8;
+	Settings.NumberOfMonsters = 2;
+	Settings.MonsterPathLength = 10;
+	Settings.Count = 1000;
+	FMazeBatchAnalysis Batch;
+	Batch.Run(Settings);
+	FMazeBatchAnalysis SameBatch;
+	SameBatch.Run(Settings);
+	for (uint8 Metric = 0; Metric < EMazeMetric::Count; Metric++)
+	{
+		const TCHAR* Name = FMazeBatchAnalysis::GetMetricName((EMazeMetric::Type)Metric);
+		TestTrue(FString::Printf(TEXT("%s counted for every maze"), Name), Batch.GetHistogram((EMazeMetric::Type)Metric).Num() == Settings.Count);
+		TestTrue(FString::Printf(TEXT("%s deterministic"), Name), Batch.GetHistogram((EMazeMetric::Type)Metric).GetBuckets() == SameBatch.GetHistogram((EMazeMetric::Type)Metric).GetBuckets());
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeBitboardTest, "TGWLIHE.Maze.Bitboard", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeBitboardTest::RunTest(const FString& Parameters)
+{
+	// Rows of one word, of a few words with a partial last one, and a single row
+	static const FIntPoint Sizes[] = { FIntPoint(8, 8), FIntPoint(30, 30), FIntPoint(12, 150), FIntPoint(70, 1) };
+
+	for (const FIntPoint& Size : Sizes)
+	{
+		for (int32 Seed = 0; Seed < 8; Seed++)
+		{
+			FMazeLayout Layout;
+			Layout.Plan(Size.X, Size.Y, 0, 0, 0, Seed);
+			FRandomStream Stream(Seed);
+			const FString Context = FString::Printf(TEXT("%dx%d seed %d"), Size.X, Size.Y, Seed);
+
+			// A passage of the solution is closed, so that part of the maze cannot be reached
+			if (Layout.GetSolutionLength() > 1)
+			{
+				TArray<FIntVector> Solution;
+				Layout.FindPath(FIntVector(0, Layout.StartY, 0), FIntVector(Size.X - 1, Layout.EndY, 0), Solution);
+				const int32 Index = Stream.RandRange(0, Solution.Num() - 2);
+				for (uint8 i = 0; i < UMazeDirections::Count; i++)
+				{
+					if (Solution[Index] + UMazeDirections::ToIntVector((EMazeDirection)i) == Solution[Index + 1])
+					{
+						Layout.PassageMasks[Layout.ToIndex(Solution[Index])] &= ~(1 << i);
+						Layout.PassageMasks[Layout.ToIndex(Solution[Index + 1])] &= ~(1 << (uint8)UMazeDirections::GetOppositeDirection((EMazeDirection)i));
+					}
+				}
+			}
+
+			FMazeBitboard Bitboard;
+			Bitboard.Build(Layout);
+
+			// Every query from a few cells, against the scalar walks of the layout
+			for (int32 Query = 0; Query < 4; Query++)
+			{
+				const FIntVector From = Layout.RandomCoordinates(Stream);
+				TArray<int32> Distances;
+				Layout.ComputeDistances(From, Distances);
+
+				FMazeCellSet Reached;
+				Reached.Init(Layout.Size);
+				Reached.Add(From);
+				Bitboard.FloodFill(Reached);
+
+				const int32 Radius = Stream.RandRange(0, 12);
+				FMazeCellSet Within;
+				Bitboard.GetCellsWithin(From, Radius, Within);
+				TArray<TPair<FIntVector, int32>> ScalarWithin;
+				Layout.GetCellsWithin(From, Radius, ScalarWithin);
+				TestEqual(FString::Printf(TEXT("Cells within %d (%s)"), Radius, *Context), Within.Num(), ScalarWithin.Num());
+
+				FMazeCellSet Visible;
+				Bitboard.GetVisibleCells(From, Visible);
+
+				for (int32 Index = 0; Index < Layout.Num(); Index++)
+				{
+					const FIntVector Cell = Layout.ToCoordinates(Index);
+					if (Reached.Contains(Cell) != (Distances[Index] >= 0) || Within.Contains(Cell) != (Distances[Index] >= 0 && Distances[Index] <= Radius)
+						|| Visible.Contains(Cell) != Layout.IsInSight(From, Cell))
+					{
+						AddError(FString::Printf(TEXT("(%d, %d) from (%d, %d): reached %d, within %d, visible %d, distance %d (%s)"), Cell.X, Cell.Y, From.X, From.Y,
+							Reached.Contains(Cell), Within.Contains(Cell), Visible.Contains(Cell), Distances[Index], *Context));
+						break;
+					}
+				}
+
+				const FIntVector To = Layout.RandomCoordinates(Stream);
+				TestEqual(FString::Printf(TEXT("Reachable (%s)"), *Context), Bitboard.IsReachable(From, To), Distances[Layout.ToIndex(To)] >= 0);
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeMonsterNoiseTest, "TGWLIHE.AI.Noise", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeMonsterNoiseTest::RunTest(const FString& Parameters)
+{
+	// A world of its own, which does not begin play: the controller is not possessing anything, its Blackboard is set up here
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MazeNoiseTestWorld"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	AAIMonsterController* Controller = World->SpawnActor<AAIMonsterController>(AAIMonsterController::StaticClass());
+	Controller->HomeLocationKey = FName("HomeLocation");
+	Controller->TargetLocationKey = FName("TargetLocation");
+	Controller->AttackKey = FName("Attack");
+	Controller->MonsterHalfHeight = 100.0f;
+
+	// The keys of the Blackboard of the monsters which the patrol and the noises go through
+	UBlackboardData* BlackboardAsset = NewObject<UBlackboardData>();
+	FBlackboardEntry HomeEntry;
+	HomeEntry.EntryName = Controller->HomeLocationKey;
+	HomeEntry.KeyType = NewObject<UBlackboardKeyType_Vector>(BlackboardAsset);
+	BlackboardAsset->Keys.Add(HomeEntry);
+	FBlackboardEntry TargetEntry;
+	TargetEntry.EntryName = Controller->TargetLocationKey;
+	TargetEntry.KeyType = NewObject<UBlackboardKeyType_Vector>(BlackboardAsset);
+	BlackboardAsset->Keys.Add(TargetEntry);
+	FBlackboardEntry AttackEntry;
+	AttackEntry.EntryName = Controller->AttackKey;
+	AttackEntry.KeyType = NewObject<UBlackboardKeyType_Bool>(BlackboardAsset);
+	BlackboardAsset->Keys.Add(AttackEntry);
+
+	UBlackboardComponent* Blackboard = Controller->GetBlackboard();
+	if (!TestTrue(TEXT("Blackboard initialized"), Blackboard->InitializeBlackboard(*BlackboardAsset)))
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	const FVector HalfHeight(0.0f, 0.0f, Controller->MonsterHalfHeight);
+	const FVector PatrolTarget(2000.0f, 0.0f, 0.0f);
+	Controller->SetPatrol(FVector::ZeroVector, PatrolTarget);
+	TestEqual(TEXT("Patrol target"), Blackboard->GetValueAsVector(Controller->TargetLocationKey), PatrolTarget + HalfHeight);
+
+	// The noise becomes the target of the patrol, at the height of the patrol
+	const FVector Noise(500.0f, 1500.0f, 90.0f);
+	Controller->HearNoise(Noise, 3);
+	TestEqual(TEXT("Noise is the target"), Blackboard->GetValueAsVector(Controller->TargetLocationKey), FVector(Noise.X, Noise.Y, 0.0f) + HalfHeight);
+	TestEqual(TEXT("Noise is the target of the grid movement"), Controller->GetPatrolTargetLocation(), FVector(Noise.X, Noise.Y, 0.0f));
+
+	// A monster attacking the player does not turn to the noises
+	Blackboard->SetValueAsBool(Controller->AttackKey, true);
+	Controller->HearNoise(FVector(-500.0f, 0.0f, 0.0f), 1);
+	TestEqual(TEXT("Noise ignored while attacking"), Blackboard->GetValueAsVector(Controller->TargetLocationKey), FVector(Noise.X, Noise.Y, 0.0f) + HalfHeight);
+
+	// Once the perception is reset, the noise is forgotten
+	Controller->ResetPerception();
+	TestFalse(TEXT("No attack after a reset"), Blackboard->GetValueAsBool(Controller->AttackKey));
+	TestEqual(TEXT("Patrol target after a reset"), Blackboard->GetValueAsVector(Controller->TargetLocationKey), PatrolTarget + HalfHeight);
+	TestEqual(TEXT("Patrol target of the grid movement after a reset"), Controller->GetPatrolTargetLocation(), PatrolTarget);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeInputReplayRequestTest, "TGWLIHE.Replay.CommandLine", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMazeInputReplayRequestTest::RunTest(const FString& Parameters)
+{
+	// Both switches, alone or with the name of the recording, as documented
+	TestTrue(TEXT("Recording"), AMazeInputReplay::IsRequested(TEXT("TGWLIHE -game -MazeRecordInput")));
+	TestTrue(TEXT("Named recording"), AMazeInputReplay::IsRequested(TEXT("TGWLIHE -game -MazeRecordInput=Session")));
+	TestTrue(TEXT("Replay"), AMazeInputReplay::IsRequested(TEXT("TGWLIHE -game -MazeReplay -benchmark")));
+	TestTrue(TEXT("Named replay"), AMazeInputReplay::IsRequested(TEXT("TGWLIHE -game -nullrhi -MazeReplay=Session -benchmark")));
+	TestFalse(TEXT("Neither"), AMazeInputReplay::IsRequested(TEXT("TGWLIHE -game -nullrhi -benchmark")));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MazeTickCosts.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/ActorComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+TMap<FObjectKey, uint64> FMazeTickCosts::Cycles;
+TWeakObjectPtr<UWorld> FMazeTickCosts::CaptureWorld;
+int32 FMazeTickCosts::FrameCount = 0;
+int32 FMazeTickCosts::FramesLeft = 0;
+FDelegateHandle FMazeTickCosts::EndFrameHandle;
+
+static FAutoConsoleCommandWithWorldAndArgs MazeTickCostsCommand(
+	TEXT("Maze.TickCosts"),
+	TEXT("Measures the ticks of the maze actors and components for a number of frames (60 by default), then logs every one ticking with its cost per frame"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FMazeTickCosts::Capture));
+
+// Whether or not the native class of the object is one of this module, the blueprints of the module included
+static bool IsModuleObject(const UObject* Object)
+{
+	static const FName ModulePackage(TEXT("/Script/TGWLIHE"));
+
+	UClass* Class = Object->GetClass();
+	while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+	{
+		Class = Class->GetSuperClass();
+	}
+	return Class && Class->GetOutermost()->GetFName() == ModulePackage;
+}
+
+void FMazeTickCosts::Capture(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	Cycles.Reset();
+	CaptureWorld = World;
+	FrameCount = 0;
+	FramesLeft = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 60;
+
+	if (!EndFrameHandle.IsValid())
+	{
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FMazeTickCosts::OnEndFrame);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("Maze tick costs: measuring %d frames"), FramesLeft);
+}
+
+void FMazeTickCosts::Add(const UObject* Object, uint32 TickCycles)
+{
+	Cycles.FindOrAdd(FObjectKey(Object)) += TickCycles;
+}
+
+void FMazeTickCosts::OnEndFrame()
+{
+	FrameCount += 1;
+	FramesLeft -= 1;
+	if (FramesLeft > 0)
+	{
+		return;
+	}
+
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+
+	LogAll(CaptureWorld.Get());
+	Cycles.Reset();
+	CaptureWorld.Reset();
+}
+
+void FMazeTickCosts::LogAll(UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	// Cost of the measured ticks, averaged over the frames of the capture, even the frames they did not tick in
+	auto GetCost = [](const UObject* Object) -> FString
+	{
+		const uint64* ObjectCycles = Cycles.Find(FObjectKey(Object));
+		if (ObjectCycles == nullptr || FrameCount == 0)
+		{
+			return TEXT("not measured");
+		}
+		return FString::Printf(TEXT("%.3f ms per frame"), FPlatformTime::GetSecondsPerCycle() * 1000.0 * *ObjectCycles / FrameCount);
+	};
+
+	int32 ActorCount = 0;
+	int32 ComponentCount = 0;
+	UE_LOG(LogTemp, Warning, TEXT("Maze tick costs over %d frames:"), FrameCount);
+	for (TActorIterator<AActor> ActorItr(World); ActorItr; ++ActorItr)
+	{
+		AActor* Actor = *ActorItr;
+		const bool IsModuleActor = IsModuleObject(Actor);
+		if (IsModuleActor && Actor->PrimaryActorTick.IsTickFunctionRegistered() && Actor->PrimaryActorTick.IsTickFunctionEnabled())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("  %s (%s), interval %.3f s, %s"), *Actor->GetName(), *Actor->GetClass()->GetName(), Actor->GetActorTickInterval(), *GetCost(Actor));
+			ActorCount += 1;
+		}
+
+		// The engine components of the actors of the module tick for them, the movement of the characters for instance
+		for (UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component && (IsModuleActor || IsModuleObject(Component))
+				&& Component->PrimaryComponentTick.IsTickFunctionRegistered() && Component->PrimaryComponentTick.IsTickFunctionEnabled())
+			{
+				UE_LOG(LogTemp, Warning, TEXT("    %s.%s (%s), interval %.3f s, %s"), *Actor->GetName(), *Component->GetName(), *Component->GetClass()->GetName(), Component->GetComponentTickInterval(), *GetCost(Component));
+				ComponentCount += 1;
+			}
+		}
+	}
+	UE_LOG(LogTemp, Warning, TEXT("Maze tick costs: %d ticking actors, %d ticking components"), ActorCount, ComponentCount);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtr.h"
+class UWorld;
+
+/**
+* "Maze.TickCosts [Frames]" measures the ticks of the module for a number of frames, 60 by default, then logs every ticking actor
+* and component of the module, with the ticking components of its actors, and their cost per frame when their tick is measured
+* A tick is measured by a MAZE_TICK_COST_SCOPE at its start, which costs nothing while no capture is running
+*/
+class TGWLIHE_API FMazeTickCosts
+{
+public:
+	// Starts a capture in the world, the number of frames as the first argument
+	static void Capture(const TArray<FString>& Args, UWorld* World);
+
+	// Whether or not the ticks are being measured
+	static bool IsCapturing() { return FramesLeft > 0; }
+
+	// Adds the cycles of a tick of the object to the capture
+	static void Add(const UObject* Object, uint32 TickCycles);
+
+	// Logs every ticking actor and component of the module in the world, with the costs measured so far
+	static void LogAll(UWorld* World);
+
+private:
+	// Counts the frames of the capture, logs once they are all measured
+	static void OnEndFrame();
+
+	// Cycles spent in the ticks of every measured object during the capture
+	static TMap<FObjectKey, uint64> Cycles;
+
+	// World the capture is logged for
+	static TWeakObjectPtr<UWorld> CaptureWorld;
+
+	// Frames measured, and frames left to measure
+	static int32 FrameCount;
+	static int32 FramesLeft;
+
+	// Binding to the end of the frames, only while capturing
+	static FDelegateHandle EndFrameHandle;
+};
+
+/**
+* Measures the tick it is declared in, for FMazeTickCosts
+*/
+class FMazeTickCostScope
+{
+public:
+	explicit FMazeTickCostScope(const UObject* InObject)
+		: Object(FMazeTickCosts::IsCapturing() ? InObject : nullptr)
+		, StartCycles(Object ? FPlatformTime::Cycles() : 0)
+	{
+	}
+
+	~FMazeTickCostScope()
+	{
+		if (Object)
+		{
+			FMazeTickCosts::Add(Object, FPlatformTime::Cycles() - StartCycles);
+		}
+	}
+
+private:
+	const UObject* Object;
+	uint32 StartCycles;
+};
+
+// At the start of a Tick or a TickComponent of the module
+#define MAZE_TICK_COST_SCOPE() FMazeTickCostScope MazeTickCostScope(this)
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MonsterAnimInstance.h"
+#include "GameFramework/Pawn.h"
+#include "MazeStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Monster animation update"), STAT_MazeAIMonsterAnimUpdate, STATGROUP_MazeAI);
+
+// Sets default values
+UMonsterAnimInstance::UMonsterAnimInstance()
+{
+	Speed = 0.0f;
+	IsMoving = false;
+	IsRunning = false;
+	MovingSpeed = 3.0f;
+	RunningSpeed = 200.0f;
+}
+
+void UMonsterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeAIMonsterAnimUpdate);
+
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	// The velocity comes from the character movement, or from the grid movement when it is enabled
+	APawn* Pawn = TryGetPawnOwner();
+	if (!Pawn)
+	{
+		return;
+	}
+
+	Speed = Pawn->GetVelocity().Size2D();
+	IsMoving = Speed > MovingSpeed;
+	IsRunning = Speed > RunningSpeed;
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "MonsterAnimInstance.generated.h"
+
+/**
+* Parent class of Monster_AnimBP: the values read by its state machine are computed natively once per animation update,
+* so that the event graph of the blueprint does not have to run in the Blueprint VM for every monster
+*/
+UCLASS(Transient, Blueprintable)
+class TGWLIHE_API UMonsterAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values
+	UMonsterAnimInstance();
+
+protected:
+	// Called on every animation update, used here to read the movement of the monster
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+public:
+	// Horizontal speed of the monster, drives the blend between Ghoul_idle, Ghoul_walk and Ghoul_run
+	UPROPERTY(BlueprintReadOnly, Category = "Monster")
+		float Speed;
+
+	// Whether or not the monster is moving, otherwise it is idle
+	UPROPERTY(BlueprintReadOnly, Category = "Monster")
+		bool IsMoving;
+
+	// Whether or not the monster runs after the player, faster than a patrol
+	UPROPERTY(BlueprintReadOnly, Category = "Monster")
+		bool IsRunning;
+
+	// Speed above which the monster is moving
+	UPROPERTY(EditDefaultsOnly, Category = "Monster")
+		float MovingSpeed;
+
+	// Speed above which the monster is running, between the patrol speed (50) and the attack speed (650)
+	UPROPERTY(EditDefaultsOnly, Category = "Monster")
+		float RunningSpeed;
+};
@@ -4,24 +4,17 @@
 #include "AIMonsterController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "Maze.h"
-#include "EngineUtils.h"
+#include "MazeActorRegistry.h"
 
-UMonsterKill::UMonsterKill()
+EBTNodeResult::Type UMonsterKill::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
-	// Grab the Maze Instance
-	if (GetWorld())
+	// Grab the Maze instance of the world of the behavior tree: the node is shared by every monster
+	AMaze* Maze = FMazeActorRegistry::Get<AMaze>(&OwnerComp);
+	if (!Maze)
 	{
-		for (TActorIterator<AMaze> ActorItr(GetWorld()); ActorItr; ++ActorItr)
-		{
-			// Same as with the Object Iterator, access the subclass instance with the * or -> operators.
-			Maze = *ActorItr;
-			// UE_LOG(LogTemp, Warning, TEXT("ON PASSE BIEN PAR BT TASK NODE"));
-		}
+		return EBTNodeResult::Failed;
 	}
-}
 
-EBTNodeResult::Type UMonsterKill::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
-{
 	// Respawn the character
 	Maze->RespawnCharacter();
 
@@ -15,12 +15,6 @@ class TGWLIHE_API UMonsterKill : public UBTTaskNode
 	GENERATED_BODY()
 
 public:
-	UMonsterKill();
-
 	// Our customized Behavior Tree Task
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
-
-private:
-	// Maze pointer, used here to reset the character location to the beginning
-	class AMaze* Maze;
 };
\ No newline at end of file